@@ -0,0 +1,135 @@
+
+/*
+ * Cascade gain autotuning driver.
+ *
+ * Usage: autotune_main [-j threads] [-n iterations] [-b stepSize]
+ *                      [-S ode4|ode4-fused|zoh|tustin|ros2|ode45] [-v]
+ *
+ * Tunes the outer P / inner PID gains from closedLoop_defaultGains over the
+ * default scenario set, with the model stepped at stepSize in the given
+ * solver mode (default: closedLoop_defaultConfig), and prints the gains
+ * before and after and the tuned model parameter set.
+ */
+#define _POSIX_C_SOURCE                200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "pid_autotune.h"
+
+/* Solver names accepted by -S, in controller_SolverMode_T order */
+static const char_T *const autotune_solverNames[] = { "ode4", "ode4-fused",
+  "zoh", "tustin", "ros2", "ode45" };
+
+static void autotune_usage(const char *name)
+{
+  (void) fprintf(stderr, "usage: %s [-j threads] [-n iterations] [-b stepSize]"
+                 "\n          [-S ode4|ode4-fused|zoh|tustin|ros2|ode45] [-v]\n",
+                 name);
+}
+
+static void autotune_printGains(const char_T *label, const CascadeGains_T *g,
+  real_T cost)
+{
+  (void) printf("%-8s Kp_att %.6g  Kp_rate %.6g  Ki_rate %.6g  Kd_rate %.6g"
+                "  N %.6g  cost %.9g\n", label, g->Kp_att, g->Kp_rate,
+                g->Ki_rate, g->Kd_rate, g->N, cost);
+}
+
+int_T main(int_T argc, const char *argv[])
+{
+  closedLoop_Config_T base;
+  closedLoop_Config_T scenarios[PID_TUNE_MAX_SCENARIOS];
+  pidTune_Options_T opt;
+  pidTune_Result_T result;
+  struct timespec t0;
+  struct timespec t1;
+  real_T elapsed;
+  int_T numScenarios;
+  int_T status;
+  int_T solverMode;
+  int opt_c;
+  closedLoop_defaultConfig(&base);
+  pidTune_defaultOptions(&opt);
+  while ((opt_c = getopt(argc, (char *const *)argv, "j:n:b:S:v")) != -1) {
+    switch (opt_c) {
+     case 'j':
+      opt.numThreads = atoi(optarg);
+      break;
+
+     case 'n':
+      opt.maxIterations = atoi(optarg);
+      break;
+
+     case 'b':
+      base.stepSize = strtod(optarg, NULL);
+      if (!(base.stepSize > 0.0)) {
+        autotune_usage(argv[0]);
+        return 1;
+      }
+      break;
+
+     case 'S':
+      for (solverMode = (int_T)(sizeof(autotune_solverNames) / sizeof
+            (autotune_solverNames[0])) - 1; solverMode >= 0; solverMode--) {
+        if (strcmp(optarg, autotune_solverNames[solverMode]) == 0) {
+          break;
+        }
+      }
+
+      if (solverMode < 0) {
+        autotune_usage(argv[0]);
+        return 1;
+      }
+
+      base.solverMode = (controller_SolverMode_T)solverMode;
+      break;
+
+     case 'v':
+      opt.verbose = true;
+      break;
+
+     default:
+      autotune_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  numScenarios = pidTune_defaultScenarios(&base, scenarios,
+    PID_TUNE_MAX_SCENARIOS);
+  autotune_printGains("initial", &base.gains, pidTune_cost(scenarios,
+    numScenarios, &base.gains, &opt.weights));
+  (void) clock_gettime(CLOCK_MONOTONIC, &t0);
+  status = pidTune_run(scenarios, numScenarios, &base.gains, &opt, &result);
+  (void) clock_gettime(CLOCK_MONOTONIC, &t1);
+  if (status != PID_TUNE_OK) {
+    (void) fprintf(stderr, "autotune_main: tuning failed (%d)\n", (int)status);
+    return 1;
+  }
+
+  elapsed = (real_T)(t1.tv_sec - t0.tv_sec) + 1.0E-9 * (real_T)(t1.tv_nsec -
+    t0.tv_nsec);
+  autotune_printGains("tuned", &result.best, result.bestCost);
+  (void) printf("params   Gain_Gain %.9g  PIDController_P %.9g  "
+                "PIDController_I %.9g  PIDController_D %.9g  "
+                "PIDController_N %.9g  (%s, h %g s)\n",
+                result.params.Gain_Gain, result.params.PIDController_P,
+                result.params.PIDController_I, result.params.PIDController_D,
+                result.params.PIDController_N,
+                autotune_solverNames[base.solverMode], base.stepSize);
+  (void) printf("iterations %d, candidates %ld, simulations %ld (abandoned %ld)\n",
+                (int)result.iterations, result.evaluations, result.simulations,
+                result.abandoned);
+  (void) fprintf(stderr, "elapsed %.3f s, %.1f simulations/s\n", elapsed,
+                 (real_T)result.simulations / fmax(elapsed, 1.0E-9));
+  return 0;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,295 @@
+
+
+#ifndef cascaded_pid_hpp_
+#define cascaded_pid_hpp_
+
+/*
+ * Compile-time specialized cascaded PID controller (C++17, header only).
+ *
+ *   CascadedPid<Axes, Solver, Scalar, Gains>
+ *
+ * Each of the Axes axes is the cascade of controller.c's '<S1>': an outer
+ * P on the attitude error and an inner PID on the rate error whose
+ * derivative path is the first-order filter '<S32>'/'<S82>' with
+ * coefficient N and whose integral path is '<S37>'/'<S87>'.
+ *
+ * Gains is a policy class whose static constexpr members hold the gains,
+ * the filter coefficient and the step size, so every constant is folded
+ * into the step.  Solver is one of the policies below:
+ *
+ *   Ode4Solver          - classical Runge-Kutta with the operation order of
+ *                         the generated ODE4 path, bit-identical to
+ *                         CONTROLLER_SOLVER_ODE4 / _ODE4_FUSED
+ *   EulerSolver         - forward Euler
+ *   ZohSolver           - exact discretization, bit-identical to
+ *                         CONTROLLER_SOLVER_ZOH
+ *   TustinSolver        - bilinear, bit-identical to CONTROLLER_SOLVER_TUSTIN
+ *
+ * step() with no arguments advances the model exactly as controller_step
+ * does with its inports at zero, without RTWSolverInfo indirections or
+ * block signal loads.  step(attitudeError, rate,
+ * alpha) drives the cascade from measured errors and returns the gimbal
+ * commands.
+ *
+ * The rates run in controller_step order: the inner loops use the rate
+ * command '<S1>/Gain' held from the last outer tick, then the outer loops
+ * update it when due, every outerRateRatio base ticks (setRates(), as
+ * controller_SetRates).  A new attitude error therefore reaches the gimbal
+ * commands one base tick later, as in the generated model.
+ */
+#include <cmath>
+#include <cstddef>
+
+extern "C" {
+
+#include "controller_private.h"        /* CONTROLLER_FILTER_COEFFICIENT */
+
+}
+
+namespace tvc
+{
+  /* closedLoop_defaultGains with the base step size of controller.h */
+  struct ControllerGains {
+    static constexpr double Kp_att = 4.0;
+    static constexpr double Kp_rate = 0.3;
+    static constexpr double Ki_rate = 0.5;
+    static constexpr double Kd_rate = 0.005;
+    static constexpr double N = CONTROLLER_FILTER_COEFFICIENT;
+    static constexpr double StepSize = 0.2;
+  };
+
+  /* Per-instance coefficients of solvers that need none */
+  template <typename Scalar>
+  struct NoCoeffs {
+    NoCoeffs(Scalar, Scalar)
+    {
+    }
+  };
+
+  struct Ode4Solver {
+    template <typename Scalar>
+    using Coeffs = NoCoeffs<Scalar>;
+
+    /* Filter x' = (u - x)*N; fc receives the last stage's derivative, which
+     * is what '<S40>/Filter Coefficient' holds after a major step */
+    template <typename Scalar>
+    static inline Scalar filter(const Coeffs<Scalar> &, Scalar y, Scalar u,
+      Scalar N, Scalar h, Scalar &fc)
+    {
+      const Scalar temp = Scalar(0.5) * h;
+      const Scalar f0 = (u - y) * N;
+      const Scalar f1 = (u - (y + temp*f0)) * N;
+      const Scalar f2 = (u - (y + temp*f1)) * N;
+      const Scalar f3 = (u - (y + h*f2)) * N;
+      fc = f3;
+      return y + (h / Scalar(6.0))*(f0 + Scalar(2.0)*f1 + Scalar(2.0)*f2 + f3);
+    }
+
+    template <typename Scalar>
+    static inline Scalar integrator(Scalar y, Scalar u, Scalar h)
+    {
+      return y + (h / Scalar(6.0))*(u + Scalar(2.0)*u + Scalar(2.0)*u + u);
+    }
+  };
+
+  struct EulerSolver {
+    template <typename Scalar>
+    using Coeffs = NoCoeffs<Scalar>;
+
+    template <typename Scalar>
+    static inline Scalar filter(const Coeffs<Scalar> &, Scalar y, Scalar u,
+      Scalar N, Scalar h, Scalar &fc)
+    {
+      fc = (u - y) * N;
+      return y + h * fc;
+    }
+
+    template <typename Scalar>
+    static inline Scalar integrator(Scalar y, Scalar u, Scalar h)
+    {
+      return y + h * u;
+    }
+  };
+
+  /* x[k+1] = a*x[k] + b*u[k] with a, b from controller_SetSolverMode */
+  template <typename Derived>
+  struct DiscreteSolver {
+    template <typename Scalar>
+    struct Coeffs {
+      Scalar a;
+      Scalar b;
+      Coeffs(Scalar N, Scalar h)
+      {
+        Derived::coefficients(N * h, a, b);
+      }
+    };
+
+    template <typename Scalar>
+    static inline Scalar filter(const Coeffs<Scalar> &c, Scalar y, Scalar u,
+      Scalar N, Scalar, Scalar &fc)
+    {
+      fc = (u - y) * N;
+      return c.a * y + c.b * u;
+    }
+
+    template <typename Scalar>
+    static inline Scalar integrator(Scalar y, Scalar u, Scalar h)
+    {
+      return y + h * u;
+    }
+  };
+
+  struct ZohSolver : DiscreteSolver<ZohSolver> {
+    template <typename Scalar>
+    static void coefficients(Scalar nh, Scalar &a, Scalar &b)
+    {
+      a = std::exp(-nh);
+      b = -std::expm1(-nh);
+    }
+  };
+
+  struct TustinSolver : DiscreteSolver<TustinSolver> {
+    template <typename Scalar>
+    static void coefficients(Scalar nh, Scalar &a, Scalar &b)
+    {
+      a = (Scalar(1.0) - Scalar(0.5) * nh) / (Scalar(1.0) + Scalar(0.5) * nh);
+      b = nh / (Scalar(1.0) + Scalar(0.5) * nh);
+    }
+  };
+
+  template <std::size_t Axes, typename Solver, typename Scalar = double,
+            typename Gains = ControllerGains>
+  class CascadedPid {
+   public:
+    static_assert(Axes > 0, "CascadedPid needs at least one axis");
+
+    static constexpr Scalar Kp_att = Scalar(Gains::Kp_att);
+    static constexpr Scalar Kp_rate = Scalar(Gains::Kp_rate);
+    static constexpr Scalar Ki_rate = Scalar(Gains::Ki_rate);
+    static constexpr Scalar Kd_rate = Scalar(Gains::Kd_rate);
+    static constexpr Scalar N = Scalar(Gains::N);
+    static constexpr Scalar StepSize = Scalar(Gains::StepSize);
+
+    /* Continuous states of one axis, as in X_controller_T */
+    struct AxisState {
+      Scalar Filter_CSTATE;
+      Scalar Integrator_CSTATE;
+    };
+
+    CascadedPid() :
+      coeffs_(N, StepSize), outerRateRatio_(1UL), tid1_(0UL)
+    {
+      initialize();
+    }
+
+    /* InitializeConditions: all states and block signals to zero */
+    void initialize()
+    {
+      for (std::size_t i = 0; i < Axes; i++) {
+        x_[i].Filter_CSTATE = Scalar(0.0);
+        x_[i].Integrator_CSTATE = Scalar(0.0);
+        filterCoefficient_[i] = Scalar(0.0);
+        rateCmd_[i] = Scalar(0.0);
+      }
+
+      tid1_ = 0UL;
+    }
+
+    /* Outer loop divider, as controller_SetRates: the outer loops run every
+     * outerRateRatio base ticks, starting with the next one */
+    void setRates(unsigned long outerRateRatio)
+    {
+      outerRateRatio_ = (outerRateRatio < 1UL) ? 1UL : outerRateRatio;
+      tid1_ = 0UL;
+    }
+
+    /* One base-rate step with the generated model's zero inputs */
+    inline void step()
+    {
+      const bool outerDue = (tid1_ == 0UL);
+      for (std::size_t i = 0; i < Axes; i++) {
+        const Scalar e = rateCmd_[i];
+        advance(i, Kd_rate * e, Ki_rate * e);
+        if (outerDue) {
+          rateCmd_[i] = Scalar(0.0);
+        }
+      }
+
+      scheduleOuter();
+    }
+
+    /* One base-rate step driven by measured errors; alpha receives the
+     * gimbal command of each axis */
+    inline void step(const Scalar attitudeError[Axes], const Scalar rate[Axes],
+                     Scalar alpha[Axes])
+    {
+      const bool outerDue = (tid1_ == 0UL);
+      for (std::size_t i = 0; i < Axes; i++) {
+        const Scalar e = rateCmd_[i] - rate[i];
+        const Scalar kde = Kd_rate * e;
+        alpha[i] = Kp_rate * e + x_[i].Integrator_CSTATE + (kde -
+          x_[i].Filter_CSTATE) * N;
+        advance(i, kde, Ki_rate * e);
+        if (outerDue) {
+          rateCmd_[i] = Kp_att * attitudeError[i];
+        }
+      }
+
+      scheduleOuter();
+    }
+
+    AxisState &state(std::size_t axis)
+    {
+      return x_[axis];
+    }
+
+    const AxisState &state(std::size_t axis) const
+    {
+      return x_[axis];
+    }
+
+    /* '<S40>'/'<S90>' Filter Coefficient after the last step */
+    Scalar filterCoefficient(std::size_t axis) const
+    {
+      return filterCoefficient_[axis];
+    }
+
+    /* '<S1>/Gain' / '<S1>/Gain1' held for the next inner loop step */
+    Scalar rateCmd(std::size_t axis) const
+    {
+      return rateCmd_[axis];
+    }
+
+   private:
+    inline void advance(std::size_t i, Scalar uD, Scalar uI)
+    {
+      x_[i].Filter_CSTATE = Solver::filter(coeffs_, x_[i].Filter_CSTATE, uD, N,
+        StepSize, filterCoefficient_[i]);
+      x_[i].Integrator_CSTATE = Solver::integrator(x_[i].Integrator_CSTATE, uI,
+        StepSize);
+    }
+
+    /* rate_scheduler: which base tick the outer loops run in next */
+    inline void scheduleOuter()
+    {
+      if (++tid1_ >= outerRateRatio_) {
+        tid1_ = 0UL;
+      }
+    }
+
+    typename Solver::template Coeffs<Scalar> coeffs_;
+    AxisState x_[Axes];
+    Scalar filterCoefficient_[Axes];
+    Scalar rateCmd_[Axes];
+    unsigned long outerRateRatio_;
+    unsigned long tid1_;
+  };
+}                                      /* namespace tvc */
+
+#endif                                 /* cascaded_pid_hpp_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
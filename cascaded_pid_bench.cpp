@@ -0,0 +1,275 @@
+/*
+ * Equivalence check and timing of CascadedPid against the generated model.
+ *
+ * For each solver mode the generated controller and the matching
+ * CascadedPid<2, ...> start from the same nonzero continuous states and are
+ * stepped side by side, first with the inports at zero and then driven by
+ * the same sensor sequence through the model's bound root I/O, with the
+ * outer loop at the base rate and at a third of it; every state, both
+ * filter coefficients, the held rate commands and the gimbal commands must
+ * agree bit for bit at every step.  The exit status is nonzero on any
+ * mismatch.  Then both are timed over numSteps steps.  Build with the
+ * Simulink Coder headers on the include path, e.g.
+ *
+ *   cc -O2 -c -I$MATLAB/rtw/c/src -I$MATLAB/simulink/include controller.c \
+ *      controller_data.c
+ *   c++ -O2 -std=c++17 -I$MATLAB/rtw/c/src -I$MATLAB/simulink/include \
+ *      cascaded_pid_bench.cpp controller.o controller_data.o -lm \
+ *      -o cascaded_pid_bench
+ *
+ * Usage: cascaded_pid_bench [numSteps]
+ *
+ * The checks run min(numSteps, CASCADED_PID_BENCH_CHECK_STEPS) steps, so a
+ * short numSteps makes a quick equivalence test (make check).
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+extern "C" {
+
+#include "controller.h"                /* Model header file */
+
+}
+#include "cascaded_pid.hpp"
+
+#define CASCADED_PID_BENCH_DEFAULT_STEPS (10000000L)
+#define CASCADED_PID_BENCH_CHECK_STEPS (100000L)
+#define CASCADED_PID_BENCH_OUTER_RATIO (3UL)/* Divider of the second check */
+
+/* The unforced filter states decay by exp(-N*h) per step and would reach
+ * subnormal values after about a thousand steps; timed runs restart from
+ * the initial states this often */
+#define CASCADED_PID_BENCH_RESTART     (512L)
+
+namespace
+{
+  /* Default gains at the 1 kHz rate used by closed_loop.c */
+  struct BenchGains : tvc::ControllerGains {
+    static constexpr double StepSize = 0.001;
+  };
+
+  const double initialX[4] = { 0.3, -0.1, -0.2, 0.05 };
+
+  RT_MODEL_controller_T controller_M_;
+
+  double now_ns()
+  {
+    struct timespec ts;
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1.0E9 + (double)ts.tv_nsec;
+  }
+
+  bool sameBits(double a, double b)
+  {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+  }
+
+  void setModelStates(RT_MODEL_controller_T *const controller_M)
+  {
+    X_controller_T *controller_X = rtmGetContStates(controller_M);
+    controller_X->Filter_CSTATE = initialX[0];
+    controller_X->Integrator_CSTATE = initialX[1];
+    controller_X->Filter_CSTATE_f = initialX[2];
+    controller_X->Integrator_CSTATE_i = initialX[3];
+  }
+
+  void startModel(RT_MODEL_controller_T *const controller_M,
+                  controller_SolverMode_T mode, uint32_T outerRateRatio)
+  {
+    controller_initialize(controller_M);
+    controller_SetRates(controller_M, BenchGains::StepSize, outerRateRatio);
+    controller_SetSolverMode(controller_M, mode);
+    setModelStates(controller_M);
+  }
+
+  template <typename Pid>
+  void setPidStates(Pid &pid)
+  {
+    pid.state(0).Filter_CSTATE = initialX[0];
+    pid.state(0).Integrator_CSTATE = initialX[1];
+    pid.state(1).Filter_CSTATE = initialX[2];
+    pid.state(1).Integrator_CSTATE = initialX[3];
+  }
+
+  template <typename Pid>
+  void startPid(Pid &pid, unsigned long outerRateRatio)
+  {
+    pid.initialize();
+    pid.setRates(outerRateRatio);
+    setPidStates(pid);
+  }
+
+  /* Sensor buffer and actuator buffer bound to the model's root I/O */
+  ExtU_controller_T sensors;
+  ExtY_controller_T actuators;
+
+  /* Deterministic attitude and rate sequence for the driven check */
+  void sense(long k, ExtU_controller_T *u)
+  {
+    double t = (double)k * BenchGains::StepSize;
+    u->pitch_sp = (((k / 2000L) % 2L) == 0L) ? 0.1 : -0.1;
+    u->pitch = 0.05 * std::sin(3.0 * t);
+    u->pitch_rate = 0.15 * std::cos(3.0 * t);
+    u->roll_sp = 0.0;
+    u->roll = -0.02 * std::sin(7.0 * t + 1.0);
+    u->roll_rate = -0.14 * std::cos(7.0 * t + 1.0);
+  }
+
+  /* Returns the first step at which the two disagree, or -1.  With
+   * driven = true both see the same sensor sequence and the gimbal
+   * commands are compared as well. */
+  template <typename Pid>
+  long check(controller_SolverMode_T mode, long numSteps, bool driven,
+             uint32_T outerRateRatio)
+  {
+    RT_MODEL_controller_T *const controller_M = &controller_M_;
+    B_controller_T *controller_B = rtmGetBlockIO(controller_M);
+    X_controller_T *controller_X = rtmGetContStates(controller_M);
+    static Pid pid;
+    long k;
+    startModel(controller_M, mode, outerRateRatio);
+    std::memset(&sensors, 0, sizeof(sensors));
+    rtmSetU(controller_M, &sensors);
+    rtmSetY(controller_M, &actuators);
+    startPid(pid, outerRateRatio);
+    for (k = 0L; k < numSteps; k++) {
+      bool same = true;
+      if (driven) {
+        double attitudeError[2];
+        double rate[2];
+        double alpha[2];
+        sense(k, &sensors);
+        attitudeError[0] = sensors.pitch_sp - sensors.pitch;
+        attitudeError[1] = sensors.roll_sp - sensors.roll;
+        rate[0] = sensors.pitch_rate;
+        rate[1] = sensors.roll_rate;
+        controller_step(controller_M);
+        pid.step(attitudeError, rate, alpha);
+        same = sameBits(actuators.alpha_pitch, alpha[0]) && sameBits
+          (actuators.alpha_roll, alpha[1]);
+      } else {
+        controller_step(controller_M);
+        pid.step();
+      }
+
+      if (!same || !sameBits(controller_X->Filter_CSTATE,
+                             pid.state(0).Filter_CSTATE) ||
+          !sameBits(controller_X->Integrator_CSTATE,
+                    pid.state(0).Integrator_CSTATE) ||
+          !sameBits(controller_X->Filter_CSTATE_f, pid.state(1).Filter_CSTATE)
+          || !sameBits(controller_X->Integrator_CSTATE_i,
+                       pid.state(1).Integrator_CSTATE) ||
+          !sameBits(controller_B->FilterCoefficient, pid.filterCoefficient(0))
+          || !sameBits(controller_B->FilterCoefficient_c,
+                       pid.filterCoefficient(1)) || !sameBits(controller_B->Gain,
+            pid.rateCmd(0)) || !sameBits(controller_B->Gain1, pid.rateCmd(1))) {
+        return k;
+      }
+    }
+
+    return -1L;
+  }
+
+  double timeModel(controller_SolverMode_T mode, long numSteps)
+  {
+    RT_MODEL_controller_T *const controller_M = &controller_M_;
+    double t0;
+    long k;
+    startModel(controller_M, mode, 1UL);
+    t0 = now_ns();
+    for (k = 0L; k < numSteps; k++) {
+      if ((k % CASCADED_PID_BENCH_RESTART) == 0L) {
+        setModelStates(controller_M);
+      }
+
+      controller_step(controller_M);
+    }
+
+    return (now_ns() - t0) / (double)numSteps;
+  }
+
+  template <typename Pid>
+  double timePid(long numSteps)
+  {
+    static Pid pid;
+    volatile double sink;
+    double t0;
+    long k;
+    startPid(pid, 1UL);
+    t0 = now_ns();
+    for (k = 0L; k < numSteps; k++) {
+      if ((k % CASCADED_PID_BENCH_RESTART) == 0L) {
+        setPidStates(pid);
+      }
+
+      pid.step();
+
+      /* Keep the states observable so the loop is not folded away */
+      __asm__ __volatile__ ("" : : "r" (&pid) : "memory");
+    }
+
+    sink = pid.state(0).Filter_CSTATE;
+    (void) sink;
+    return (now_ns() - t0) / (double)numSteps;
+  }
+
+  template <typename Solver>
+  int run(const char *name, controller_SolverMode_T mode, long numSteps)
+  {
+    typedef tvc::CascadedPid<2, Solver, double, BenchGains> Pid;
+    long checkSteps = (numSteps < CASCADED_PID_BENCH_CHECK_STEPS) ? numSteps :
+      CASCADED_PID_BENCH_CHECK_STEPS;
+    long bad = check<Pid>(mode, checkSteps, false, 1UL);
+    if (bad < 0L) {
+      bad = check<Pid>(mode, checkSteps, true, 1UL);
+    }
+
+    if (bad < 0L) {
+      bad = check<Pid>(mode, checkSteps, true, CASCADED_PID_BENCH_OUTER_RATIO);
+    }
+
+    double nsModel = timeModel(mode, numSteps);
+    double nsPid = timePid<Pid>(numSteps);
+    (void) std::printf("%-12s %-10s %12.2f %12.2f %8.1fx\n", name, (bad < 0L) ?
+                       "identical" : "MISMATCH", nsModel, nsPid, nsModel / nsPid);
+    if (bad >= 0L) {
+      (void) std::fprintf(stderr, "%s: trajectories differ at step %ld\n",
+                          name, bad);
+      return 1;
+    }
+
+    return 0;
+  }
+}
+
+int main(int argc, const char *argv[])
+{
+  long numSteps = CASCADED_PID_BENCH_DEFAULT_STEPS;
+  int status = 0;
+  if (argc > 1) {
+    numSteps = std::strtol(argv[1], NULL, 10);
+  }
+
+  if (numSteps <= 0L) {
+    (void) std::fprintf(stderr, "usage: %s [numSteps]\n", argv[0]);
+    return 1;
+  }
+
+  (void) std::printf("%-12s %-10s %12s %12s %9s\n", "mode", "trajectory",
+                     "model ns", "template ns", "speedup");
+  status |= run<tvc::Ode4Solver>("ode4", CONTROLLER_SOLVER_ODE4, numSteps);
+  status |= run<tvc::Ode4Solver>("ode4-fused", CONTROLLER_SOLVER_ODE4_FUSED,
+    numSteps);
+  status |= run<tvc::ZohSolver>("zoh", CONTROLLER_SOLVER_ZOH, numSteps);
+  status |= run<tvc::TustinSolver>("tustin", CONTROLLER_SOLVER_TUSTIN, numSteps);
+  return status;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
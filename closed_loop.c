@@ -0,0 +1,165 @@
+
+#include <math.h>
+#include <string.h>
+#include "closed_loop.h"
+#include "controller_private.h"
+
+void closedLoop_defaultGains(CascadeGains_T *g)
+{
+  g->Kp_att = controller_DefaultP.Gain_Gain;
+  g->Kp_rate = controller_DefaultP.PIDController_P;
+  g->Ki_rate = controller_DefaultP.PIDController_I;
+  g->Kd_rate = controller_DefaultP.PIDController_D;
+  g->N = controller_DefaultP.PIDController_N;
+}
+
+void closedLoop_defaultConfig(closedLoop_Config_T *cfg)
+{
+  (void) memset((void *)cfg, 0, sizeof(closedLoop_Config_T));
+  plant_defaultParams(&cfg->plant);
+  closedLoop_defaultGains(&cfg->gains);
+  cfg->stepSize = 0.001;
+  cfg->outerRateRatio = 1UL;
+  cfg->solverMode = CONTROLLER_SOLVER_ZOH;
+  cfg->plantSubsteps = 1;
+  cfg->duration = 10.0;
+  cfg->initialPitch = 0.1;
+  cfg->disturbanceTime = 5.0;
+  cfg->settlingBand = 0.01;
+  cfg->divergenceLimit = 1.2;
+}
+
+void closedLoop_gainsToParams(const CascadeGains_T *g, P_controller_T *params)
+{
+  params->Gain_Gain = g->Kp_att;
+  params->Gain1_Gain = g->Kp_att;
+  params->PIDController_P = g->Kp_rate;
+  params->PIDController_I = g->Ki_rate;
+  params->PIDController_D = g->Kd_rate;
+  params->PIDController_N = g->N;
+  params->PIDController1_P = g->Kp_rate;
+  params->PIDController1_I = g->Ki_rate;
+  params->PIDController1_D = g->Kd_rate;
+  params->PIDController1_N = g->N;
+}
+
+void closedLoop_initController(const closedLoop_Config_T *cfg,
+  RT_MODEL_controller_T *const controller_M)
+{
+  P_controller_T params;
+  controller_initialize(controller_M);
+  controller_SetRates(controller_M, cfg->stepSize, cfg->outerRateRatio);
+  controller_SetSolverMode(controller_M, cfg->solverMode);
+  closedLoop_gainsToParams(&cfg->gains, &params);
+  (void) controller_SetParams(controller_M, &params);
+}
+
+void closedLoop_run(const closedLoop_Config_T *cfg, closedLoop_NoiseFcn_T
+                    noise, void *noiseCtx, real_T abandonIse,
+                    closedLoop_Result_T *result)
+{
+  RT_MODEL_controller_T controller_M_;
+  RT_MODEL_controller_T *const controller_M = &controller_M_;
+  ExtU_controller_T *controller_U;
+  const ExtY_controller_T *controller_Y;
+  X_plant_T x;
+  U_plant_T u;
+  real_T e0Pitch = cfg->setpointPitch - cfg->initialPitch;
+  real_T e0Roll = cfg->setpointRoll - cfg->initialRoll;
+  real_T sgnPitch = (e0Pitch >= 0.0) ? 1.0 : -1.0;
+  real_T sgnRoll = (e0Roll >= 0.0) ? 1.0 : -1.0;
+  time_T hp = cfg->stepSize / (real_T)cfg->plantSubsteps;
+  int32_T numSteps = (int32_T)(cfg->duration / cfg->stepSize + 0.5);
+  boolean_T useNoise = (boolean_T)((noise != NULL) && ((cfg->angleNoiseStd >
+    0.0) || (cfg->rateNoiseStd > 0.0)));
+  int32_T k;
+  int_T j;
+  closedLoop_initController(cfg, controller_M);
+  controller_U = rtmGetU(controller_M);
+  controller_Y = rtmGetY(controller_M);
+  controller_U->pitch_sp = cfg->setpointPitch;
+  controller_U->roll_sp = cfg->setpointRoll;
+  (void) memset((void *)result, 0, sizeof(closedLoop_Result_T));
+  plant_initialize(&x);
+  x.pitch = cfg->initialPitch;
+  x.roll = cfg->initialRoll;
+  u.thrust = plant_hoverThrust(&cfg->plant);
+  u.disturbancePitch = 0.0;
+  u.disturbanceRoll = 0.0;
+  for (k = 0; k < numSteps; k++) {
+    time_T t = (real_T)k * cfg->stepSize;
+    real_T mPitch = x.pitch;
+    real_T mRoll = x.roll;
+    real_T mPitchRate = x.pitchRate;
+    real_T mRollRate = x.rollRate;
+    real_T ePitch;
+    real_T eRoll;
+    real_T errMax;
+
+    /* Sensors */
+    if (useNoise) {
+      mPitch += cfg->angleNoiseStd * noise(noiseCtx);
+      mRoll += cfg->angleNoiseStd * noise(noiseCtx);
+      mPitchRate += cfg->rateNoiseStd * noise(noiseCtx);
+      mRollRate += cfg->rateNoiseStd * noise(noiseCtx);
+    }
+
+    /* Controller */
+    controller_U->pitch = mPitch;
+    controller_U->pitch_rate = mPitchRate;
+    controller_U->roll = mRoll;
+    controller_U->roll_rate = mRollRate;
+    controller_step(controller_M);
+    u.alphaCmdPitch = PLANT_GIMBAL_SIGN * controller_Y->alpha_pitch;
+    u.alphaCmdRoll = PLANT_GIMBAL_SIGN * controller_Y->alpha_roll;
+    if (t >= cfg->disturbanceTime) {
+      u.disturbancePitch = cfg->disturbancePitch;
+      u.disturbanceRoll = cfg->disturbanceRoll;
+    }
+
+    /* Figures of merit on the true attitude */
+    ePitch = cfg->setpointPitch - x.pitch;
+    eRoll = cfg->setpointRoll - x.roll;
+    result->ise += (ePitch * ePitch + eRoll * eRoll) * cfg->stepSize;
+    result->gimbalEffort += (u.alphaCmdPitch * u.alphaCmdPitch + u.alphaCmdRoll *
+      u.alphaCmdRoll) * cfg->stepSize;
+    if (-sgnPitch * ePitch > result->overshoot) {
+      result->overshoot = -sgnPitch * ePitch;
+    }
+
+    if (-sgnRoll * eRoll > result->overshoot) {
+      result->overshoot = -sgnRoll * eRoll;
+    }
+
+    errMax = fmax(fabs(ePitch), fabs(eRoll));
+    if (errMax > cfg->settlingBand) {
+      result->settlingTime = t + cfg->stepSize;
+    }
+
+    /* Plant */
+    for (j = 0; j < cfg->plantSubsteps; j++) {
+      plant_step(&cfg->plant, &x, &u, hp);
+    }
+
+    result->stepsRun = k + 1;
+    result->maxTilt = fmax(result->maxTilt, fmax(fabs(x.pitch), fabs(x.roll)));
+    if (!(result->maxTilt <= cfg->divergenceLimit)) {
+      result->diverged = true;
+      break;
+    }
+
+    if ((abandonIse > 0.0) && (result->ise > abandonIse)) {
+      break;
+    }
+  }
+
+  result->finalPitch = x.pitch;
+  result->finalRoll = x.roll;
+  controller_terminate(controller_M);
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,99 @@
+
+
+#ifndef closed_loop_h_
+#define closed_loop_h_
+#include "rtwtypes.h"
+#include "controller.h"
+#include "pendulum_plant.h"
+
+/*
+ * Closed-loop simulation of the pitch/roll cascade on the pendulum plant.
+ *
+ * The controller is the generated model: every run owns an
+ * RT_MODEL_controller_T, set up by closedLoop_initController with the
+ * run's controller step, outer rate divider, solver mode and gains.  Each
+ * controller step writes the sensed attitude and rates to the model's
+ * inports (rtmGetU), calls controller_step and applies the outports
+ * (rtmGetY) to the gimbals.  The plant is advanced with ODE4 in
+ * plantSubsteps substeps per controller step.
+ */
+
+/* Cascade gains, shared by the pitch and roll axes */
+typedef struct {
+  real_T Kp_att;                       /* Outer loop P [1/s] */
+  real_T Kp_rate;                      /* Inner loop P [rad/(rad/s)] */
+  real_T Ki_rate;                      /* Inner loop I */
+  real_T Kd_rate;                      /* Inner loop D */
+  real_T N;                            /* Derivative filter coefficient */
+} CascadeGains_T;
+
+/* Scenario of one closed-loop run */
+typedef struct {
+  P_plant_T plant;
+  CascadeGains_T gains;
+  time_T stepSize;                     /* Controller step [s] */
+  uint32_T outerRateRatio;             /* Controller steps per outer loop step */
+  controller_SolverMode_T solverMode;  /* Controller solver */
+  int_T plantSubsteps;                 /* Plant ODE4 steps per controller step */
+  time_T duration;                     /* Simulated time [s] */
+  real_T initialPitch;                 /* [rad] */
+  real_T initialRoll;                  /* [rad] */
+  real_T setpointPitch;                /* [rad] */
+  real_T setpointRoll;                 /* [rad] */
+  real_T disturbancePitch;             /* Step disturbance torque [N m] */
+  real_T disturbanceRoll;              /* Step disturbance torque [N m] */
+  time_T disturbanceTime;              /* Onset of the disturbance [s] */
+  real_T angleNoiseStd;                /* Attitude sensor noise [rad] */
+  real_T rateNoiseStd;                 /* Rate sensor noise [rad/s] */
+  real_T settlingBand;                 /* Settling criterion on |error| [rad] */
+  real_T divergenceLimit;              /* |tilt| treated as tip-over [rad] */
+} closedLoop_Config_T;
+
+/* Figures of merit of one run */
+typedef struct {
+  real_T ise;                          /* Integral of squared attitude error */
+  real_T overshoot;                    /* Max error after first crossing [rad] */
+  real_T settlingTime;                 /* Last time |error| left the band [s] */
+  real_T gimbalEffort;                 /* Integral of squared gimbal command */
+  real_T maxTilt;                      /* Max |pitch|, |roll| [rad] */
+  real_T finalPitch;
+  real_T finalRoll;
+  int32_T stepsRun;                    /* Controller steps executed */
+  boolean_T diverged;                  /* Tilt exceeded divergenceLimit */
+} closedLoop_Result_T;
+
+/*
+ * Source of sensor noise: returns one standard normal sample per call.
+ * May be NULL when both noise levels are zero.
+ */
+typedef real_T (*closedLoop_NoiseFcn_T)(void *ctx);
+
+/* Gains of the generated model's default parameter set */
+extern void closedLoop_defaultGains(CascadeGains_T *g);
+
+/* Default scenario: 1 kHz controller in CONTROLLER_SOLVER_ZOH mode, 10 s,
+ * 0.1 rad initial pitch */
+extern void closedLoop_defaultConfig(closedLoop_Config_T *cfg);
+
+/* Model parameter set with g on both the pitch and the roll cascade */
+extern void closedLoop_gainsToParams(const CascadeGains_T *g, P_controller_T
+  *params);
+
+/* Initializes controller_M for the run: rates, solver mode and the gains,
+ * published with controller_SetParams and taken at the first step */
+extern void closedLoop_initController(const closedLoop_Config_T *cfg,
+  RT_MODEL_controller_T *const controller_M);
+
+/* Runs one closed-loop simulation; never allocates.  A run stops early when
+ * it diverges or, with abandonIse > 0, once its ISE exceeds abandonIse. */
+extern void closedLoop_run(const closedLoop_Config_T *cfg,
+  closedLoop_NoiseFcn_T noise, void *noiseCtx, real_T abandonIse,
+  closedLoop_Result_T *result);
+
+#endif                                 /* closed_loop_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
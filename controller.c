@@ -2,25 +2,14 @@
 
 #include "controller.h"
 #include "controller_private.h"
-
-/* Block signals (default storage) */
-B_controller_T controller_B;
-
-/* Continuous states */
-X_controller_T controller_X;
-
-/* Disabled State Vector */
-XDis_controller_T controller_XDis;
-
-/* Real-time model */
-static RT_MODEL_controller_T controller_M_;
-RT_MODEL_controller_T *const controller_M = &controller_M_;
+#include "rt_probe.h"
 
 /*
  * This function updates continuous states using the ODE4 fixed-step
  * solver algorithm
  */
-static void rt_ertODEUpdateContinuousStates(RTWSolverInfo *si )
+static void rt_ertODEUpdateContinuousStates(RTWSolverInfo *si ,
+  RT_MODEL_controller_T *const controller_M)
 {
   time_T t = rtsiGetT(si);
   time_T tnew = rtsiGetSolverStopTime(si);
@@ -43,10 +32,13 @@ static void rt_ertODEUpdateContinuousStates(RTWSolverInfo *si )
 
   /* Assumes that rtsiSetT and ModelOutputs are up-to-date */
   /* f0 = f(t,y) */
+  RT_PROBE_BEGIN(RT_PROBE_ODE4_STAGE1);
   rtsiSetdX(si, f0);
-  controller_derivatives();
+  controller_derivatives(controller_M);
+  RT_PROBE_END(RT_PROBE_ODE4_STAGE1);
 
   /* f1 = f(t + (h/2), y + (h/2)*f0) */
+  RT_PROBE_BEGIN(RT_PROBE_ODE4_STAGE2);
   temp = 0.5 * h;
   for (i = 0; i < nXc; i++) {
     x[i] = y[i] + (temp*f0[i]);
@@ -54,46 +46,676 @@ static void rt_ertODEUpdateContinuousStates(RTWSolverInfo *si )
 
   rtsiSetT(si, t + temp);
   rtsiSetdX(si, f1);
-  controller_step();
-  controller_derivatives();
+  controller_step0(controller_M);
+  controller_derivatives(controller_M);
+  RT_PROBE_END(RT_PROBE_ODE4_STAGE2);
 
   /* f2 = f(t + (h/2), y + (h/2)*f1) */
+  RT_PROBE_BEGIN(RT_PROBE_ODE4_STAGE3);
   for (i = 0; i < nXc; i++) {
     x[i] = y[i] + (temp*f1[i]);
   }
 
   rtsiSetdX(si, f2);
-  controller_step();
-  controller_derivatives();
+  controller_step0(controller_M);
+  controller_derivatives(controller_M);
+  RT_PROBE_END(RT_PROBE_ODE4_STAGE3);
 
   /* f3 = f(t + h, y + h*f2) */
+  RT_PROBE_BEGIN(RT_PROBE_ODE4_STAGE4);
   for (i = 0; i < nXc; i++) {
     x[i] = y[i] + (h*f2[i]);
   }
 
   rtsiSetT(si, tnew);
   rtsiSetdX(si, f3);
-  controller_step();
-  controller_derivatives();
+  controller_step0(controller_M);
+  controller_derivatives(controller_M);
+  RT_PROBE_END(RT_PROBE_ODE4_STAGE4);
 
   /* tnew = t + h
      ynew = y + (h/6)*(f0 + 2*f1 + 2*f2 + 2*f3) */
+  RT_PROBE_BEGIN(RT_PROBE_ODE4_UPDATE);
   temp = h / 6.0;
   for (i = 0; i < nXc; i++) {
     x[i] = y[i] + temp*(f0[i] + 2.0*f1[i] + 2.0*f2[i] + f3[i]);
   }
 
+  RT_PROBE_END(RT_PROBE_ODE4_UPDATE);
+
   rtsiSetSimTimeStep(si,MAJOR_TIME_STEP);
 }
 
-/* Model step function */
-void controller_step(void)
+/*
+ * ODE4 stages of one derivative filter, (u - x) * N, with the state kept in
+ * registers.  The operation order matches rt_ertODEUpdateContinuousStates
+ * so both paths give identical results.  Returns the updated state and
+ * leaves the last stage's filter coefficient in *fc.
+ */
+static real_T rt_ertODE4FusedFilter(real_T y, real_T u, real_T N, time_T h,
+  real_T *fc)
+{
+  time_T temp = 0.5 * h;
+  real_T f0 = (u - y) * N;
+  real_T f1 = (u - (y + temp*f0)) * N;
+  real_T f2 = (u - (y + temp*f1)) * N;
+  real_T f3 = (u - (y + h*f2)) * N;
+  *fc = f3;
+  return y + (h / 6.0)*(f0 + 2.0*f1 + 2.0*f2 + f3);
+}
+
+/*
+ * ODE4 stages of one integrator with constant input u
+ */
+static real_T rt_ertODE4FusedIntegrator(real_T y, real_T u, time_T h)
+{
+  return y + (h / 6.0)*(u + 2.0*u + 2.0*u + u);
+}
+
+/*
+ * This function updates the continuous states using the ODE4 fixed-step
+ * solver algorithm in a single fused pass.  The minor time steps are not
+ * dispatched through controller_step/controller_derivatives and the
+ * solver-info object is left untouched.
+ */
+static void rt_ertODE4FusedUpdateStates(RT_MODEL_controller_T *const
+  controller_M)
+{
+  B_controller_T *controller_B = rtmGetBlockIO(controller_M);
+  X_controller_T *controller_X = rtmGetContStates(controller_M);
+  const P_controller_T *controller_P = rtmGetParams(controller_M);
+  time_T h = controller_M->Timing.stepSize0;
+  controller_X->Filter_CSTATE = rt_ertODE4FusedFilter
+    (controller_X->Filter_CSTATE, controller_B->DerivativeGain,
+     controller_P->PIDController_N, h, &controller_B->FilterCoefficient);
+  controller_X->Integrator_CSTATE = rt_ertODE4FusedIntegrator
+    (controller_X->Integrator_CSTATE, controller_B->IntegralGain, h);
+  controller_X->Filter_CSTATE_f = rt_ertODE4FusedFilter
+    (controller_X->Filter_CSTATE_f, controller_B->DerivativeGain_b,
+     controller_P->PIDController1_N, h, &controller_B->FilterCoefficient_c);
+  controller_X->Integrator_CSTATE_i = rt_ertODE4FusedIntegrator
+    (controller_X->Integrator_CSTATE_i, controller_B->IntegralGain_p, h);
+}
+
+/*
+ * This function updates the continuous states with the precomputed
+ * discrete-time (ZOH or Tustin) coefficients in a single pass
+ */
+static void rt_ertDiscreteUpdateStates(RT_MODEL_controller_T *const
+  controller_M)
 {
+  B_controller_T *controller_B = rtmGetBlockIO(controller_M);
+  X_controller_T *controller_X = rtmGetContStates(controller_M);
+  time_T h = controller_M->Timing.stepSize0;
+
+  /* Update for Integrator: '<S32>/Filter' */
+  controller_X->Filter_CSTATE = controller_M->DiscCoeffs.FilterA *
+    controller_X->Filter_CSTATE + controller_M->DiscCoeffs.FilterB *
+    controller_B->DerivativeGain;
+
+  /* Update for Integrator: '<S37>/Integrator' */
+  controller_X->Integrator_CSTATE += h * controller_B->IntegralGain;
+
+  /* Update for Integrator: '<S82>/Filter' */
+  controller_X->Filter_CSTATE_f = controller_M->DiscCoeffs.FilterA_f *
+    controller_X->Filter_CSTATE_f + controller_M->DiscCoeffs.FilterB_f *
+    controller_B->DerivativeGain_b;
+
+  /* Update for Integrator: '<S87>/Integrator' */
+  controller_X->Integrator_CSTATE_i += h * controller_B->IntegralGain_p;
+}
+
+/*
+ * Discrete-time coefficients of one derivative filter with coefficient N
+ */
+void controller_DiscreteFilterCoeffs(controller_SolverMode_T mode, real_T N,
+  time_T h, real_T *a, real_T *b)
+{
+  real_T nh = N * h;
+  switch (mode) {
+   case CONTROLLER_SOLVER_ZOH:
+    /* x[k+1] = exp(-N*h)*x[k] + (1 - exp(-N*h))*u[k] */
+    *a = exp(-nh);
+    *b = -expm1(-nh);
+    break;
+
+   case CONTROLLER_SOLVER_TUSTIN:
+    /* x[k+1] = (1 - N*h/2)/(1 + N*h/2)*x[k] + N*h/(1 + N*h/2)*u[k] */
+    *a = (1.0 - 0.5 * nh) / (1.0 + 0.5 * nh);
+    *b = nh / (1.0 + 0.5 * nh);
+    break;
+
+   default:
+    *a = 0.0;
+    *b = 0.0;
+    break;
+  }
+}
+
+/*
+ * Recomputes the discrete-time coefficients for the solver mode, the base
+ * step and the parameter set in use
+ */
+static void rt_ertDiscreteCoeffs(RT_MODEL_controller_T *const controller_M)
+{
+  const P_controller_T *controller_P = rtmGetParams(controller_M);
+  controller_DiscreteFilterCoeffs(controller_M->solverMode,
+    controller_P->PIDController_N, controller_M->Timing.stepSize0,
+    &controller_M->DiscCoeffs.FilterA, &controller_M->DiscCoeffs.FilterB);
+  controller_DiscreteFilterCoeffs(controller_M->solverMode,
+    controller_P->PIDController1_N, controller_M->Timing.stepSize0,
+    &controller_M->DiscCoeffs.FilterA_f, &controller_M->DiscCoeffs.FilterB_f);
+}
+
+/*
+ * Derivatives at a minor time step: outputs at (t, x), then dx = f(t, x)
+ */
+static void rt_ertODEMinorDerivatives(RTWSolverInfo *si, RT_MODEL_controller_T
+  *const controller_M, time_T t, real_T *dx)
+{
+  rtsiSetT(si, t);
+  rtsiSetdX(si, dx);
+  controller_step0(controller_M);
+  controller_derivatives(controller_M);
+  controller_M->SolverStats.derivEvals++;
+}
+
+/*
+ * In-place LU factorization with partial pivoting of a 4x4 matrix; returns
+ * false if it is singular
+ */
+static boolean_T rt_ertLUFactor4(real_T A[4][4], int_T piv[4])
+{
+  int_T i;
+  int_T j;
+  int_T k;
+  for (k = 0; k < 4; k++) {
+    int_T p = k;
+    for (i = k + 1; i < 4; i++) {
+      if (fabs(A[i][k]) > fabs(A[p][k])) {
+        p = i;
+      }
+    }
+
+    piv[k] = p;
+    if (A[p][k] == 0.0) {
+      return false;
+    }
+
+    if (p != k) {
+      for (j = 0; j < 4; j++) {
+        real_T tmp = A[k][j];
+        A[k][j] = A[p][j];
+        A[p][j] = tmp;
+      }
+    }
+
+    for (i = k + 1; i < 4; i++) {
+      A[i][k] /= A[k][k];
+      for (j = k + 1; j < 4; j++) {
+        A[i][j] -= A[i][k] * A[k][j];
+      }
+    }
+  }
+
+  return true;
+}
+
+/* Solves A*x = b in place with the factors of rt_ertLUFactor4 */
+static void rt_ertLUSolve4(real_T A[4][4], const int_T piv[4], real_T b[4])
+{
+  int_T i;
+  int_T j;
+  for (i = 0; i < 4; i++) {
+    real_T tmp = b[piv[i]];
+    b[piv[i]] = b[i];
+    b[i] = tmp;
+    for (j = 0; j < i; j++) {
+      b[i] -= A[i][j] * b[j];
+    }
+  }
+
+  for (i = 3; i >= 0; i--) {
+    for (j = i + 1; j < 4; j++) {
+      b[i] -= A[i][j] * b[j];
+    }
+
+    b[i] /= A[i][i];
+  }
+}
+
+/*
+ * This function updates the continuous states with the two-stage
+ * Rosenbrock method ROS2 (Verwer et al.), L-stable for gamma = 1 + 1/sqrt(2):
+ *   W = I - gamma*h*J,  J = df/dx by forward differences
+ *   W*k1 = f(t, y)
+ *   W*k2 = f(t + h, y + h*k1) - 2*k1
+ *   ynew = y + (3/2)*h*k1 + (1/2)*h*k2
+ * The inputs are held over the step, so f does not depend on t otherwise.
+ */
+static void rt_ertROS2UpdateContinuousStates(RTWSolverInfo *si ,
+  RT_MODEL_controller_T *const controller_M)
+{
+  time_T t = rtsiGetT(si);
+  time_T tnew = rtsiGetSolverStopTime(si);
+  time_T h = rtsiGetStepSize(si);
+  real_T *x = rtsiGetContStates(si);
+  real_T *y = controller_M->odeY;
+  real_T *f0 = controller_M->SolverWork.k[0];
+  real_T *k1 = controller_M->SolverWork.k[1];
+  real_T *k2 = controller_M->SolverWork.k[2];
+  real_T *fd = controller_M->SolverWork.k[3];
+  real_T (*W)[4] = controller_M->SolverWork.W;
+  real_T gh = 1.7071067811865475 * h;
+  int_T i;
+  int_T j;
+  int_T nXc = 4;
+  rtsiSetSimTimeStep(si,MINOR_TIME_STEP);
+  (void) memcpy(y, x,
+                (uint_T)nXc*sizeof(real_T));
+
+  /* f0 = f(t,y); assumes that ModelOutputs are up-to-date */
+  rtsiSetdX(si, f0);
+  controller_derivatives(controller_M);
+  controller_M->SolverStats.derivEvals++;
+
+  /* W = I - gamma*h*J, one column per perturbed state */
+  for (j = 0; j < nXc; j++) {
+    real_T delta = 1.4901161193847656E-8 * ((fabs(y[j]) > 1.0) ? fabs(y[j]) :
+      1.0);
+    x[j] = y[j] + delta;
+    rt_ertODEMinorDerivatives(si, controller_M, t, fd);
+    x[j] = y[j];
+    for (i = 0; i < nXc; i++) {
+      W[i][j] = -gh * (fd[i] - f0[i]) / delta;
+    }
+
+    W[j][j] += 1.0;
+  }
+
+  controller_M->SolverStats.jacobianEvals++;
+  if (!rt_ertLUFactor4(W, controller_M->SolverWork.piv)) {
+    rtmSetErrorStatus(controller_M, "ros2: singular iteration matrix");
+    rtsiSetSimTimeStep(si,MAJOR_TIME_STEP);
+    return;
+  }
+
+  /* k1 */
+  (void) memcpy(k1, f0,
+                (uint_T)nXc*sizeof(real_T));
+  rt_ertLUSolve4(W, controller_M->SolverWork.piv, k1);
+
+  /* k2 */
+  for (i = 0; i < nXc; i++) {
+    x[i] = y[i] + h*k1[i];
+  }
+
+  rt_ertODEMinorDerivatives(si, controller_M, tnew, k2);
+  for (i = 0; i < nXc; i++) {
+    k2[i] -= 2.0*k1[i];
+  }
+
+  rt_ertLUSolve4(W, controller_M->SolverWork.piv, k2);
+
+  /* ynew */
+  for (i = 0; i < nXc; i++) {
+    x[i] = y[i] + h*(1.5*k1[i] + 0.5*k2[i]);
+  }
+
+  controller_M->SolverStats.steps++;
+  rtsiSetSimTimeStep(si,MAJOR_TIME_STEP);
+}
+
+/*
+ * Dormand-Prince dense output over an accepted substep from (t, y0) to
+ * (t + h, y1): coefficients r such that, for 0 <= theta <= 1,
+ *   y(t + theta*h) = r0 + theta*(r1 + (1-theta)*(r2 + theta*(r3 + (1-theta)*r4)))
+ * (Hairer, Norsett and Wanner), from the stages k[0..6] of the substep.
+ */
+static void rt_ertODE45DenseCoeffs(real_T (*k)[4], const real_T *y0, const
+  real_T *y1, time_T h, real_T r[5][4])
+{
+  static const real_T d1 = -12715105075.0/11282082432.0, d3 =
+    87487479700.0/32700410799.0, d4 = -10690763975.0/1880347072.0, d5 =
+    701980252875.0/199316789632.0, d6 = -1453857185.0/822651844.0, d7 =
+    69997945.0/29380423.0;
+  int_T i;
+  for (i = 0; i < 4; i++) {
+    r[0][i] = y0[i];
+    r[1][i] = y1[i] - y0[i];
+    r[2][i] = h*k[0][i] - r[1][i];
+    r[3][i] = r[1][i] - h*k[6][i] - r[2][i];
+    r[4][i] = h*(d1*k[0][i] + d3*k[2][i] + d4*k[3][i] + d5*k[4][i] + d6*k[5][i]
+                 + d7*k[6][i]);
+  }
+}
+
+static void rt_ertODE45DenseEval(real_T r[5][4], real_T theta, real_T *x)
+{
+  real_T omt = 1.0 - theta;
+  int_T i;
+  for (i = 0; i < 4; i++) {
+    x[i] = r[0][i] + theta*(r[1][i] + omt*(r[2][i] + theta*(r[3][i] + omt*r[4]
+      [i])));
+  }
+}
+
+/* Evaluates every zero-crossing signal at (t, x) into gPrev */
+static void rt_ertZcRefresh(RT_MODEL_controller_T *const controller_M, time_T
+  t, const real_T *x)
+{
+  int_T i;
+  for (i = 0; i < controller_M->ZeroCrossings.num; i++) {
+    const controller_ZcSignal_T *zc = &controller_M->ZeroCrossings.signal[i];
+    controller_M->ZeroCrossings.gPrev[i] = zc->fcn(controller_M, t, (const
+      X_controller_T *)x, zc->ctx);
+  }
+}
+
+/*
+ * Checks an accepted ODE45 substep for zero crossings.  If a signal
+ * crossed, locates the earliest crossing, overwrites x1 with the state
+ * there, returns the signal index and its position theta in the substep;
+ * otherwise returns -1.  The location is taken on the far side of the
+ * crossing, so the signal has changed sign in the returned state.
+ */
+static int_T rt_ertODE45LocateZc(RT_MODEL_controller_T *const controller_M,
+  time_T t, time_T h, const real_T *y0, real_T *x1, real_T *theta)
+{
+  real_T r[5][4] = { { 0.0 } };        /* Filled before the first use */
+  real_T xi[4];
+  boolean_T haveCoeffs = false;
+  real_T best = 2.0;
+  int_T found = -1;
+  int_T i;
+  for (i = 0; i < controller_M->ZeroCrossings.num; i++) {
+    const controller_ZcSignal_T *zc = &controller_M->ZeroCrossings.signal[i];
+    real_T ga = controller_M->ZeroCrossings.gPrev[i];
+    real_T gb = zc->fcn(controller_M, t + h, (const X_controller_T *)x1,
+                        zc->ctx);
+    real_T a = 0.0;
+    real_T b = 1.0;
+    int_T side = 0;
+    int_T iter;
+    boolean_T rising = (boolean_T)((ga < 0.0) && (gb >= 0.0));
+    boolean_T falling = (boolean_T)((ga > 0.0) && (gb <= 0.0));
+    if (!(((zc->direction != CONTROLLER_ZC_FALLING) && rising) ||
+          ((zc->direction != CONTROLLER_ZC_RISING) && falling))) {
+      continue;
+    }
+
+    if (!haveCoeffs) {
+      rt_ertODE45DenseCoeffs(controller_M->SolverWork.k, y0, x1, h, r);
+      haveCoeffs = true;
+    }
+
+    /* Illinois iteration on [a, b], g(a) and g(b) of opposite sign */
+    for (iter = 0; (iter < 64) && ((b - a) * h > CONTROLLER_ZC_TIME_TOL) && (gb
+          != 0.0); iter++) {
+      real_T c = (a * gb - b * ga) / (gb - ga);
+      real_T gc;
+      if (!(c > a) || !(c < b)) {
+        c = 0.5 * (a + b);
+      }
+
+      rt_ertODE45DenseEval(r, c, xi);
+      gc = zc->fcn(controller_M, t + c*h, (const X_controller_T *)xi, zc->ctx);
+      if ((gc >= 0.0) == (gb >= 0.0)) {
+        b = c;
+        gb = gc;
+        if (side == 1) {
+          ga *= 0.5;
+        }
+
+        side = 1;
+      } else {
+        a = c;
+        ga = gc;
+        if (side == -1) {
+          gb *= 0.5;
+        }
+
+        side = -1;
+      }
+    }
+
+    if (b < best) {
+      best = b;
+      found = i;
+    }
+  }
+
+  if (found >= 0) {
+    *theta = best;
+    if (best < 1.0) {
+      rt_ertODE45DenseEval(r, best, x1);
+    }
+  }
+
+  return found;
+}
+
+/*
+ * This function updates the continuous states with the Dormand-Prince
+ * 5(4) pair, integrating from t to the solver stop time in as many
+ * substeps as CONTROLLER_ODE45_RELTOL/ABSTOL require.  The last stage of an
+ * accepted substep is the first of the next (FSAL), and the substep size
+ * is carried over to the next major time step in SolverWork.hNext.
+ * Registered zero crossings are located within the substeps.
+ */
+static void rt_ertODE45UpdateContinuousStates(RTWSolverInfo *si ,
+  RT_MODEL_controller_T *const controller_M)
+{
+  static const real_T a21 = 1.0/5.0;
+  static const real_T a31 = 3.0/40.0, a32 = 9.0/40.0;
+  static const real_T a41 = 44.0/45.0, a42 = -56.0/15.0, a43 = 32.0/9.0;
+  static const real_T a51 = 19372.0/6561.0, a52 = -25360.0/2187.0, a53 =
+    64448.0/6561.0, a54 = -212.0/729.0;
+  static const real_T a61 = 9017.0/3168.0, a62 = -355.0/33.0, a63 =
+    46732.0/5247.0, a64 = 49.0/176.0, a65 = -5103.0/18656.0;
+  static const real_T b1 = 35.0/384.0, b3 = 500.0/1113.0, b4 = 125.0/192.0,
+    b5 = -2187.0/6784.0, b6 = 11.0/84.0;
+  static const real_T e1 = 71.0/57600.0, e3 = -71.0/16695.0, e4 = 71.0/1920.0,
+    e5 = -17253.0/339200.0, e6 = 22.0/525.0, e7 = -1.0/40.0;
+  time_T t = rtsiGetT(si);
+  time_T tnew = rtsiGetSolverStopTime(si);
+  time_T hTry = controller_M->SolverWork.hNext;
+  real_T *x = rtsiGetContStates(si);
+  real_T *y = controller_M->odeY;
+  real_T (*k)[4] = controller_M->SolverWork.k;
+  uint32_T tries = 0UL;
+  int_T i;
+  int_T nXc = 4;
+  rtsiSetSimTimeStep(si,MINOR_TIME_STEP);
+  (void) memcpy(y, x,
+                (uint_T)nXc*sizeof(real_T));
+  if (!(hTry > 0.0) || (hTry > tnew - t)) {
+    hTry = tnew - t;
+  }
+
+  /* k1 = f(t,y); assumes that ModelOutputs are up-to-date */
+  rtsiSetdX(si, k[0]);
+  controller_derivatives(controller_M);
+  controller_M->SolverStats.derivEvals++;
+  rt_ertZcRefresh(controller_M, t, y);
+  while (t < tnew) {
+    boolean_T last = (boolean_T)(t + hTry >= tnew);
+    time_T h = last ? tnew - t : hTry;
+    real_T err = 0.0;
+    real_T fac;
+    if (++tries > CONTROLLER_ODE45_MAX_STEPS) {
+      (void) memcpy(x, y,
+                    (uint_T)nXc*sizeof(real_T));
+      rtmSetErrorStatus(controller_M, "ode45: too many substeps, tolerances too tight");
+      break;
+    }
+
+    for (i = 0; i < nXc; i++) {
+      x[i] = y[i] + h*(a21*k[0][i]);
+    }
+
+    rt_ertODEMinorDerivatives(si, controller_M, t + h*(1.0/5.0), k[1]);
+    for (i = 0; i < nXc; i++) {
+      x[i] = y[i] + h*(a31*k[0][i] + a32*k[1][i]);
+    }
+
+    rt_ertODEMinorDerivatives(si, controller_M, t + h*(3.0/10.0), k[2]);
+    for (i = 0; i < nXc; i++) {
+      x[i] = y[i] + h*(a41*k[0][i] + a42*k[1][i] + a43*k[2][i]);
+    }
+
+    rt_ertODEMinorDerivatives(si, controller_M, t + h*(4.0/5.0), k[3]);
+    for (i = 0; i < nXc; i++) {
+      x[i] = y[i] + h*(a51*k[0][i] + a52*k[1][i] + a53*k[2][i] + a54*k[3][i]);
+    }
+
+    rt_ertODEMinorDerivatives(si, controller_M, t + h*(8.0/9.0), k[4]);
+    for (i = 0; i < nXc; i++) {
+      x[i] = y[i] + h*(a61*k[0][i] + a62*k[1][i] + a63*k[2][i] + a64*k[3][i] +
+                       a65*k[4][i]);
+    }
+
+    rt_ertODEMinorDerivatives(si, controller_M, t + h, k[5]);
+
+    /* Fifth-order solution, and its derivative for FSAL */
+    for (i = 0; i < nXc; i++) {
+      x[i] = y[i] + h*(b1*k[0][i] + b3*k[2][i] + b4*k[3][i] + b5*k[4][i] + b6*
+                       k[5][i]);
+    }
+
+    rt_ertODEMinorDerivatives(si, controller_M, t + h, k[6]);
+
+    /* RMS of the embedded error estimate relative to the tolerances */
+    for (i = 0; i < nXc; i++) {
+      real_T e = h*(e1*k[0][i] + e3*k[2][i] + e4*k[3][i] + e5*k[4][i] + e6*k[5]
+                    [i] + e7*k[6][i]);
+      real_T sc = CONTROLLER_ODE45_ABSTOL + CONTROLLER_ODE45_RELTOL * ((fabs
+        (y[i]) > fabs(x[i])) ? fabs(y[i]) : fabs(x[i]));
+      err += (e / sc) * (e / sc);
+    }
+
+    err = sqrt(err / (real_T)nXc);
+    fac = (err > 0.0) ? 0.9 * pow(err, -0.2) : 5.0;
+    fac = (fac < 0.2) ? 0.2 : ((fac > 5.0) ? 5.0 : fac);
+    if (err <= 1.0) {
+      real_T theta = 1.0;
+      int_T zc = -1;
+      if (controller_M->ZeroCrossings.num > 0) {
+        zc = rt_ertODE45LocateZc(controller_M, t, h, y, x, &theta);
+      }
+
+      controller_M->SolverStats.steps++;
+      if ((zc >= 0) && (theta < 1.0)) {
+        t += theta * h;
+      } else {
+        t = last ? tnew : t + h;
+      }
+
+      if (zc >= 0) {
+        const controller_ZcSignal_T *sig =
+          &controller_M->ZeroCrossings.signal[zc];
+        controller_M->SolverStats.zeroCrossings++;
+        if (sig->onEvent != NULL) {
+          sig->onEvent(controller_M, t, (X_controller_T *)x, sig->direction,
+                       sig->ctx);
+        }
+
+        /* Restart from the state at the event; hTry is kept */
+        (void) memcpy(y, x,
+                      (uint_T)nXc*sizeof(real_T));
+        rt_ertZcRefresh(controller_M, t, y);
+        if (t < tnew) {
+          rt_ertODEMinorDerivatives(si, controller_M, t, k[0]);
+        }
+
+        continue;
+      }
+
+      (void) memcpy(y, x,
+                    (uint_T)nXc*sizeof(real_T));
+      (void) memcpy(k[0], k[6],
+                    (uint_T)nXc*sizeof(real_T));
+      if (controller_M->ZeroCrossings.num > 0) {
+        rt_ertZcRefresh(controller_M, t, y);
+      }
+
+      /* A step shortened to hit the stop time says nothing about hTry */
+      if (!last || (h * fac > hTry)) {
+        hTry = h * fac;
+      }
+    } else {
+      controller_M->SolverStats.rejected++;
+      hTry = h * fac;
+    }
+  }
+
+  controller_M->SolverWork.hNext = hTry;
+  rtsiSetT(si, tnew);
+  rtsiSetSimTimeStep(si,MAJOR_TIME_STEP);
+}
+
+/*
+ *         This function updates active task flag for each subrate.
+ *         The function is called at model base rate, hence the
+ *         generated code self-manages all its subrates.
+ */
+static void rate_scheduler(RT_MODEL_controller_T *const controller_M)
+{
+  /* Compute which subrates run during the next base time step.  Subrates
+   * are an integer multiple of the base rate counter.  Therefore, the subtask
+   * counter is reset when it reaches its limit (zero means run).
+   */
+  (controller_M->Timing.TaskCounters.TID[1])++;
+  if ((controller_M->Timing.TaskCounters.TID[1]) >=
+      controller_M->Timing.TaskCounters.cLimit[1]) {
+    controller_M->Timing.TaskCounters.TID[1] = 0UL;
+  }
+}
+
+/* Model step function for TID0: inner rate loop and continuous states */
+void controller_step0(RT_MODEL_controller_T *const controller_M)
+{
+  B_controller_T *controller_B = rtmGetBlockIO(controller_M);
+  X_controller_T *controller_X = rtmGetContStates(controller_M);
+  const P_controller_T *controller_P = rtmGetParams(controller_M);
+  RT_PROBE_DECLARE(RT_PROBE_STEP0);
   if (rtmIsMajorTimeStep(controller_M)) {
+    ExtU_controller_T *controller_U = (ExtU_controller_T *)
+      controller_M->inputs;
+
+    /* Timed at major time steps only, where the probe also ends */
+    RT_PROBE_START(RT_PROBE_STEP0);
+
     /* set solver stop time */
     rtsiSetSolverStopTime(&controller_M->solverInfo,
                           ((controller_M->Timing.clockTick0+1)*
       controller_M->Timing.stepSize0));
+
+    /* Sum: '<S1>/Sum1' incorporates:
+     *  Inport: '<Root>/pitch_rate'
+     */
+    controller_B->Sum1 = controller_B->Gain - controller_U->pitch_rate;
+
+    /* Gain: '<S30>/Derivative Gain' */
+    controller_B->DerivativeGain = controller_P->PIDController_D *
+      controller_B->Sum1;
+
+    /* Gain: '<S34>/Integral Gain' */
+    controller_B->IntegralGain = controller_P->PIDController_I *
+      controller_B->Sum1;
+
+    /* Sum: '<S1>/Sum3' incorporates:
+     *  Inport: '<Root>/roll_rate'
+     */
+    controller_B->Sum3 = controller_B->Gain1 - controller_U->roll_rate;
+
+    /* Gain: '<S80>/Derivative Gain' */
+    controller_B->DerivativeGain_b = controller_P->PIDController1_D *
+      controller_B->Sum3;
+
+    /* Gain: '<S84>/Integral Gain' */
+    controller_B->IntegralGain_p = controller_P->PIDController1_I *
+      controller_B->Sum3;
   }                                    /* end MajorTimeStep */
 
   /* Update absolute time of base rate at minor time step */
@@ -105,17 +727,75 @@ void controller_step(void)
    *  Integrator: '<S32>/Filter'
    *  Sum: '<S32>/SumD'
    */
-  controller_B.FilterCoefficient = (controller_ConstB.DerivativeGain -
-    controller_X.Filter_CSTATE) * 664.682083275505;
+  RT_PROBE_BEGIN(RT_PROBE_S40_FILTER_COEFFICIENT);
+  controller_B->FilterCoefficient = (controller_B->DerivativeGain -
+    controller_X->Filter_CSTATE) * controller_P->PIDController_N;
+  RT_PROBE_END(RT_PROBE_S40_FILTER_COEFFICIENT);
 
   /* Gain: '<S90>/Filter Coefficient' incorporates:
    *  Integrator: '<S82>/Filter'
    *  Sum: '<S82>/SumD'
    */
-  controller_B.FilterCoefficient_c = (controller_ConstB.DerivativeGain_b -
-    controller_X.Filter_CSTATE_f) * 664.682083275505;
+  RT_PROBE_BEGIN(RT_PROBE_S90_FILTER_COEFFICIENT);
+  controller_B->FilterCoefficient_c = (controller_B->DerivativeGain_b -
+    controller_X->Filter_CSTATE_f) * controller_P->PIDController1_N;
+  RT_PROBE_END(RT_PROBE_S90_FILTER_COEFFICIENT);
   if (rtmIsMajorTimeStep(controller_M)) {
-    rt_ertODEUpdateContinuousStates(&controller_M->solverInfo);
+    ExtY_controller_T *controller_Y = (ExtY_controller_T *)
+      controller_M->outputs;
+
+    /* Outport: '<Root>/alpha_pitch' incorporates:
+     *  Gain: '<S42>/Proportional Gain'
+     *  Integrator: '<S37>/Integrator'
+     *  Sum: '<S46>/Sum'
+     */
+    controller_Y->alpha_pitch = (controller_P->PIDController_P *
+      controller_B->Sum1 + controller_X->Integrator_CSTATE) +
+      controller_B->FilterCoefficient;
+
+    /* Outport: '<Root>/alpha_roll' incorporates:
+     *  Gain: '<S92>/Proportional Gain'
+     *  Integrator: '<S87>/Integrator'
+     *  Sum: '<S96>/Sum'
+     */
+    controller_Y->alpha_roll = (controller_P->PIDController1_P *
+      controller_B->Sum3 + controller_X->Integrator_CSTATE_i) +
+      controller_B->FilterCoefficient_c;
+    switch (controller_M->solverMode) {
+     case CONTROLLER_SOLVER_ODE4_FUSED:
+      {
+        RT_PROBE_BEGIN(RT_PROBE_SOLVER_FUSED);
+        rt_ertODE4FusedUpdateStates(controller_M);
+        RT_PROBE_END(RT_PROBE_SOLVER_FUSED);
+        controller_M->SolverStats.steps++;
+        controller_M->SolverStats.derivEvals += 4ULL;
+      }
+      break;
+
+     case CONTROLLER_SOLVER_ZOH:
+     case CONTROLLER_SOLVER_TUSTIN:
+      {
+        RT_PROBE_BEGIN(RT_PROBE_SOLVER_DISCRETE);
+        rt_ertDiscreteUpdateStates(controller_M);
+        RT_PROBE_END(RT_PROBE_SOLVER_DISCRETE);
+        controller_M->SolverStats.steps++;
+      }
+      break;
+
+     case CONTROLLER_SOLVER_ROS2:
+      rt_ertROS2UpdateContinuousStates(&controller_M->solverInfo, controller_M);
+      break;
+
+     case CONTROLLER_SOLVER_ODE45:
+      rt_ertODE45UpdateContinuousStates(&controller_M->solverInfo, controller_M);
+      break;
+
+     default:
+      rt_ertODEUpdateContinuousStates(&controller_M->solverInfo, controller_M);
+      controller_M->SolverStats.steps++;
+      controller_M->SolverStats.derivEvals += 4ULL;
+      break;
+    }
 
     /* Update absolute time for base rate */
     /* The "clockTick0" counts the number of times the code of this task has
@@ -125,42 +805,145 @@ void controller_step(void)
      */
     ++controller_M->Timing.clockTick0;
     controller_M->Timing.t[0] = rtsiGetSolverStopTime(&controller_M->solverInfo);
-
-    {
-      /* Update absolute timer for sample time: [0.2s, 0.0s] */
-      /* The "clockTick1" counts the number of times the code of this task has
-       * been executed. The resolution of this integer timer is 0.2, which is the step size
-       * of the task. Size of "clockTick1" ensures timer will not overflow during the
-       * application lifespan selected.
-       */
-      controller_M->Timing.clockTick1++;
-    }
+    rate_scheduler(controller_M);
+    RT_PROBE_END(RT_PROBE_STEP0);
   }                                    /* end MajorTimeStep */
 }
 
+/* Model step function for TID1: outer attitude loop */
+void controller_step1(RT_MODEL_controller_T *const controller_M)
+{
+  B_controller_T *controller_B = rtmGetBlockIO(controller_M);
+  ExtU_controller_T *controller_U = (ExtU_controller_T *)
+    controller_M->inputs;
+  const P_controller_T *controller_P = rtmGetParams(controller_M);
+  RT_PROBE_BEGIN(RT_PROBE_STEP1);
+
+  /* Sum: '<S1>/Sum' incorporates:
+   *  Inport: '<Root>/pitch'
+   *  Inport: '<Root>/pitch_sp'
+   */
+  controller_B->Sum = controller_U->pitch_sp - controller_U->pitch;
+
+  /* Gain: '<S1>/Gain' */
+  controller_B->Gain = controller_P->Gain_Gain * controller_B->Sum;
+
+  /* Sum: '<S1>/Sum2' incorporates:
+   *  Inport: '<Root>/roll'
+   *  Inport: '<Root>/roll_sp'
+   */
+  controller_B->Sum2 = controller_U->roll_sp - controller_U->roll;
+
+  /* Gain: '<S1>/Gain1' */
+  controller_B->Gain1 = controller_P->Gain1_Gain * controller_B->Sum2;
+
+  /* Update absolute time */
+  /* The "clockTick1" counts the number of times the code of this task has
+   * been executed. The resolution of this integer timer is
+   * Timing.stepSize1, which is the step size of the task. Size of
+   * "clockTick1" ensures timer will not overflow during the application
+   * lifespan selected.
+   */
+  controller_M->Timing.clockTick1++;
+  controller_M->Timing.t[1] = controller_M->Timing.clockTick1 *
+    controller_M->Timing.stepSize1;
+  RT_PROBE_END(RT_PROBE_STEP1);
+}
+
+/*
+ * Model step function (single-tasking): runs every rate due this tick in
+ * the rate-monotonic order of rt_OneStep, the base rate first and the due
+ * subrates after it, so an outer loop output reaches the inner loop at the
+ * next base tick.
+ */
+void controller_step(RT_MODEL_controller_T *const controller_M)
+{
+  boolean_T eventFlags[2] = { false, false };
+  controller_SetEventsForThisBaseStep(controller_M, eventFlags);
+  controller_step0(controller_M);
+  if (eventFlags[1]) {
+    controller_step1(controller_M);
+  }
+}
+
+/*
+ * Takes a parameter set published by controller_SetParams.  Called once at
+ * the start of a base-rate tick, before any rate runs in it, so the base
+ * rate and the subrates due in the tick step with the same set.  The
+ * discrete coefficients follow the filter coefficients of the new set.
+ */
+static void rt_ertTakeParams(RT_MODEL_controller_T *const controller_M)
+{
+  uint32_T active = rtmParamIndexLoad(&controller_M->ParamBank.active);
+  if (active != controller_M->ParamBank.inUse) {
+    rtmParamIndexStore(&controller_M->ParamBank.inUse, active);
+    rt_ertDiscreteCoeffs(controller_M);
+  }
+}
+
+/* Starts a base-rate tick: takes a published parameter set and flags the
+ * subrates that are due */
+void controller_SetEventsForThisBaseStep(RT_MODEL_controller_T *const
+  controller_M, boolean_T *eventFlags)
+{
+  rt_ertTakeParams(controller_M);
+  eventFlags[1] = (boolean_T)rtmStepTask(controller_M, 1);
+}
+
 /* Derivatives for root system: '<Root>' */
-void controller_derivatives(void)
+void controller_derivatives(RT_MODEL_controller_T *const controller_M)
 {
+  B_controller_T *controller_B = rtmGetBlockIO(controller_M);
   XDot_controller_T *_rtXdot;
   _rtXdot = ((XDot_controller_T *) controller_M->derivs);
 
   /* Derivatives for Integrator: '<S32>/Filter' */
-  _rtXdot->Filter_CSTATE = controller_B.FilterCoefficient;
+  RT_PROBE_BEGIN(RT_PROBE_S32_FILTER_DERIV);
+  _rtXdot->Filter_CSTATE = controller_B->FilterCoefficient;
+  RT_PROBE_END(RT_PROBE_S32_FILTER_DERIV);
 
   /* Derivatives for Integrator: '<S37>/Integrator' */
-  _rtXdot->Integrator_CSTATE = controller_ConstB.IntegralGain;
+  RT_PROBE_BEGIN(RT_PROBE_S37_INTEGRATOR_DERIV);
+  _rtXdot->Integrator_CSTATE = controller_B->IntegralGain;
+  RT_PROBE_END(RT_PROBE_S37_INTEGRATOR_DERIV);
 
   /* Derivatives for Integrator: '<S82>/Filter' */
-  _rtXdot->Filter_CSTATE_f = controller_B.FilterCoefficient_c;
+  RT_PROBE_BEGIN(RT_PROBE_S82_FILTER_DERIV);
+  _rtXdot->Filter_CSTATE_f = controller_B->FilterCoefficient_c;
+  RT_PROBE_END(RT_PROBE_S82_FILTER_DERIV);
 
   /* Derivatives for Integrator: '<S87>/Integrator' */
-  _rtXdot->Integrator_CSTATE_i = controller_ConstB.IntegralGain_p;
+  RT_PROBE_BEGIN(RT_PROBE_S87_INTEGRATOR_DERIV);
+  _rtXdot->Integrator_CSTATE_i = controller_B->IntegralGain_p;
+  RT_PROBE_END(RT_PROBE_S87_INTEGRATOR_DERIV);
 }
 
 /* Model initialize function */
-void controller_initialize(void)
+void controller_initialize(RT_MODEL_controller_T *const controller_M)
 {
+  X_controller_T *controller_X = rtmGetContStates(controller_M);
+
   /* Registration code */
+  rtmSetErrorStatus(controller_M, (NULL));
+
+  /* block I/O */
+  (void) memset(((void *) rtmGetBlockIO(controller_M)), 0,
+                sizeof(B_controller_T));
+
+  /* external inputs */
+  (void) memset((void *)&controller_M->U, 0, sizeof(ExtU_controller_T));
+  controller_M->inputs = &controller_M->U;
+
+  /* external outputs */
+  (void) memset((void *)&controller_M->Y, 0, sizeof(ExtY_controller_T));
+  controller_M->outputs = &controller_M->Y;
+
+  /* disabled states */
+  {
+    (void) memset((void *)rtmGetContStateDisabled(controller_M), 0,
+                  sizeof(XDis_controller_T));
+  }
+
   {
     /* Setup solver object */
     rtsiSetSimTimeStepPtr(&controller_M->solverInfo,
@@ -194,31 +977,215 @@ void controller_initialize(void)
   controller_M->intgData.f[1] = controller_M->odeF[1];
   controller_M->intgData.f[2] = controller_M->odeF[2];
   controller_M->intgData.f[3] = controller_M->odeF[3];
-  controller_M->contStates = ((X_controller_T *) &controller_X);
-  controller_M->contStateDisabled = ((XDis_controller_T *) &controller_XDis);
+  controller_M->contStates = rtmGetContStates(controller_M);
+  controller_M->contStateDisabled = rtmGetContStateDisabled(controller_M);
+  controller_M->Timing.clockTick0 = 0UL;
+  controller_M->Timing.clockTick1 = 0UL;
+  controller_M->Timing.stopRequestedFlag = false;
   controller_M->Timing.tStart = (0.0);
   rtsiSetSolverData(&controller_M->solverInfo, (void *)&controller_M->intgData);
-  rtsiSetSolverName(&controller_M->solverInfo,"ode4");
   rtmSetTPtr(controller_M, &controller_M->Timing.tArray[0]);
-  controller_M->Timing.stepSize0 = 0.2;
+  controller_M->Timing.t[0] = controller_M->Timing.tStart;
+  controller_M->Timing.t[1] = controller_M->Timing.tStart;
+  controller_M->Sizes.numSampTimes = (2);
+  controller_M->solverMode = CONTROLLER_SOLVER_ODE4;
+  controller_M->ZeroCrossings.num = 0;
+  controller_SetRates(controller_M, CONTROLLER_BASE_STEP_SIZE,
+                      CONTROLLER_OUTER_RATE_RATIO);
+
+  /* Tunable parameters: both banks hold the defaults */
+  controller_M->ParamBank.bank[0] = controller_DefaultP;
+  controller_M->ParamBank.bank[1] = controller_DefaultP;
+  rtmParamIndexStore(&controller_M->ParamBank.inUse, 0UL);
+  rtmParamIndexStore(&controller_M->ParamBank.active, 0UL);
 
   /* InitializeConditions for Integrator: '<S32>/Filter' */
-  controller_X.Filter_CSTATE = 0.0;
+  controller_X->Filter_CSTATE = 0.0;
 
   /* InitializeConditions for Integrator: '<S37>/Integrator' */
-  controller_X.Integrator_CSTATE = 0.0;
+  controller_X->Integrator_CSTATE = 0.0;
 
   /* InitializeConditions for Integrator: '<S82>/Filter' */
-  controller_X.Filter_CSTATE_f = 0.0;
+  controller_X->Filter_CSTATE_f = 0.0;
 
   /* InitializeConditions for Integrator: '<S87>/Integrator' */
-  controller_X.Integrator_CSTATE_i = 0.0;
+  controller_X->Integrator_CSTATE_i = 0.0;
+}
+
+/* Rate configuration: base (inner loop) step size and outer loop divider */
+void controller_SetRates(RT_MODEL_controller_T *const controller_M, time_T
+  baseStepSize, uint32_T outerRateRatio)
+{
+  if (outerRateRatio < 1UL) {
+    outerRateRatio = 1UL;
+  }
+
+  controller_M->Timing.stepSize0 = baseStepSize;
+  controller_M->Timing.stepSize1 = baseStepSize * (real_T)outerRateRatio;
+  controller_M->Timing.TaskCounters.cLimit[0] = 1UL;
+  controller_M->Timing.TaskCounters.cLimit[1] = outerRateRatio;
+
+  /* Restart the subrate phase so the outer loop runs at the next tick */
+  controller_M->Timing.TaskCounters.TID[0] = 0UL;
+  controller_M->Timing.TaskCounters.TID[1] = 0UL;
+
+  /* Discrete solver coefficients depend on the base step size */
+  controller_SetSolverMode(controller_M, controller_M->solverMode);
+}
+
+/* Live parameter update: fill the bank the model is not reading, then
+ * publish it */
+boolean_T controller_SetParams(RT_MODEL_controller_T *const controller_M,
+  const P_controller_T *params)
+{
+  uint32_T active = rtmParamIndexLoad(&controller_M->ParamBank.active);
+  uint32_T next = active ^ 1UL;
+
+  /* The model still reads bank[next] until it has taken bank[active] */
+  if (rtmParamIndexLoad(&controller_M->ParamBank.inUse) != active) {
+    return false;
+  }
+
+  controller_M->ParamBank.bank[next] = *params;
+  rtmParamIndexStore(&controller_M->ParamBank.active, next);
+  return true;
+}
+
+const P_controller_T *controller_GetParams(const RT_MODEL_controller_T *const
+  controller_M)
+{
+  return rtmGetParams(controller_M);
+}
+
+int_T controller_RegisterZeroCrossing(RT_MODEL_controller_T *const
+  controller_M, controller_ZcFcn_T fcn, controller_ZcDirection_T direction,
+  controller_ZcEventFcn_T onEvent, void *ctx)
+{
+  controller_ZcSignal_T *zc;
+  if ((fcn == NULL) || (controller_M->ZeroCrossings.num >=
+                        CONTROLLER_MAX_ZC_SIGNALS)) {
+    return -1;
+  }
+
+  zc = &controller_M->ZeroCrossings.signal[controller_M->ZeroCrossings.num];
+  zc->fcn = fcn;
+  zc->onEvent = onEvent;
+  zc->direction = direction;
+  zc->ctx = ctx;
+  controller_M->ZeroCrossings.gPrev[controller_M->ZeroCrossings.num] = 0.0;
+  return controller_M->ZeroCrossings.num++;
+}
+
+const controller_SolverStats_T *controller_GetSolverStats(const
+  RT_MODEL_controller_T *const controller_M)
+{
+  return &controller_M->SolverStats;
+}
+
+/* Checkpoint: a flat copy of everything the step functions read and write,
+ * leaving out the self-referencing pointers of the instance */
+void controller_Snapshot(const RT_MODEL_controller_T *const controller_M,
+  controller_Snapshot_T *snapshot)
+{
+  snapshot->B = controller_M->B;
+  snapshot->X = controller_M->X;
+  snapshot->XDis = controller_M->XDis;
+  (void) memcpy(snapshot->odeY, controller_M->odeY, sizeof(snapshot->odeY));
+  (void) memcpy(snapshot->odeF, controller_M->odeF, sizeof(snapshot->odeF));
+  snapshot->Y = *controller_M->outputs;
+  snapshot->P = *rtmGetParams(controller_M);
+  snapshot->solverMode = controller_M->solverMode;
+  snapshot->hNext = controller_M->SolverWork.hNext;
+  snapshot->Timing.clockTick0 = controller_M->Timing.clockTick0;
+  snapshot->Timing.stepSize0 = controller_M->Timing.stepSize0;
+  snapshot->Timing.clockTick1 = controller_M->Timing.clockTick1;
+  snapshot->Timing.stepSize1 = controller_M->Timing.stepSize1;
+  snapshot->Timing.TID[0] = controller_M->Timing.TaskCounters.TID[0];
+  snapshot->Timing.TID[1] = controller_M->Timing.TaskCounters.TID[1];
+  snapshot->Timing.cLimit[0] = controller_M->Timing.TaskCounters.cLimit[0];
+  snapshot->Timing.cLimit[1] = controller_M->Timing.TaskCounters.cLimit[1];
+  snapshot->Timing.tArray[0] = controller_M->Timing.tArray[0];
+  snapshot->Timing.tArray[1] = controller_M->Timing.tArray[1];
+}
+
+void controller_Restore(RT_MODEL_controller_T *const controller_M, const
+  controller_Snapshot_T *snapshot)
+{
+  controller_M->B = snapshot->B;
+  controller_M->X = snapshot->X;
+  controller_M->XDis = snapshot->XDis;
+  (void) memcpy(controller_M->odeY, snapshot->odeY, sizeof(snapshot->odeY));
+  (void) memcpy(controller_M->odeF, snapshot->odeF, sizeof(snapshot->odeF));
+  *controller_M->outputs = snapshot->Y;
+
+  /* The snapshot set goes to bank 0, which both indices then select */
+  controller_M->ParamBank.bank[0] = snapshot->P;
+  rtmParamIndexStore(&controller_M->ParamBank.inUse, 0UL);
+  rtmParamIndexStore(&controller_M->ParamBank.active, 0UL);
+  controller_M->Timing.clockTick0 = snapshot->Timing.clockTick0;
+  controller_M->Timing.stepSize0 = snapshot->Timing.stepSize0;
+  controller_M->Timing.clockTick1 = snapshot->Timing.clockTick1;
+  controller_M->Timing.stepSize1 = snapshot->Timing.stepSize1;
+  controller_M->Timing.TaskCounters.TID[0] = snapshot->Timing.TID[0];
+  controller_M->Timing.TaskCounters.TID[1] = snapshot->Timing.TID[1];
+  controller_M->Timing.TaskCounters.cLimit[0] = snapshot->Timing.cLimit[0];
+  controller_M->Timing.TaskCounters.cLimit[1] = snapshot->Timing.cLimit[1];
+  controller_M->Timing.tArray[0] = snapshot->Timing.tArray[0];
+  controller_M->Timing.tArray[1] = snapshot->Timing.tArray[1];
+
+  /* Only a mode change needs the solver name updated */
+  if (controller_M->solverMode != snapshot->solverMode) {
+    controller_SetSolverMode(controller_M, snapshot->solverMode);
+  } else {
+    rt_ertDiscreteCoeffs(controller_M);
+  }
+
+  controller_M->SolverWork.hNext = snapshot->hNext;
+}
+
+/* Solver mode selection */
+void controller_SetSolverMode(RT_MODEL_controller_T *const controller_M,
+  controller_SolverMode_T mode)
+{
+  controller_M->solverMode = mode;
+  controller_M->SolverWork.hNext = 0.0;
+  (void) memset(&controller_M->SolverStats, 0, sizeof
+                (controller_SolverStats_T));
+  switch (mode) {
+   case CONTROLLER_SOLVER_ZOH:
+    rtsiSetSolverName(&controller_M->solverInfo,"discrete-zoh");
+    break;
+
+   case CONTROLLER_SOLVER_TUSTIN:
+    rtsiSetSolverName(&controller_M->solverInfo,"discrete-tustin");
+    break;
+
+   case CONTROLLER_SOLVER_ODE4_FUSED:
+    rtsiSetSolverName(&controller_M->solverInfo,"ode4-fused");
+    break;
+
+   case CONTROLLER_SOLVER_ROS2:
+    rtsiSetSolverName(&controller_M->solverInfo,"ros2");
+    break;
+
+   case CONTROLLER_SOLVER_ODE45:
+    rtsiSetSolverName(&controller_M->solverInfo,"ode45");
+    break;
+
+   default:
+    controller_M->solverMode = CONTROLLER_SOLVER_ODE4;
+    rtsiSetSolverName(&controller_M->solverInfo,"ode4");
+    break;
+  }
+
+  rt_ertDiscreteCoeffs(controller_M);
 }
 
 /* Model terminate function */
-void controller_terminate(void)
+void controller_terminate(RT_MODEL_controller_T *const controller_M)
 {
   /* (no terminate code required) */
+  (void) (controller_M);
 }
 
 /*
@@ -46,10 +46,73 @@
 #define rtmGetTStart(rtm)              ((rtm)->Timing.tStart)
 #endif
 
+#ifndef rtmStepTask
+#define rtmStepTask(rtm, idx)          ((rtm)->Timing.TaskCounters.TID[(idx)] == 0)
+#endif
+
+#ifndef rtmTaskCounter
+#define rtmTaskCounter(rtm, idx)       ((rtm)->Timing.TaskCounters.TID[(idx)])
+#endif
+
+#ifndef rtmGetBlockIO
+#define rtmGetBlockIO(rtm)             (&((rtm)->B))
+#endif
+
+#ifndef rtmGetContStates
+#define rtmGetContStates(rtm)          (&((rtm)->X))
+#endif
+
+#ifndef rtmGetContStateDisabled
+#define rtmGetContStateDisabled(rtm)   (&((rtm)->XDis))
+#endif
+
+#ifndef rtmGetU
+#define rtmGetU(rtm)                   ((rtm)->inputs)
+#endif
+
+#ifndef rtmSetU
+#define rtmSetU(rtm, val)              ((rtm)->inputs = (val))
+#endif
+
+#ifndef rtmGetY
+#define rtmGetY(rtm)                   ((rtm)->outputs)
+#endif
+
+#ifndef rtmSetY
+#define rtmSetY(rtm, val)              ((rtm)->outputs = (val))
+#endif
+
+/*
+ * Rates:
+ *   TID0 - base rate, inner rate loops and continuous states
+ *   TID1 - outer attitude loops, CONTROLLER_OUTER_RATE_RATIO base ticks
+ * Both can be overridden at build time or with controller_SetRates().
+ * controller_step and rt_OneStep run them rate-monotonically: the base
+ * rate first, then TID1 in the ticks where it is due, so the rate command
+ * of the outer loops reaches the inner loops one base tick later.
+ */
+#ifndef CONTROLLER_BASE_STEP_SIZE
+#define CONTROLLER_BASE_STEP_SIZE      (0.2)
+#endif
+
+#ifndef CONTROLLER_OUTER_RATE_RATIO
+#define CONTROLLER_OUTER_RATE_RATIO    (1UL)
+#endif
+
 /* Block signals (default storage) */
 typedef struct {
   real_T FilterCoefficient;            /* '<S40>/Filter Coefficient' */
   real_T FilterCoefficient_c;          /* '<S90>/Filter Coefficient' */
+  real_T Gain;                         /* '<S1>/Gain' */
+  real_T Gain1;                        /* '<S1>/Gain1' */
+  real_T Sum;                          /* '<S1>/Sum' */
+  real_T Sum1;                         /* '<S1>/Sum1' */
+  real_T DerivativeGain;               /* '<S30>/Derivative Gain' */
+  real_T IntegralGain;                 /* '<S34>/Integral Gain' */
+  real_T Sum2;                         /* '<S1>/Sum2' */
+  real_T Sum3;                         /* '<S1>/Sum3' */
+  real_T DerivativeGain_b;             /* '<S80>/Derivative Gain' */
+  real_T IntegralGain_p;               /* '<S84>/Integral Gain' */
 } B_controller_T;
 
 /* Continuous states (default storage) */
@@ -76,17 +139,191 @@ typedef struct {
   boolean_T Integrator_CSTATE_i;       /* '<S87>/Integrator' */
 } XDis_controller_T;
 
-/* Invariant block signals (default storage) */
+/* External inputs (root inport signals with default storage) */
+typedef struct {
+  real_T pitch_sp;                     /* '<Root>/pitch_sp' */
+  real_T pitch;                        /* '<Root>/pitch' */
+  real_T pitch_rate;                   /* '<Root>/pitch_rate' */
+  real_T roll_sp;                      /* '<Root>/roll_sp' */
+  real_T roll;                         /* '<Root>/roll' */
+  real_T roll_rate;                    /* '<Root>/roll_rate' */
+} ExtU_controller_T;
+
+/* External outputs (root outports fed by signals with default storage) */
 typedef struct {
-  const real_T Sum;                    /* '<S1>/Sum' */
-  const real_T Sum1;                   /* '<S1>/Sum1' */
-  const real_T DerivativeGain;         /* '<S30>/Derivative Gain' */
-  const real_T IntegralGain;           /* '<S34>/Integral Gain' */
-  const real_T Sum2;                   /* '<S1>/Sum2' */
-  const real_T Sum3;                   /* '<S1>/Sum3' */
-  const real_T DerivativeGain_b;       /* '<S80>/Derivative Gain' */
-  const real_T IntegralGain_p;         /* '<S84>/Integral Gain' */
-} ConstB_controller_T;
+  real_T alpha_pitch;                  /* '<Root>/alpha_pitch' */
+  real_T alpha_roll;                   /* '<Root>/alpha_roll' */
+} ExtY_controller_T;
+
+/* Parameters (default storage) */
+typedef struct {
+  real_T Gain_Gain;                    /* Expression: Kp_att
+                                        * Referenced by: '<S1>/Gain'
+                                        */
+  real_T Gain1_Gain;                   /* Expression: Kp_att
+                                        * Referenced by: '<S1>/Gain1'
+                                        */
+  real_T PIDController_P;              /* Mask Parameter: PIDController_P
+                                        * Referenced by: '<S42>/Proportional Gain'
+                                        */
+  real_T PIDController_I;              /* Mask Parameter: PIDController_I
+                                        * Referenced by: '<S34>/Integral Gain'
+                                        */
+  real_T PIDController_D;              /* Mask Parameter: PIDController_D
+                                        * Referenced by: '<S30>/Derivative Gain'
+                                        */
+  real_T PIDController_N;              /* Mask Parameter: PIDController_N
+                                        * Referenced by: '<S40>/Filter Coefficient'
+                                        */
+  real_T PIDController1_P;             /* Mask Parameter: PIDController1_P
+                                        * Referenced by: '<S92>/Proportional Gain'
+                                        */
+  real_T PIDController1_I;             /* Mask Parameter: PIDController1_I
+                                        * Referenced by: '<S84>/Integral Gain'
+                                        */
+  real_T PIDController1_D;             /* Mask Parameter: PIDController1_D
+                                        * Referenced by: '<S80>/Derivative Gain'
+                                        */
+  real_T PIDController1_N;             /* Mask Parameter: PIDController1_N
+                                        * Referenced by: '<S90>/Filter Coefficient'
+                                        */
+} P_controller_T;
+
+/*
+ * Solver used for the continuous states at each major time step.
+ *   CONTROLLER_SOLVER_ODE4   - generated fixed-step Runge-Kutta (default)
+ *   CONTROLLER_SOLVER_ODE4_FUSED - the same Runge-Kutta scheme computed in
+ *                              one inlined kernel, without re-entering the
+ *                              step function for the minor time steps
+ *   CONTROLLER_SOLVER_ZOH    - exact discretization of the filter and
+ *                              integrator for inputs held over the step
+ *   CONTROLLER_SOLVER_TUSTIN - bilinear (trapezoidal) discretization
+ *   CONTROLLER_SOLVER_ROS2   - two-stage L-stable Rosenbrock method with a
+ *                              finite-difference Jacobian, for large steps
+ *                              across the stiff derivative-filter pole
+ *   CONTROLLER_SOLVER_ODE45  - Dormand-Prince 5(4) with error control,
+ *                              taking as many substeps per major time step
+ *                              as the tolerances require
+ * The discrete modes are stable for any step size and update the states in
+ * a single pass with coefficients precomputed by controller_SetSolverMode,
+ * and again whenever a new parameter set takes effect.
+ * ROS2 and ODE45 are meant for offline studies: they go through the
+ * generated minor time step path like ODE4, and ODE45's cost varies from
+ * step to step.
+ */
+typedef enum {
+  CONTROLLER_SOLVER_ODE4 = 0,
+  CONTROLLER_SOLVER_ODE4_FUSED,
+  CONTROLLER_SOLVER_ZOH,
+  CONTROLLER_SOLVER_TUSTIN,
+  CONTROLLER_SOLVER_ROS2,
+  CONTROLLER_SOLVER_ODE45
+} controller_SolverMode_T;
+
+/* ODE45 error control: a substep is accepted when every state's error
+ * estimate is within ABSTOL + RELTOL*|x| in the RMS sense */
+#ifndef CONTROLLER_ODE45_RELTOL
+#define CONTROLLER_ODE45_RELTOL        (1.0E-6)
+#endif
+
+#ifndef CONTROLLER_ODE45_ABSTOL
+#define CONTROLLER_ODE45_ABSTOL        (1.0E-10)
+#endif
+
+/* ODE45 substeps (accepted and rejected) allowed per major time step */
+#ifndef CONTROLLER_ODE45_MAX_STEPS
+#define CONTROLLER_ODE45_MAX_STEPS     (100000UL)
+#endif
+
+/* Solver work counters, reset by controller_SetSolverMode */
+typedef struct {
+  unsigned long long steps;            /* Accepted (sub)steps */
+  unsigned long long rejected;         /* Rejected ODE45 substeps */
+  unsigned long long derivEvals;       /* Evaluations of the derivatives */
+  unsigned long long jacobianEvals;    /* ROS2 Jacobians */
+  unsigned long long zeroCrossings;    /* Events located by ODE45 */
+} controller_SolverStats_T;
+
+/*
+ * Complete model state at a major time step, as a plain copyable struct.
+ * Taken with controller_Snapshot() and loaded into the same or any other
+ * initialized instance with controller_Restore(), so a simulation can be
+ * forked into branches without re-running the common prefix.  The instance
+ * configuration (solver mode, rates) is included; the root I/O bindings
+ * are not, a restored instance keeps its own.
+ */
+typedef struct {
+  B_controller_T B;
+  X_controller_T X;
+  XDis_controller_T XDis;
+  real_T odeY[4];
+  real_T odeF[4][4];
+  ExtY_controller_T Y;                 /* Outputs held since the last step */
+  P_controller_T P;                    /* Parameter set in use */
+  controller_SolverMode_T solverMode;
+  time_T hNext;                        /* ODE45 substep size carried over */
+  struct {
+    uint32_T clockTick0;
+    time_T stepSize0;
+    uint32_T clockTick1;
+    time_T stepSize1;
+    uint32_T TID[2];
+    uint32_T cLimit[2];
+    time_T tArray[2];
+  } Timing;
+} controller_Snapshot_T;
+
+/*
+ * Zero-crossing signals, located by the ODE45 mode.
+ *
+ * A registered signal g(t, x) is evaluated at the start of each major time
+ * step and after every accepted ODE45 substep.  When it changes sign in the
+ * registered direction, the crossing is located by Illinois (modified
+ * regula falsi) iteration on the Dormand-Prince dense output, without
+ * further derivative evaluations, the substep is cut at the crossing and
+ * the event function is called with the state there; it may change the
+ * state (e.g. reset an integrator).  Integration then resumes from the
+ * event to the end of the major time step, at the cost of one derivative
+ * evaluation, so the major step size is unaffected.
+ *
+ * g may use the block signals and inputs held over the major time step
+ * but must depend on the continuous states only through x.  The fixed-step
+ * and discrete modes do not locate zero crossings.
+ *
+ * Only the controller's own states are integrated here.  The plant
+ * (pendulum_plant.h) is advanced by the caller between controller steps,
+ * so plant events such as gimbal saturation, ground contact or tip-over
+ * cannot be signals of this solver: the caller detects them in its own
+ * plant integration (plant_saturate limits the gimbal commands,
+ * closedLoop_run stops at tip-over) and applies their effect through the
+ * inports, or to the states between steps.
+ */
+#ifndef CONTROLLER_MAX_ZC_SIGNALS
+#define CONTROLLER_MAX_ZC_SIGNALS      (8)
+#endif
+
+/* Event location stops once the crossing is bracketed this tightly [s] */
+#ifndef CONTROLLER_ZC_TIME_TOL
+#define CONTROLLER_ZC_TIME_TOL         (1.0E-12)
+#endif
+
+typedef enum {
+  CONTROLLER_ZC_RISING = 0,            /* g from < 0 to >= 0 */
+  CONTROLLER_ZC_FALLING,               /* g from > 0 to <= 0 */
+  CONTROLLER_ZC_EITHER
+} controller_ZcDirection_T;
+
+typedef real_T (*controller_ZcFcn_T)(const RT_MODEL_controller_T *
+  controller_M, time_T t, const X_controller_T *x, void *ctx);
+typedef void (*controller_ZcEventFcn_T)(RT_MODEL_controller_T *controller_M,
+  time_T t, X_controller_T *x, controller_ZcDirection_T direction, void *ctx);
+
+typedef struct {
+  controller_ZcFcn_T fcn;
+  controller_ZcEventFcn_T onEvent;     /* May be NULL */
+  controller_ZcDirection_T direction;
+  void *ctx;
+} controller_ZcSignal_T;
 
 #ifndef ODE4_INTG
 #define ODE4_INTG
@@ -114,6 +351,84 @@ struct tag_RTM_controller_T {
   real_T odeY[4];
   real_T odeF[4][4];
   ODE4_IntgData intgData;
+  controller_SolverMode_T solverMode;
+
+  /*
+   * SolverWork:
+   * Stage derivatives and iteration matrix of the ROS2 and ODE45 modes,
+   * and the ODE45 substep size carried from one major time step to the
+   * next.
+   */
+  struct {
+    real_T k[7][4];
+    real_T W[4][4];
+    int_T piv[4];
+    time_T hNext;
+  } SolverWork;
+
+  controller_SolverStats_T SolverStats;
+
+  /*
+   * ZeroCrossings:
+   * Registered signals and their values at the start of the current
+   * substep.
+   */
+  struct {
+    controller_ZcSignal_T signal[CONTROLLER_MAX_ZC_SIGNALS];
+    real_T gPrev[CONTROLLER_MAX_ZC_SIGNALS];
+    int_T num;
+  } ZeroCrossings;
+
+  /*
+   * DiscCoeffs:
+   * Per-step coefficients of the discrete solver modes,
+   * x[k+1] = FilterA*x[k] + FilterB*u[k] for the derivative filters,
+   * from the filter coefficients of the parameter set in use.
+   */
+  struct {
+    real_T FilterA;                    /* '<S32>/Filter' */
+    real_T FilterB;
+    real_T FilterA_f;                  /* '<S82>/Filter' */
+    real_T FilterB_f;
+  } DiscCoeffs;
+
+  /*
+   * ParamBank:
+   * Double-buffered tunable parameters.  The step functions read
+   * bank[inUse]; controller_SetParams fills the other bank and publishes it
+   * in "active", and controller_SetEventsForThisBaseStep switches to it at
+   * the start of the next base-rate tick, before any rate runs, and
+   * acknowledges the switch in "inUse".  Both indices are accessed
+   * atomically.
+   */
+  struct {
+    P_controller_T bank[2];
+    uint32_T active;
+    uint32_T inUse;
+  } ParamBank;
+
+  /*
+   * Instance data:
+   * Block signals, continuous states and disabled flags are owned by the
+   * model instance so that any number of controllers can coexist in one
+   * address space and be stepped concurrently from different threads.
+   */
+  B_controller_T B;
+  X_controller_T X;
+  XDis_controller_T XDis;
+
+  /*
+   * Root-level I/O:
+   * The step functions read the inports through "inputs" and write the
+   * outports through "outputs".  Both point to the default storage U and
+   * Y after controller_initialize and can be rebound with rtmSetU/rtmSetY
+   * to externally owned buffers (DMA, shared memory), so sensors are read
+   * and actuators written in place with no copies.
+   */
+  ExtU_controller_T *inputs;
+  ExtY_controller_T *outputs;
+  ExtU_controller_T U;
+  ExtY_controller_T Y;
 
   /*
    * Sizes:
@@ -136,6 +451,12 @@ struct tag_RTM_controller_T {
     uint32_T clockTick0;
     time_T stepSize0;
     uint32_T clockTick1;
+    time_T stepSize1;
+    struct {
+      uint32_T TID[2];
+      uint32_T cLimit[2];
+    } TaskCounters;
+
     time_T tStart;
     SimTimeStep simTimeStep;
     boolean_T stopRequestedFlag;
@@ -144,34 +465,71 @@ struct tag_RTM_controller_T {
   } Timing;
 };
 
-/* Block signals (default storage) */
-extern B_controller_T controller_B;
+/* Default tunable parameters, loaded by controller_initialize */
+extern const P_controller_T controller_DefaultP;
 
-/* Continuous states (default storage) */
-extern X_controller_T controller_X;
+/* Model entry point functions */
+extern void controller_initialize(RT_MODEL_controller_T *const controller_M);
+extern void controller_step(RT_MODEL_controller_T *const controller_M);
+extern void controller_step0(RT_MODEL_controller_T *const controller_M);
+extern void controller_step1(RT_MODEL_controller_T *const controller_M);
 
-/* Disabled states (default storage) */
-extern XDis_controller_T controller_XDis;
-extern const ConstB_controller_T controller_ConstB;/* constant block i/o */
+/* Starts a base-rate tick; call before controller_step0 when running the
+ * rates separately (controller_step calls it) */
+extern void controller_SetEventsForThisBaseStep(RT_MODEL_controller_T *const
+  controller_M, boolean_T *eventFlags);
 
-/* Model entry point functions */
-extern void controller_initialize(void);
-extern void controller_step(void);
-extern void controller_terminate(void);
+extern void controller_terminate(RT_MODEL_controller_T *const controller_M);
 
-/* Real-time Model object */
-extern RT_MODEL_controller_T *const controller_M;
+/* Sets the base step size and the outer loop rate divider; call after
+ * controller_initialize. */
+extern void controller_SetRates(RT_MODEL_controller_T *const controller_M,
+  time_T baseStepSize, uint32_T outerRateRatio);
 
-/*-
- * These blocks were eliminated from the model due to optimizations:
- *
- * Block '<S42>/Proportional Gain' : Unused code path elimination
- * Block '<S46>/Sum' : Unused code path elimination
- * Block '<S92>/Proportional Gain' : Unused code path elimination
- * Block '<S96>/Sum' : Unused code path elimination
- * Block '<S1>/Gain' : Eliminated nontunable gain of 1
- * Block '<S1>/Gain1' : Eliminated nontunable gain of 1
- */
+/* Selects the solver mode; call after controller_initialize and whenever
+ * Timing.stepSize0 changes. */
+extern void controller_SetSolverMode(RT_MODEL_controller_T *const controller_M,
+  controller_SolverMode_T mode);
+
+/* Live parameter update, lock free and wait free on both sides.  Copies
+ * *params into the bank the model is not reading and publishes it; the
+ * model takes the whole set at the start of its next base-rate tick
+ * (controller_step, or controller_SetEventsForThisBaseStep in rt_OneStep),
+ * so the inner and outer loops switch in the same tick and no step sees a
+ * mix of old and new values.  Returns false, without
+ * changes, while the previous update has not been taken yet; retry after
+ * the next step.  Calls for one model must come from a single thread. */
+extern boolean_T controller_SetParams(RT_MODEL_controller_T *const controller_M,
+  const P_controller_T *params);
+
+/* Parameter set the model is currently stepping with; call from the thread
+ * that steps the model */
+extern const P_controller_T *controller_GetParams(const RT_MODEL_controller_T *
+  const controller_M);
+
+/* Work done by the solver since the mode was last set */
+extern const controller_SolverStats_T *controller_GetSolverStats(const
+  RT_MODEL_controller_T *const controller_M);
+
+/* Registers a zero-crossing signal for the ODE45 mode, see
+ * controller_ZcSignal_T; returns its index, or -1 when
+ * CONTROLLER_MAX_ZC_SIGNALS are registered already.  Registrations belong
+ * to the instance and are kept by controller_Restore. */
+extern int_T controller_RegisterZeroCrossing(RT_MODEL_controller_T *const
+  controller_M, controller_ZcFcn_T fcn, controller_ZcDirection_T direction,
+  controller_ZcEventFcn_T onEvent, void *ctx);
+
+/* Copies the complete state of the model into *snapshot; call between
+ * steps from the thread that steps the model */
+extern void controller_Snapshot(const RT_MODEL_controller_T *const
+  controller_M, controller_Snapshot_T *snapshot);
+
+/* Loads *snapshot into an initialized instance, which then continues
+ * bit for bit as the instance the snapshot was taken from.  A parameter
+ * update pending in that instance is discarded; do not call concurrently
+ * with controller_SetParams on it. */
+extern void controller_Restore(RT_MODEL_controller_T *const controller_M,
+  const controller_Snapshot_T *snapshot);
 
 /*-
  * The generated code includes comments that allow you to trace directly
@@ -0,0 +1,148 @@
+#include <string.h>
+#include "controller_axes.h"
+#include "controller_batch.h"
+#include "controller_private.h"
+#include "controller_vec.h"
+
+#if (CONTROLLER_AXES_MAX % CONTROLLER_BATCH_ALIGN_LANES) != 0
+#error "CONTROLLER_AXES_MAX must be a multiple of CONTROLLER_BATCH_ALIGN_LANES"
+#endif
+
+/* Yaw: rate loop only, rate setpoint through rateFf */
+static const CascadeGains_T controller_axes_yawGains = {
+  0.0,                                 /* Kp_att */
+  0.2,                                 /* Kp_rate */
+  0.1,                                 /* Ki_rate */
+  0.0,                                 /* Kd_rate */
+  CONTROLLER_FILTER_COEFFICIENT        /* N */
+};
+
+/* Altitude: climb rate command from the altitude error, thrust from the
+ * climb rate error, hover thrust in bias */
+static const CascadeGains_T controller_axes_altitudeGains = {
+  1.0,                                 /* Kp_att */
+  0.5,                                 /* Kp_rate */
+  0.2,                                 /* Ki_rate */
+  0.01,                                /* Kd_rate */
+  100.0                                /* N */
+};
+
+void controller_axes_init(controller_Axes_T *axes, time_T baseStepSize,
+  uint32_T outerRateRatio)
+{
+  (void) memset(axes, 0, sizeof(controller_Axes_T));
+  axes->stepSize0 = baseStepSize;
+  axes->outerRateRatio = (outerRateRatio < 1UL) ? 1UL : outerRateRatio;
+}
+
+int_T controller_axes_add(controller_Axes_T *axes, const char_T *name, const
+  CascadeGains_T *gains)
+{
+  int_T idx = axes->numAxes;
+  if (idx >= CONTROLLER_AXES_MAX) {
+    return -1;
+  }
+
+  axes->name[idx] = name;
+  axes->sp[idx] = 0.0;
+  axes->pos[idx] = 0.0;
+  axes->rate[idx] = 0.0;
+  axes->rateFf[idx] = 0.0;
+  axes->bias[idx] = 0.0;
+  axes->RateCmd[idx] = 0.0;
+  axes->FilterCoefficient[idx] = 0.0;
+  axes->Filter_CSTATE[idx] = 0.0;
+  axes->Integrator_CSTATE[idx] = 0.0;
+  axes->alpha[idx] = 0.0;
+  controller_axes_setGains(axes, idx, gains);
+  axes->numAxes = idx + 1;
+  return idx;
+}
+
+void controller_axes_setGains(controller_Axes_T *axes, int_T idx, const
+  CascadeGains_T *gains)
+{
+  axes->Kp_att[idx] = gains->Kp_att;
+  axes->Kp_rate[idx] = gains->Kp_rate;
+  axes->Ki_rate[idx] = gains->Ki_rate;
+  axes->Kd_rate[idx] = gains->Kd_rate;
+  axes->N[idx] = gains->N;
+
+  /* The model's own ZOH coefficients */
+  controller_DiscreteFilterCoeffs(CONTROLLER_SOLVER_ZOH, gains->N,
+    axes->stepSize0, &axes->FilterA[idx], &axes->FilterB[idx]);
+}
+
+void controller_axes_initTvc(controller_Axes_T *axes, const
+  RT_MODEL_controller_T *const controller_M)
+{
+  const P_controller_T *controller_P = controller_GetParams(controller_M);
+  CascadeGains_T g;
+  controller_axes_init(axes, controller_M->Timing.stepSize0,
+                       controller_M->Timing.TaskCounters.cLimit[1]);
+  g.Kp_att = controller_P->Gain_Gain;
+  g.Kp_rate = controller_P->PIDController_P;
+  g.Ki_rate = controller_P->PIDController_I;
+  g.Kd_rate = controller_P->PIDController_D;
+  g.N = controller_P->PIDController_N;
+  (void) controller_axes_add(axes, "pitch", &g);
+  g.Kp_att = controller_P->Gain1_Gain;
+  g.Kp_rate = controller_P->PIDController1_P;
+  g.Ki_rate = controller_P->PIDController1_I;
+  g.Kd_rate = controller_P->PIDController1_D;
+  g.N = controller_P->PIDController1_N;
+  (void) controller_axes_add(axes, "roll", &g);
+  (void) controller_axes_add(axes, "yaw", &controller_axes_yawGains);
+  (void) controller_axes_add(axes, "altitude", &controller_axes_altitudeGains);
+}
+
+/*
+ * The cascade of every axis, in the operation order of controller_step0
+ * with the ZOH update followed by controller_step1 when it is due, as
+ * controller_step runs them.  Padding lanes hold zero gains and
+ * coefficients and stay at zero.
+ */
+void controller_axes_step(controller_Axes_T *axes)
+{
+  const batch_vec_T hv = bvSet1(axes->stepSize0);
+  int_T numLanes = ((axes->numAxes + BATCH_VLEN - 1) / BATCH_VLEN) * BATCH_VLEN;
+  int_T i;
+  for (i = 0; i < numLanes; i += BATCH_VLEN) {
+    /* Inner loops: Sum1, Derivative Gain, Integral Gain */
+    batch_vec_T e = bvSub(bvLoad(&axes->RateCmd[i]), bvLoad(&axes->rate[i]));
+    batch_vec_T dg = bvMul(bvLoad(&axes->Kd_rate[i]), e);
+    batch_vec_T ig = bvMul(bvLoad(&axes->Ki_rate[i]), e);
+    batch_vec_T xf = bvLoad(&axes->Filter_CSTATE[i]);
+    batch_vec_T xi = bvLoad(&axes->Integrator_CSTATE[i]);
+    batch_vec_T fc = bvMul(bvSub(dg, xf), bvLoad(&axes->N[i]));
+    bvStore(&axes->FilterCoefficient[i], fc);
+    bvStore(&axes->alpha[i], bvAdd(bvAdd(bvAdd(bvMul(bvLoad(&axes->Kp_rate[i]),
+      e), xi), fc), bvLoad(&axes->bias[i])));
+
+    /* Update for the filters and integrators */
+    bvStore(&axes->Filter_CSTATE[i], bvAdd(bvMul(bvLoad(&axes->FilterA[i]), xf),
+      bvMul(bvLoad(&axes->FilterB[i]), dg)));
+    bvStore(&axes->Integrator_CSTATE[i], bvAdd(xi, bvMul(hv, ig)));
+  }
+
+  if (axes->TID1 == 0UL) {
+    /* Outer loops: Sum, Gain, taken by the inner loops at the next tick */
+    for (i = 0; i < numLanes; i += BATCH_VLEN) {
+      batch_vec_T sum = bvSub(bvLoad(&axes->sp[i]), bvLoad(&axes->pos[i]));
+      bvStore(&axes->RateCmd[i], bvAdd(bvMul(bvLoad(&axes->Kp_att[i]), sum),
+        bvLoad(&axes->rateFf[i])));
+    }
+  }
+
+  ++axes->clockTick0;
+  axes->TID1++;
+  if (axes->TID1 >= axes->outerRateRatio) {
+    axes->TID1 = 0UL;
+  }
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,130 @@
+
+
+#ifndef controller_axes_h_
+#define controller_axes_h_
+#include "rtwtypes.h"
+#include "controller.h"
+#include "closed_loop.h"
+
+/*
+ * N-axis cascade engine.
+ *
+ * Every axis is the cascade of '<S1>': an outer P loop on the position
+ * error producing a rate command, and an inner PID loop on the rate error
+ * whose derivative path is the first-order filter '<S32>'/'<S82>' and
+ * whose integral path is '<S37>'/'<S87>', advanced with the exact discrete
+ * update of CONTROLLER_SOLVER_ZOH:
+ *
+ *   e        = RateCmd - rate                   (base rate)
+ *   FilterCoefficient = (Kd_rate*e - Filter_CSTATE)*N
+ *   alpha    = (Kp_rate*e + Integrator_CSTATE) + FilterCoefficient + bias
+ *   Filter_CSTATE     = FilterA*Filter_CSTATE + FilterB*(Kd_rate*e)
+ *   Integrator_CSTATE += h*(Ki_rate*e)
+ *   RateCmd  = Kp_att*(sp - pos) + rateFf       (outer rate, after the base
+ *                                                rate, as controller_step)
+ *
+ * Parameters, inputs, signals and states are held one array per quantity
+ * with one element per axis, and a single kernel advances all axes at once
+ * with the axes as vector lanes (controller_vec.h).  An axis is a row in
+ * the table, not a code path, and up to the vector width (4 with AVX, 8
+ * with AVX-512) the step time hardly depends on the number of axes.  It
+ * is not lower than the scalar code's for a few axes, though: inputs
+ * written one axis at a time just before the step cannot be forwarded
+ * from those scalar stores to the kernel's vector loads, which wait for
+ * the stores to complete.  In controller_bench one axis takes about 20 ns
+ * in the AVX-512 exact build against 5 to 7 ns in the scalar build, and
+ * the vector kernel pays off from about four axes.  Without vector
+ * instructions every axis adds its own cost.
+ *
+ * rateFf feeds a rate setpoint past the outer loop; with Kp_att = 0 the
+ * axis is a pure rate loop (yaw).  bias is added to the command, e.g. the
+ * hover thrust of an altitude loop.  With rateFf and bias at zero and the
+ * model's gains, the pitch and roll axes are bit-identical to the
+ * generated model in CONTROLLER_SOLVER_ZOH mode, outer rate divider
+ * included, when both are built without floating point contraction
+ * (-ffp-contract=off); see controller_batch.h.  controller_check compares
+ * them tick by tick.
+ *
+ * The table is a plain structure with 64-byte aligned arrays; declare it
+ * static or on the stack, or allocate it with aligned_alloc().
+ */
+#ifndef CONTROLLER_AXES_MAX
+#define CONTROLLER_AXES_MAX            8
+#endif
+
+/* Axes of controller_axes_initTvc() */
+typedef enum {
+  CONTROLLER_AXIS_PITCH = 0,           /* '<S1>' pitch cascade */
+  CONTROLLER_AXIS_ROLL,                /* '<S1>' roll cascade */
+  CONTROLLER_AXIS_YAW,                 /* Yaw rate loop */
+  CONTROLLER_AXIS_ALTITUDE,            /* Altitude and climb rate to thrust */
+  CONTROLLER_NUM_TVC_AXES
+} controller_AxisId_T;
+
+typedef struct {
+  int_T numAxes;                       /* Axes in use */
+  time_T stepSize0;                    /* Base (inner loop) step size */
+  uint32_T outerRateRatio;             /* Base ticks per outer loop tick */
+  uint32_T TID1;                       /* Base ticks until the outer loop */
+  uint32_T clockTick0;
+  const char_T *name[CONTROLLER_AXES_MAX];
+
+  /* Parameters, set through controller_axes_add/_setGains */
+  _Alignas(64) real_T Kp_att[CONTROLLER_AXES_MAX];
+  real_T Kp_rate[CONTROLLER_AXES_MAX];
+  real_T Ki_rate[CONTROLLER_AXES_MAX];
+  real_T Kd_rate[CONTROLLER_AXES_MAX];
+  real_T N[CONTROLLER_AXES_MAX];
+  real_T FilterA[CONTROLLER_AXES_MAX]; /* exp(-N*h) */
+  real_T FilterB[CONTROLLER_AXES_MAX]; /* 1 - exp(-N*h) */
+
+  /* Inputs */
+  real_T sp[CONTROLLER_AXES_MAX];      /* Position setpoint */
+  real_T pos[CONTROLLER_AXES_MAX];     /* Measured position */
+  real_T rate[CONTROLLER_AXES_MAX];    /* Measured rate */
+  real_T rateFf[CONTROLLER_AXES_MAX];  /* Rate setpoint feedforward */
+  real_T bias[CONTROLLER_AXES_MAX];    /* Command offset */
+
+  /* Block signals */
+  real_T RateCmd[CONTROLLER_AXES_MAX]; /* '<S1>/Gain' plus feedforward */
+  real_T FilterCoefficient[CONTROLLER_AXES_MAX];/* '<S40>/Filter Coefficient' */
+
+  /* States */
+  real_T Filter_CSTATE[CONTROLLER_AXES_MAX];/* '<S32>/Filter' */
+  real_T Integrator_CSTATE[CONTROLLER_AXES_MAX];/* '<S37>/Integrator' */
+
+  /* Outputs */
+  real_T alpha[CONTROLLER_AXES_MAX];   /* Actuator command */
+} controller_Axes_T;
+
+/* Empty table stepping at baseStepSize, outer loops every outerRateRatio
+ * base ticks */
+extern void controller_axes_init(controller_Axes_T *axes, time_T baseStepSize,
+  uint32_T outerRateRatio);
+
+/* Appends an axis with zero inputs and states; returns its index, or -1
+ * when the table is full */
+extern int_T controller_axes_add(controller_Axes_T *axes, const char_T *name,
+  const CascadeGains_T *gains);
+
+/* Changes the gains of an axis between steps, keeping its states */
+extern void controller_axes_setGains(controller_Axes_T *axes, int_T idx, const
+  CascadeGains_T *gains);
+
+/* Thrust-vector control set in controller_AxisId_T order: pitch and roll
+ * with the gains of a model, yaw and altitude with starting points for
+ * tuning */
+extern void controller_axes_initTvc(controller_Axes_T *axes, const
+  RT_MODEL_controller_T *const controller_M);
+
+/* One base-rate step of every axis: inner loops, then the outer loops when
+ * due, whose rate commands the inner loops take at the next step */
+extern void controller_axes_step(controller_Axes_T *axes);
+
+#endif                                 /* controller_axes_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,318 @@
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "controller_batch.h"
+#include "controller_private.h"
+#include "controller_vec.h"
+
+#define BATCH_ALIGN_BYTES              (CONTROLLER_BATCH_ALIGN_LANES * sizeof(real_T))
+#define BATCH_NUM_ARRAYS               16
+
+controller_Batch_T *controller_batch_create(int_T numInstances, const
+  RT_MODEL_controller_T *const controller_M)
+{
+  controller_Batch_T *batch;
+  size_t numLanes;
+  size_t bytes;
+  uintptr_t base;
+  real_T *arrays;
+  if ((numInstances <= 0) || !controller_batch_supportsMode
+      (controller_M->solverMode)) {
+    return (NULL);
+  }
+
+  batch = (controller_Batch_T *)malloc(sizeof(controller_Batch_T));
+  if (batch == (NULL)) {
+    return (NULL);
+  }
+
+  numLanes = (((size_t)numInstances + CONTROLLER_BATCH_ALIGN_LANES - 1U) /
+              CONTROLLER_BATCH_ALIGN_LANES) * CONTROLLER_BATCH_ALIGN_LANES;
+  bytes = BATCH_NUM_ARRAYS * numLanes * sizeof(real_T) + BATCH_ALIGN_BYTES;
+  batch->memory = malloc(bytes);
+  if (batch->memory == (NULL)) {
+    free(batch);
+    return (NULL);
+  }
+
+  base = ((uintptr_t)batch->memory + BATCH_ALIGN_BYTES - 1U) &
+    ~((uintptr_t)BATCH_ALIGN_BYTES - 1U);
+  arrays = (real_T *)base;
+  batch->numInstances = numInstances;
+  batch->numLanes = (int_T)numLanes;
+  batch->U.pitch_sp = arrays;
+  batch->U.pitch = arrays + numLanes;
+  batch->U.pitch_rate = arrays + 2U * numLanes;
+  batch->U.roll_sp = arrays + 3U * numLanes;
+  batch->U.roll = arrays + 4U * numLanes;
+  batch->U.roll_rate = arrays + 5U * numLanes;
+  batch->Gain = arrays + 6U * numLanes;
+  batch->Gain1 = arrays + 7U * numLanes;
+  batch->FilterCoefficient = arrays + 8U * numLanes;
+  batch->FilterCoefficient_c = arrays + 9U * numLanes;
+  batch->Filter_CSTATE = arrays + 10U * numLanes;
+  batch->Integrator_CSTATE = arrays + 11U * numLanes;
+  batch->Filter_CSTATE_f = arrays + 12U * numLanes;
+  batch->Integrator_CSTATE_i = arrays + 13U * numLanes;
+  batch->Y.alpha_pitch = arrays + 14U * numLanes;
+  batch->Y.alpha_roll = arrays + 15U * numLanes;
+  (void) controller_batch_initialize(batch, controller_M);
+  return batch;
+}
+
+void controller_batch_destroy(controller_Batch_T *batch)
+{
+  if (batch != (NULL)) {
+    free(batch->memory);
+    free(batch);
+  }
+}
+
+/* Discrete filter coefficients of the parameter set, as the model
+ * computes them when it takes the set */
+static void batch_discreteCoeffs(controller_Batch_T *batch)
+{
+  controller_DiscreteFilterCoeffs(batch->solverMode, batch->P.PIDController_N,
+    batch->Timing.stepSize0, &batch->FilterA, &batch->FilterB);
+  controller_DiscreteFilterCoeffs(batch->solverMode, batch->P.PIDController1_N,
+    batch->Timing.stepSize0, &batch->FilterA_f, &batch->FilterB_f);
+}
+
+boolean_T controller_batch_supportsMode(controller_SolverMode_T mode)
+{
+  switch (mode) {
+   case CONTROLLER_SOLVER_ODE4:
+   case CONTROLLER_SOLVER_ODE4_FUSED:
+   case CONTROLLER_SOLVER_ZOH:
+   case CONTROLLER_SOLVER_TUSTIN:
+    return true;
+
+   default:
+    return false;
+  }
+}
+
+boolean_T controller_batch_initialize(controller_Batch_T *batch, const
+  RT_MODEL_controller_T *const controller_M)
+{
+  if (!controller_batch_supportsMode(controller_M->solverMode)) {
+    return false;
+  }
+
+  /* Inports, block I/O, outports and InitializeConditions for all
+   * integrators, padding lanes included */
+  (void) memset((void *)batch->U.pitch_sp, 0, BATCH_NUM_ARRAYS * (size_t)
+                batch->numLanes * sizeof(real_T));
+  batch->P = *controller_GetParams(controller_M);
+  batch->Timing.clockTick0 = 0UL;
+  batch->Timing.clockTick1 = 0UL;
+  batch->Timing.stepSize0 = controller_M->Timing.stepSize0;
+  batch->Timing.TID1 = 0UL;
+  batch->Timing.outerRateRatio = controller_M->Timing.TaskCounters.cLimit[1];
+  batch->Timing.t = 0.0;
+  batch->solverMode = controller_M->solverMode;
+  batch_discreteCoeffs(batch);
+  return true;
+}
+
+void controller_batch_setParams(controller_Batch_T *batch, const
+  P_controller_T *params)
+{
+  batch->P = *params;
+  batch_discreteCoeffs(batch);
+}
+
+/*
+ * Inner rate loop of one axis across the batch: '<S1>/Sum1', the Derivative
+ * and Integral Gain inputs and the outport of each lane, as controller_step0
+ * computes them, then the four ODE4 stages of rt_ertODEUpdateContinuousStates
+ * with the derivatives (DerivativeGain - x) * N and IntegralGain inlined.
+ * The last stage's filter coefficient is left in fc, as the scalar model
+ * leaves it in the block I/O.
+ */
+static void batch_ode4_inner(const real_T *gain, const real_T *rate, real_T
+  *xf, real_T *xi, real_T *fc, real_T *alpha, real_T kp, real_T ki, real_T kd,
+  real_T N, int_T numLanes, time_T h)
+{
+  const batch_vec_T kpv = bvSet1(kp);
+  const batch_vec_T kiv = bvSet1(ki);
+  const batch_vec_T kdv = bvSet1(kd);
+  const batch_vec_T n = bvSet1(N);
+  const batch_vec_T hv = bvSet1(h);
+  const batch_vec_T half = bvSet1(0.5 * h);
+  const batch_vec_T sixth = bvSet1(h / 6.0);
+  const batch_vec_T two = bvSet1(2.0);
+  int_T i;
+  for (i = 0; i < numLanes; i += BATCH_VLEN) {
+    batch_vec_T e = bvSub(bvLoad(&gain[i]), bvLoad(&rate[i]));
+    batch_vec_T dg = bvMul(kdv, e);
+    batch_vec_T ig = bvMul(kiv, e);
+    batch_vec_T y = bvLoad(&xf[i]);
+    batch_vec_T yi = bvLoad(&xi[i]);
+    batch_vec_T f0 = bvMul(bvSub(dg, y), n);
+    batch_vec_T f1;
+    batch_vec_T f2;
+    batch_vec_T f3;
+    bvStore(&alpha[i], bvAdd(bvAdd(bvMul(kpv, e), yi), f0));
+    f1 = bvMul(bvSub(dg, bvAdd(y, bvMul(half, f0))), n);
+    f2 = bvMul(bvSub(dg, bvAdd(y, bvMul(half, f1))), n);
+    f3 = bvMul(bvSub(dg, bvAdd(y, bvMul(hv, f2))), n);
+    bvStore(&fc[i], f3);
+    bvStore(&xf[i], bvAdd(y, bvMul(sixth, bvAdd(bvAdd(bvAdd(f0, bvMul(two, f1)),
+      bvMul(two, f2)), f3))));
+
+    /* All four stage derivatives of the integrator equal the Integral Gain */
+    bvStore(&xi[i], bvAdd(yi, bvMul(sixth, bvAdd(bvAdd(bvAdd(ig, bvMul(two, ig)),
+      bvMul(two, ig)), ig))));
+  }
+}
+
+/*
+ * Inner rate loop of one axis across the batch in the discrete modes: the
+ * same signals as batch_ode4_inner, then rt_ertDiscreteUpdateStates's
+ * x = a*x + b*DerivativeGain and x += h*IntegralGain.  The filter
+ * coefficient is the one of the major step.
+ */
+static void batch_discrete_inner(const real_T *gain, const real_T *rate,
+  real_T *xf, real_T *xi, real_T *fc, real_T *alpha, real_T kp, real_T ki,
+  real_T kd, real_T N, real_T a, real_T b, int_T numLanes, time_T h)
+{
+  const batch_vec_T kpv = bvSet1(kp);
+  const batch_vec_T kiv = bvSet1(ki);
+  const batch_vec_T kdv = bvSet1(kd);
+  const batch_vec_T n = bvSet1(N);
+  const batch_vec_T av = bvSet1(a);
+  const batch_vec_T bv = bvSet1(b);
+  const batch_vec_T hv = bvSet1(h);
+  int_T i;
+  for (i = 0; i < numLanes; i += BATCH_VLEN) {
+    batch_vec_T e = bvSub(bvLoad(&gain[i]), bvLoad(&rate[i]));
+    batch_vec_T dg = bvMul(kdv, e);
+    batch_vec_T ig = bvMul(kiv, e);
+    batch_vec_T y = bvLoad(&xf[i]);
+    batch_vec_T yi = bvLoad(&xi[i]);
+    batch_vec_T f0 = bvMul(bvSub(dg, y), n);
+    bvStore(&fc[i], f0);
+    bvStore(&alpha[i], bvAdd(bvAdd(bvMul(kpv, e), yi), f0));
+    bvStore(&xf[i], bvAdd(bvMul(av, y), bvMul(bv, dg)));
+    bvStore(&xi[i], bvAdd(yi, bvMul(hv, ig)));
+  }
+}
+
+/* Outer attitude loop of one axis across the batch: '<S1>/Sum', '<S1>/Gain' */
+static void batch_outer(const real_T *sp, const real_T *pos, real_T *gain,
+  real_T kp, int_T numLanes)
+{
+  const batch_vec_T kpv = bvSet1(kp);
+  int_T i;
+  for (i = 0; i < numLanes; i += BATCH_VLEN) {
+    bvStore(&gain[i], bvMul(kpv, bvSub(bvLoad(&sp[i]), bvLoad(&pos[i]))));
+  }
+}
+
+/*
+ * One base-rate tick of every instance: the inner loops, then the outer
+ * loops when due, whose outputs the inner loops take at the next tick, as
+ * controller_step runs them.  Padding lanes hold zero inputs and states and
+ * stay at zero.
+ */
+void controller_batch_step(controller_Batch_T *batch)
+{
+  const P_controller_T *controller_P = &batch->P;
+  time_T h = batch->Timing.stepSize0;
+  if ((batch->solverMode == CONTROLLER_SOLVER_ZOH) || (batch->solverMode ==
+       CONTROLLER_SOLVER_TUSTIN)) {
+    batch_discrete_inner(batch->Gain, batch->U.pitch_rate, batch->Filter_CSTATE,
+                         batch->Integrator_CSTATE, batch->FilterCoefficient,
+                         batch->Y.alpha_pitch, controller_P->PIDController_P,
+                         controller_P->PIDController_I,
+                         controller_P->PIDController_D,
+                         controller_P->PIDController_N, batch->FilterA,
+                         batch->FilterB, batch->numLanes, h);
+    batch_discrete_inner(batch->Gain1, batch->U.roll_rate,
+                         batch->Filter_CSTATE_f, batch->Integrator_CSTATE_i,
+                         batch->FilterCoefficient_c, batch->Y.alpha_roll,
+                         controller_P->PIDController1_P,
+                         controller_P->PIDController1_I,
+                         controller_P->PIDController1_D,
+                         controller_P->PIDController1_N, batch->FilterA_f,
+                         batch->FilterB_f, batch->numLanes, h);
+  } else {
+    batch_ode4_inner(batch->Gain, batch->U.pitch_rate, batch->Filter_CSTATE,
+                     batch->Integrator_CSTATE, batch->FilterCoefficient,
+                     batch->Y.alpha_pitch, controller_P->PIDController_P,
+                     controller_P->PIDController_I, controller_P->PIDController_D,
+                     controller_P->PIDController_N, batch->numLanes, h);
+    batch_ode4_inner(batch->Gain1, batch->U.roll_rate, batch->Filter_CSTATE_f,
+                     batch->Integrator_CSTATE_i, batch->FilterCoefficient_c,
+                     batch->Y.alpha_roll, controller_P->PIDController1_P,
+                     controller_P->PIDController1_I,
+                     controller_P->PIDController1_D,
+                     controller_P->PIDController1_N, batch->numLanes, h);
+  }
+
+  /* Update absolute time for base rate */
+  ++batch->Timing.clockTick0;
+  batch->Timing.t = batch->Timing.clockTick0 * batch->Timing.stepSize0;
+  if (batch->Timing.TID1 == 0UL) {
+    batch_outer(batch->U.pitch_sp, batch->U.pitch, batch->Gain,
+                controller_P->Gain_Gain, batch->numLanes);
+    batch_outer(batch->U.roll_sp, batch->U.roll, batch->Gain1,
+                controller_P->Gain1_Gain, batch->numLanes);
+    batch->Timing.clockTick1++;
+  }
+
+  batch->Timing.TID1++;
+  if (batch->Timing.TID1 >= batch->Timing.outerRateRatio) {
+    batch->Timing.TID1 = 0UL;
+  }
+}
+
+void controller_batch_load(controller_Batch_T *batch, int_T idx, const
+  RT_MODEL_controller_T *controller_M)
+{
+  batch->U.pitch_sp[idx] = controller_M->U.pitch_sp;
+  batch->U.pitch[idx] = controller_M->U.pitch;
+  batch->U.pitch_rate[idx] = controller_M->U.pitch_rate;
+  batch->U.roll_sp[idx] = controller_M->U.roll_sp;
+  batch->U.roll[idx] = controller_M->U.roll;
+  batch->U.roll_rate[idx] = controller_M->U.roll_rate;
+  batch->Gain[idx] = controller_M->B.Gain;
+  batch->Gain1[idx] = controller_M->B.Gain1;
+  batch->FilterCoefficient[idx] = controller_M->B.FilterCoefficient;
+  batch->FilterCoefficient_c[idx] = controller_M->B.FilterCoefficient_c;
+  batch->Filter_CSTATE[idx] = controller_M->X.Filter_CSTATE;
+  batch->Integrator_CSTATE[idx] = controller_M->X.Integrator_CSTATE;
+  batch->Filter_CSTATE_f[idx] = controller_M->X.Filter_CSTATE_f;
+  batch->Integrator_CSTATE_i[idx] = controller_M->X.Integrator_CSTATE_i;
+  batch->Y.alpha_pitch[idx] = controller_M->Y.alpha_pitch;
+  batch->Y.alpha_roll[idx] = controller_M->Y.alpha_roll;
+}
+
+void controller_batch_store(const controller_Batch_T *batch, int_T idx,
+  RT_MODEL_controller_T *controller_M)
+{
+  controller_M->U.pitch_sp = batch->U.pitch_sp[idx];
+  controller_M->U.pitch = batch->U.pitch[idx];
+  controller_M->U.pitch_rate = batch->U.pitch_rate[idx];
+  controller_M->U.roll_sp = batch->U.roll_sp[idx];
+  controller_M->U.roll = batch->U.roll[idx];
+  controller_M->U.roll_rate = batch->U.roll_rate[idx];
+  controller_M->B.Gain = batch->Gain[idx];
+  controller_M->B.Gain1 = batch->Gain1[idx];
+  controller_M->B.FilterCoefficient = batch->FilterCoefficient[idx];
+  controller_M->B.FilterCoefficient_c = batch->FilterCoefficient_c[idx];
+  controller_M->X.Filter_CSTATE = batch->Filter_CSTATE[idx];
+  controller_M->X.Integrator_CSTATE = batch->Integrator_CSTATE[idx];
+  controller_M->X.Filter_CSTATE_f = batch->Filter_CSTATE_f[idx];
+  controller_M->X.Integrator_CSTATE_i = batch->Integrator_CSTATE_i[idx];
+  controller_M->Y.alpha_pitch = batch->Y.alpha_pitch[idx];
+  controller_M->Y.alpha_roll = batch->Y.alpha_roll[idx];
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
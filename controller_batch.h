@@ -0,0 +1,133 @@
+
+
+#ifndef controller_batch_h_
+#define controller_batch_h_
+#include "rtwtypes.h"
+#include "controller.h"
+
+/*
+ * Batched structure-of-arrays stepping engine.
+ *
+ * Holds the inports, block signals, continuous states and outports of N
+ * controller instances as contiguous, 64-byte aligned arrays and advances
+ * all of them by one base-rate tick at once.  The loops run across the
+ * batch, so they vectorize with AVX-512 (8 lanes), AVX/AVX2 (4 lanes) or
+ * fall back to scalar code, depending on the target the file is built for.
+ *
+ * Every instance has its own inports (U) and states; all instances run in
+ * lockstep and share one timing block, one parameter set and the solver
+ * mode of the model the batch is configured from.  The batch implements
+ * CONTROLLER_SOLVER_ODE4 and _ODE4_FUSED (the classical Runge-Kutta stages)
+ * and CONTROLLER_SOLVER_ZOH and _TUSTIN (the discrete update with the
+ * model's DiscCoeffs); the variable-step and implicit modes are not
+ * batched, and a model in one of them is rejected.
+ *
+ * A tick runs the rates in controller_step order: the inner loops compute
+ * the '<S30>'/'<S80>' Derivative Gain and '<S34>'/'<S84>' Integral Gain
+ * inputs of their lane from the held outer loop outputs, write the
+ * outports and advance the states; the outer loops then update the held
+ * '<S1>/Gain' and '<S1>/Gain1' when they are due.
+ *
+ * Accuracy: every lane performs the same floating point operations in the
+ * same order as controller_step() in the solver mode of the batch, so the
+ * batch is bit-identical to the scalar model when both are built without
+ * floating point contraction (-ffp-contract=off).  With FMA contraction enabled the states and outputs
+ * agree with the scalar model within CONTROLLER_BATCH_TOLERANCE relative to
+ * max(1, |x|).
+ */
+#define CONTROLLER_BATCH_TOLERANCE     (1.0E-12)
+
+/* Number of lanes the arrays are padded to (largest supported vector) */
+#define CONTROLLER_BATCH_ALIGN_LANES   (8)
+
+typedef struct {
+  int_T numInstances;                  /* Instances in use */
+  int_T numLanes;                      /* Padded array length */
+
+  /* External inputs, one element per instance */
+  struct {
+    real_T *pitch_sp;                  /* '<Root>/pitch_sp' */
+    real_T *pitch;                     /* '<Root>/pitch' */
+    real_T *pitch_rate;                /* '<Root>/pitch_rate' */
+    real_T *roll_sp;                   /* '<Root>/roll_sp' */
+    real_T *roll;                      /* '<Root>/roll' */
+    real_T *roll_rate;                 /* '<Root>/roll_rate' */
+  } U;
+
+  /* Block signals, one element per instance */
+  real_T *Gain;                        /* '<S1>/Gain', held between outer ticks */
+  real_T *Gain1;                       /* '<S1>/Gain1', held between outer ticks */
+  real_T *FilterCoefficient;           /* '<S40>/Filter Coefficient' */
+  real_T *FilterCoefficient_c;         /* '<S90>/Filter Coefficient' */
+
+  /* Continuous states, one element per instance */
+  real_T *Filter_CSTATE;               /* '<S32>/Filter' */
+  real_T *Integrator_CSTATE;           /* '<S37>/Integrator' */
+  real_T *Filter_CSTATE_f;             /* '<S82>/Filter' */
+  real_T *Integrator_CSTATE_i;         /* '<S87>/Integrator' */
+
+  /* External outputs, one element per instance */
+  struct {
+    real_T *alpha_pitch;               /* '<Root>/alpha_pitch' */
+    real_T *alpha_roll;                /* '<Root>/alpha_roll' */
+  } Y;
+
+  /* Parameter set of all instances */
+  P_controller_T P;
+
+  /* Solver mode, from the model, and the discrete filter coefficients of
+   * the parameter set */
+  controller_SolverMode_T solverMode;
+  real_T FilterA;                      /* '<S32>/Filter' */
+  real_T FilterB;
+  real_T FilterA_f;                    /* '<S82>/Filter' */
+  real_T FilterB_f;
+
+  /* Shared timing of the batch */
+  struct {
+    uint32_T clockTick0;
+    time_T stepSize0;
+    uint32_T clockTick1;
+    uint32_T TID1;                     /* Base ticks until the outer loop */
+    uint32_T outerRateRatio;           /* Base ticks per outer loop tick */
+    time_T t;
+  } Timing;
+
+  void *memory;                        /* Backing allocation */
+} controller_Batch_T;
+
+/* Allocates a batch for numInstances controllers configured like
+ * controller_M, NULL on failure or when the batch does not implement the
+ * model's solver mode */
+extern controller_Batch_T *controller_batch_create(int_T numInstances, const
+  RT_MODEL_controller_T *const controller_M);
+extern void controller_batch_destroy(controller_Batch_T *batch);
+
+/* Batch counterparts of the model entry points.  Initialization zeroes
+ * every instance and takes the base step size, the outer rate divider
+ * (controller_SetRates), the solver mode and the parameter set in use from
+ * controller_M; it returns false and leaves the batch unchanged when the
+ * batch does not implement the model's solver mode. */
+extern boolean_T controller_batch_supportsMode(controller_SolverMode_T mode);
+extern boolean_T controller_batch_initialize(controller_Batch_T *batch, const
+  RT_MODEL_controller_T *const controller_M);
+extern void controller_batch_step(controller_Batch_T *batch);
+
+/* Parameter set of every instance; takes effect at the next step */
+extern void controller_batch_setParams(controller_Batch_T *batch, const
+  P_controller_T *params);
+
+/* Copy one instance (inports, signals, states, outports) between the batch
+ * and a scalar model */
+extern void controller_batch_load(controller_Batch_T *batch, int_T idx,
+  const RT_MODEL_controller_T *controller_M);
+extern void controller_batch_store(const controller_Batch_T *batch, int_T idx,
+  RT_MODEL_controller_T *controller_M);
+
+#endif                                 /* controller_batch_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,783 @@
+/*
+ * Benchmark suite for the controller model.
+ *
+ * Measures controller_initialize, the latency of single controller_step
+ * calls, sustained stepping and continuous-state update throughput for
+ * each solver mode.  The model runs at a 1 kHz base rate and steps through
+ * a pseudo-random sensor sequence (BENCH_NUM_INPUTS samples of setpoint
+ * steps, attitudes and rates, repeated), bound to its inports, so the
+ * states and solver work are those of a loop in operation rather than of
+ * a model at rest.  On Linux, instructions, cycles, branch misses and L1
+ * data cache read misses are read with perf_event_open where the kernel
+ * allows it (see /proc/sys/kernel/perf_event_paranoid); unavailable
+ * counters are reported as null / empty.  The N-axis cascade engine
+ * (controller_axes.h) is stepped with 1 to CONTROLLER_AXES_MAX axes to
+ * show the cost of an added axis, and batches of closed loops, the
+ * controller batch (controller_batch.h) on the pendulum plant stepped with
+ * plant_step_batch(), give the cost of one plant+controller step.  Build
+ * with the Simulink Coder headers on the include path, e.g.
+ *
+ *   cc -O2 -I$MATLAB/rtw/c/src -I$MATLAB/simulink/include controller_bench.c \
+ *      controller.c controller_data.c controller_axes.c controller_batch.c \
+ *      pendulum_plant.c -lm -o controller_bench
+ *
+ * or use the Makefile (make controller_bench).
+ *
+ * Usage: controller_bench [-n numSteps] [-f text|json|csv] [-t tag]
+ *
+ * The json format writes one object per line and csv one row per result,
+ * each carrying the tag (e.g. the model version), so results of
+ * regenerated models can be collected and compared by scripts.
+ */
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "controller.h"                /* Model header file */
+#include "controller_axes.h"
+#include "controller_batch.h"
+#include "mc_rng.h"
+#include "pendulum_plant.h"
+
+#define BENCH_DEFAULT_STEPS            (10000000L)
+#define BENCH_NUM_REPEATS              (5)
+#define BENCH_NUM_SAMPLES              (100000L)
+#define BENCH_DEFAULT_TAG              "controller 1.1"
+#define BENCH_STEP_SIZE                (0.001)/* Base step of every benchmark */
+#define BENCH_NUM_INPUTS               (4096L)/* Input samples, a power of two */
+#define BENCH_SETPOINT_HOLD            (500L)/* Samples per setpoint level */
+
+/* Hardware counters, read as one group */
+typedef enum {
+  BENCH_CTR_INSTRUCTIONS = 0,
+  BENCH_CTR_CYCLES,
+  BENCH_CTR_BRANCH_MISSES,
+  BENCH_CTR_L1D_MISSES,
+  BENCH_NUM_COUNTERS
+} bench_CounterId_T;
+
+typedef struct {
+  int fd[BENCH_NUM_COUNTERS];
+  int leader;
+} bench_Counters_T;
+
+typedef struct {
+  boolean_T valid[BENCH_NUM_COUNTERS];
+  real_T value[BENCH_NUM_COUNTERS];
+} bench_CounterValues_T;
+
+typedef enum {
+  BENCH_FORMAT_TEXT = 0,
+  BENCH_FORMAT_JSON,
+  BENCH_FORMAT_CSV
+} bench_Format_T;
+
+/* One result line */
+typedef struct {
+  const char_T *bench;
+  const char_T *variant;
+  long iterations;
+  real_T nsPerOp;
+  real_T opsPerSec;
+  real_T p50Ns;                        /* < 0 when not sampled */
+  real_T p99Ns;
+  real_T maxNs;
+  bench_CounterValues_T perOp;
+} bench_Result_T;
+
+static const char_T *const bench_counterNames[BENCH_NUM_COUNTERS] = {
+  "instructions", "cycles", "branch_misses", "l1d_misses"
+};
+
+static RT_MODEL_controller_T controller_M_;
+
+/* Sensor sequence the benchmarks step through */
+static ExtU_controller_T bench_inputs[BENCH_NUM_INPUTS];
+
+static real_T bench_now_ns(void)
+{
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (real_T)ts.tv_sec * 1.0E9 + (real_T)ts.tv_nsec;
+}
+
+#if defined(__linux__)
+
+static int bench_perfOpen(uint32_t type, unsigned long long config, int leader)
+{
+  struct perf_event_attr attr;
+  (void) memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = (leader < 0) ? 1U : 0U;
+  attr.exclude_kernel = 1U;
+  attr.exclude_hv = 1U;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+  return (int)syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0UL);
+}
+
+#endif
+
+/* Opens whichever counters the kernel and CPU allow */
+static void bench_countersOpen(bench_Counters_T *c)
+{
+  int_T i;
+  for (i = 0; i < BENCH_NUM_COUNTERS; i++) {
+    c->fd[i] = -1;
+  }
+
+  c->leader = -1;
+
+#if defined(__linux__)
+
+  {
+    static const struct {
+      uint32_t type;
+      unsigned long long config;
+    } events[BENCH_NUM_COUNTERS] = {
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+      { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS <<
+        16) }
+    };
+
+    for (i = 0; i < BENCH_NUM_COUNTERS; i++) {
+      c->fd[i] = bench_perfOpen(events[i].type, events[i].config, c->leader);
+      if ((c->fd[i] >= 0) && (c->leader < 0)) {
+        c->leader = c->fd[i];
+      }
+    }
+  }
+
+#endif
+
+}
+
+static void bench_countersClose(bench_Counters_T *c)
+{
+  int_T i;
+  for (i = 0; i < BENCH_NUM_COUNTERS; i++) {
+    if (c->fd[i] >= 0) {
+      (void) close(c->fd[i]);
+    }
+  }
+}
+
+static void bench_countersStart(const bench_Counters_T *c)
+{
+
+#if defined(__linux__)
+
+  if (c->leader >= 0) {
+    (void) ioctl(c->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    (void) ioctl(c->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+#else
+
+  (void)(c);
+
+#endif
+
+}
+
+/* Stops the group and stores the counts divided by numOps */
+static void bench_countersStop(const bench_Counters_T *c, long numOps,
+  bench_CounterValues_T *out)
+{
+  int_T i;
+  (void) memset(out, 0, sizeof(bench_CounterValues_T));
+
+#if defined(__linux__)
+
+  if (c->leader >= 0) {
+    /* nr, then (value, id) per member */
+    unsigned long long buf[1 + 2 * BENCH_NUM_COUNTERS];
+    unsigned long long ids[BENCH_NUM_COUNTERS];
+    unsigned long long k;
+    (void) ioctl(c->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    for (i = 0; i < BENCH_NUM_COUNTERS; i++) {
+      ids[i] = ~0ULL;
+      if (c->fd[i] >= 0) {
+        (void) ioctl(c->fd[i], PERF_EVENT_IOC_ID, &ids[i]);
+      }
+    }
+
+    if (read(c->leader, buf, sizeof(buf)) > 0) {
+      for (k = 0ULL; (k < buf[0]) && (k < (unsigned long long)
+            BENCH_NUM_COUNTERS); k++) {
+        for (i = 0; i < BENCH_NUM_COUNTERS; i++) {
+          if (ids[i] == buf[2U + 2U * k]) {
+            out->valid[i] = true;
+            out->value[i] = (real_T)buf[1U + 2U * k] / (real_T)numOps;
+          }
+        }
+      }
+    }
+  }
+
+#else
+
+  (void)(c);
+  (void)(numOps);
+  (void)(i);
+
+#endif
+
+}
+
+static int_T bench_cmpReal(const void *a, const void *b)
+{
+  real_T x = *(const real_T *)a;
+  real_T y = *(const real_T *)b;
+  return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+static void bench_print(bench_Format_T fmt, const char_T *tag, const
+  bench_Result_T *r)
+{
+  int_T i;
+  switch (fmt) {
+   case BENCH_FORMAT_JSON:
+    (void) printf("{\"tag\":\"%s\",\"bench\":\"%s\",\"variant\":\"%s\","
+                  "\"iterations\":%ld,\"ns_per_op\":%.3f,\"ops_per_sec\":%.1f",
+                  tag, r->bench, r->variant, r->iterations, r->nsPerOp,
+                  r->opsPerSec);
+    if (r->p50Ns >= 0.0) {
+      (void) printf(",\"p50_ns\":%.1f,\"p99_ns\":%.1f,\"max_ns\":%.1f",
+                    r->p50Ns, r->p99Ns, r->maxNs);
+    }
+
+    for (i = 0; i < BENCH_NUM_COUNTERS; i++) {
+      if (r->perOp.valid[i]) {
+        (void) printf(",\"%s_per_op\":%.3f", bench_counterNames[i],
+                      r->perOp.value[i]);
+      } else {
+        (void) printf(",\"%s_per_op\":null", bench_counterNames[i]);
+      }
+    }
+
+    (void) printf("}\n");
+    break;
+
+   case BENCH_FORMAT_CSV:
+    (void) printf("%s,%s,%s,%ld,%.3f,%.1f,", tag, r->bench, r->variant,
+                  r->iterations, r->nsPerOp, r->opsPerSec);
+    if (r->p50Ns >= 0.0) {
+      (void) printf("%.1f,%.1f,%.1f", r->p50Ns, r->p99Ns, r->maxNs);
+    } else {
+      (void) printf(",,");
+    }
+
+    for (i = 0; i < BENCH_NUM_COUNTERS; i++) {
+      if (r->perOp.valid[i]) {
+        (void) printf(",%.3f", r->perOp.value[i]);
+      } else {
+        (void) printf(",");
+      }
+    }
+
+    (void) printf("\n");
+    break;
+
+   default:
+    (void) printf("%-16s %-18s %10.2f ns/op", r->bench, r->variant, r->nsPerOp);
+    if (r->p50Ns >= 0.0) {
+      (void) printf("  p50 %7.1f  p99 %7.1f  max %9.1f", r->p50Ns, r->p99Ns,
+                    r->maxNs);
+    }
+
+    if (r->perOp.valid[BENCH_CTR_INSTRUCTIONS]) {
+      (void) printf("  %8.1f instr", r->perOp.value[BENCH_CTR_INSTRUCTIONS]);
+    }
+
+    if (r->perOp.valid[BENCH_CTR_CYCLES]) {
+      (void) printf("  %8.1f cyc", r->perOp.value[BENCH_CTR_CYCLES]);
+    }
+
+    if (r->perOp.valid[BENCH_CTR_BRANCH_MISSES]) {
+      (void) printf("  %6.3f br-miss", r->perOp.value[BENCH_CTR_BRANCH_MISSES]);
+    }
+
+    if (r->perOp.valid[BENCH_CTR_L1D_MISSES]) {
+      (void) printf("  %6.3f L1d-miss", r->perOp.value[BENCH_CTR_L1D_MISSES]);
+    }
+
+    (void) printf("\n");
+    break;
+  }
+}
+
+/* Fills the time fields from the best of the repeats */
+static void bench_setTime(bench_Result_T *r, long numOps, real_T bestNs)
+{
+  r->iterations = numOps;
+  r->nsPerOp = bestNs / (real_T)numOps;
+  r->opsPerSec = 1.0E9 / r->nsPerOp;
+  r->p50Ns = -1.0;
+  r->p99Ns = -1.0;
+  r->maxNs = -1.0;
+}
+
+/*
+ * Fills bench_inputs: setpoints held for BENCH_SETPOINT_HOLD samples, rates
+ * that wander as a damped random walk and the attitudes they integrate to.
+ */
+static void bench_makeInputs(void)
+{
+  mcRng_T rng;
+  real_T pitch = 0.0;
+  real_T roll = 0.0;
+  real_T pitchRate = 0.0;
+  real_T rollRate = 0.0;
+  real_T pitchSp = 0.0;
+  real_T rollSp = 0.0;
+  long k;
+  mcRng_init(&rng, 12ULL, 0ULL);
+  for (k = 0L; k < BENCH_NUM_INPUTS; k++) {
+    if (k % BENCH_SETPOINT_HOLD == 0L) {
+      pitchSp = mcRng_range(&rng, -0.2, 0.2);
+      rollSp = mcRng_range(&rng, -0.2, 0.2);
+    }
+
+    pitchRate = 0.99 * pitchRate + mcRng_range(&rng, -0.05, 0.05);
+    rollRate = 0.99 * rollRate + mcRng_range(&rng, -0.05, 0.05);
+    pitch += BENCH_STEP_SIZE * pitchRate;
+    roll += BENCH_STEP_SIZE * rollRate;
+    bench_inputs[k].pitch_sp = pitchSp;
+    bench_inputs[k].pitch = pitch;
+    bench_inputs[k].pitch_rate = pitchRate;
+    bench_inputs[k].roll_sp = rollSp;
+    bench_inputs[k].roll = roll;
+    bench_inputs[k].roll_rate = rollRate;
+  }
+}
+
+/* Initializes the model at the benchmark rate in the given solver mode */
+static void bench_setupModel(RT_MODEL_controller_T *const controller_M,
+  controller_SolverMode_T mode)
+{
+  controller_initialize(controller_M);
+  controller_SetRates(controller_M, BENCH_STEP_SIZE, 1UL);
+  controller_SetSolverMode(controller_M, mode);
+}
+
+/* Binds the inports to input sample k of the sequence */
+#define bench_bindInputs(controller_M, k) \
+  ((controller_M)->inputs = &bench_inputs[(k) & (BENCH_NUM_INPUTS - 1L)])
+
+/* controller_initialize */
+static void bench_initialize(RT_MODEL_controller_T *const controller_M, const
+  bench_Counters_T *ctr, long numOps, bench_Result_T *r)
+{
+  real_T best = -1.0;
+  int_T rep;
+  for (rep = 0; rep < BENCH_NUM_REPEATS; rep++) {
+    real_T t0;
+    real_T t1;
+    long k;
+    bench_countersStart(ctr);
+    t0 = bench_now_ns();
+    for (k = 0; k < numOps; k++) {
+      controller_initialize(controller_M);
+    }
+
+    t1 = bench_now_ns();
+    if ((best < 0.0) || (t1 - t0 < best)) {
+      best = t1 - t0;
+      bench_countersStop(ctr, numOps, &r->perOp);
+    }
+  }
+
+  r->bench = "initialize";
+  r->variant = "default";
+  bench_setTime(r, numOps, best);
+}
+
+/*
+ * Latency of individual controller_step calls: each call is timed on its
+ * own and the timer overhead, measured the same way around nothing, is
+ * subtracted.
+ */
+static void bench_stepLatency(RT_MODEL_controller_T *const controller_M,
+  controller_SolverMode_T mode, const char_T *name, bench_Result_T *r)
+{
+  real_T *samples = (real_T *)malloc((size_t)BENCH_NUM_SAMPLES * sizeof(real_T));
+  real_T overhead = -1.0;
+  real_T sum = 0.0;
+  long k;
+  (void) memset(r, 0, sizeof(bench_Result_T));
+  r->bench = "step_latency";
+  r->variant = name;
+  if (samples == NULL) {
+    return;
+  }
+
+  for (k = 0; k < 1000L; k++) {
+    real_T t0 = bench_now_ns();
+    real_T t1 = bench_now_ns();
+    if ((overhead < 0.0) || (t1 - t0 < overhead)) {
+      overhead = t1 - t0;
+    }
+  }
+
+  bench_setupModel(controller_M, mode);
+  for (k = 0; k < BENCH_NUM_SAMPLES; k++) {
+    real_T t0;
+    real_T t1;
+    bench_bindInputs(controller_M, k);
+    t0 = bench_now_ns();
+    controller_step(controller_M);
+    t1 = bench_now_ns();
+    samples[k] = (t1 - t0 - overhead > 0.0) ? (t1 - t0 - overhead) : 0.0;
+    sum += samples[k];
+  }
+
+  qsort(samples, (size_t)BENCH_NUM_SAMPLES, sizeof(real_T), &bench_cmpReal);
+  bench_setTime(r, BENCH_NUM_SAMPLES, sum);
+  r->p50Ns = samples[BENCH_NUM_SAMPLES / 2L];
+  r->p99Ns = samples[(BENCH_NUM_SAMPLES * 99L) / 100L];
+  r->maxNs = samples[BENCH_NUM_SAMPLES - 1L];
+  free(samples);
+}
+
+/*
+ * Sustained stepping: numSteps back-to-back controller_step calls.  With
+ * baseRateOnly, controller_step0 alone is called, i.e. the continuous-state
+ * update path without the outer-rate task.
+ */
+static void bench_sustained(RT_MODEL_controller_T *const controller_M,
+  controller_SolverMode_T mode, const char_T *name, boolean_T baseRateOnly,
+  const bench_Counters_T *ctr, long numSteps, bench_Result_T *r)
+{
+  real_T best = -1.0;
+  int_T rep;
+  for (rep = 0; rep < BENCH_NUM_REPEATS; rep++) {
+    real_T t0;
+    real_T t1;
+    long k;
+    bench_setupModel(controller_M, mode);
+    bench_countersStart(ctr);
+    t0 = bench_now_ns();
+    if (baseRateOnly) {
+      for (k = 0; k < numSteps; k++) {
+        bench_bindInputs(controller_M, k);
+        controller_step0(controller_M);
+      }
+    } else {
+      for (k = 0; k < numSteps; k++) {
+        bench_bindInputs(controller_M, k);
+        controller_step(controller_M);
+      }
+    }
+
+    t1 = bench_now_ns();
+    if ((best < 0.0) || (t1 - t0 < best)) {
+      best = t1 - t0;
+      bench_countersStop(ctr, numSteps, &r->perOp);
+    }
+  }
+
+  r->bench = baseRateOnly ? "ode_update" : "step_sustained";
+  r->variant = name;
+  bench_setTime(r, numSteps, best);
+  if (baseRateOnly) {
+    /* Report continuous-state updates per second */
+    r->opsPerSec *= (real_T)controller_M->Sizes.numContStates;
+  }
+}
+
+/* numSteps controller_axes_step calls over numAxes copies of the model's
+ * pitch cascade */
+static void bench_axes(RT_MODEL_controller_T *const controller_M, int_T
+  numAxes, const char_T *name, const bench_Counters_T *ctr, long numSteps,
+  bench_Result_T *r)
+{
+  static controller_Axes_T axes;
+  CascadeGains_T g;
+  real_T best = -1.0;
+  int_T rep;
+  int_T i;
+  controller_initialize(controller_M);
+  controller_SetRates(controller_M, BENCH_STEP_SIZE, 1UL);
+  controller_axes_initTvc(&axes, controller_M);
+  g.Kp_att = axes.Kp_att[CONTROLLER_AXIS_PITCH];
+  g.Kp_rate = axes.Kp_rate[CONTROLLER_AXIS_PITCH];
+  g.Ki_rate = axes.Ki_rate[CONTROLLER_AXIS_PITCH];
+  g.Kd_rate = axes.Kd_rate[CONTROLLER_AXIS_PITCH];
+  g.N = axes.N[CONTROLLER_AXIS_PITCH];
+  for (rep = 0; rep < BENCH_NUM_REPEATS; rep++) {
+    real_T t0;
+    real_T t1;
+    long k;
+    controller_axes_init(&axes, controller_M->Timing.stepSize0,
+                         controller_M->Timing.TaskCounters.cLimit[1]);
+    for (i = 0; i < numAxes; i++) {
+      (void) controller_axes_add(&axes, name, &g);
+    }
+
+    bench_countersStart(ctr);
+    t0 = bench_now_ns();
+    for (k = 0; k < numSteps; k++) {
+      const ExtU_controller_T *u = &bench_inputs[k & (BENCH_NUM_INPUTS - 1L)];
+      for (i = 0; i < numAxes; i++) {
+        axes.sp[i] = (i & 1) ? u->roll_sp : u->pitch_sp;
+        axes.pos[i] = (i & 1) ? u->roll : u->pitch;
+        axes.rate[i] = (i & 1) ? u->roll_rate : u->pitch_rate;
+      }
+
+      controller_axes_step(&axes);
+    }
+
+    t1 = bench_now_ns();
+    if ((best < 0.0) || (t1 - t0 < best)) {
+      best = t1 - t0;
+      bench_countersStop(ctr, numSteps, &r->perOp);
+    }
+  }
+
+  r->bench = "axes_step";
+  r->variant = name;
+  bench_setTime(r, numSteps, best);
+}
+
+/*
+ * numSteps plant+controller steps spread over numRuns closed loops: the
+ * controller batch and plant_step_batch() in lockstep at 1 kHz, the plant
+ * attitude fed to the batch inports and its outports to the gimbals.
+ */
+static void bench_closedLoopBatch(RT_MODEL_controller_T *const controller_M,
+  int_T numRuns, const char_T *name, const bench_Counters_T *ctr, long
+  numSteps, bench_Result_T *r)
+{
+  controller_Batch_T *batch;
+  real_T *storage;
+  real_T *xs[PLANT_NUM_STATES];
+  real_T *us[PLANT_NUM_INPUTS];
+  P_plant_T p;
+  real_T best = -1.0;
+  long numTicks = (numSteps / (long)numRuns > 0L) ? (numSteps / (long)numRuns) :
+    1L;
+  int_T rep;
+  int_T i;
+  int_T j;
+  (void) memset(r, 0, sizeof(bench_Result_T));
+  r->bench = "closed_loop_batch";
+  r->variant = name;
+  controller_initialize(controller_M);
+  controller_SetRates(controller_M, BENCH_STEP_SIZE, 1UL);
+  batch = controller_batch_create(numRuns, controller_M);
+  storage = (real_T *)malloc((size_t)(PLANT_NUM_STATES + PLANT_NUM_INPUTS) *
+    (size_t)numRuns * sizeof(real_T));
+  if ((batch == NULL) || (storage == NULL)) {
+    controller_batch_destroy(batch);
+    free(storage);
+    return;
+  }
+
+  for (j = 0; j < PLANT_NUM_STATES; j++) {
+    xs[j] = storage + (size_t)j * (size_t)numRuns;
+  }
+
+  for (j = 0; j < PLANT_NUM_INPUTS; j++) {
+    us[j] = storage + (size_t)(PLANT_NUM_STATES + j) * (size_t)numRuns;
+  }
+
+  plant_defaultParams(&p);
+  for (rep = 0; rep < BENCH_NUM_REPEATS; rep++) {
+    real_T t0;
+    real_T t1;
+    long k;
+    (void) controller_batch_initialize(batch, controller_M);
+    (void) memset(storage, 0, (size_t)(PLANT_NUM_STATES + PLANT_NUM_INPUTS) *
+                  (size_t)numRuns * sizeof(real_T));
+    for (i = 0; i < numRuns; i++) {
+      xs[0][i] = 0.1 * (real_T)(i + 1) / (real_T)numRuns;
+      xs[2][i] = -0.05;
+      us[2][i] = plant_hoverThrust(&p);
+    }
+
+    bench_countersStart(ctr);
+    t0 = bench_now_ns();
+    for (k = 0; k < numTicks; k++) {
+      for (i = 0; i < numRuns; i++) {
+        batch->U.pitch[i] = xs[0][i];
+        batch->U.pitch_rate[i] = xs[1][i];
+        batch->U.roll[i] = xs[2][i];
+        batch->U.roll_rate[i] = xs[3][i];
+      }
+
+      controller_batch_step(batch);
+      for (i = 0; i < numRuns; i++) {
+        us[0][i] = PLANT_GIMBAL_SIGN * batch->Y.alpha_pitch[i];
+        us[1][i] = PLANT_GIMBAL_SIGN * batch->Y.alpha_roll[i];
+      }
+
+      plant_step_batch(&p, xs, (const real_T *const *)us, numRuns,
+                       BENCH_STEP_SIZE);
+    }
+
+    t1 = bench_now_ns();
+    if ((best < 0.0) || (t1 - t0 < best)) {
+      best = t1 - t0;
+      bench_countersStop(ctr, numTicks * (long)numRuns, &r->perOp);
+    }
+  }
+
+  bench_setTime(r, numTicks * (long)numRuns, best);
+  controller_batch_destroy(batch);
+  free(storage);
+}
+
+int_T main(int_T argc, const char *argv[])
+{
+  static const struct {
+    controller_SolverMode_T mode;
+    const char_T *name;
+  } modes[] = {
+    { CONTROLLER_SOLVER_ODE4, "ode4" },
+    { CONTROLLER_SOLVER_ODE4_FUSED, "ode4-fused" },
+    { CONTROLLER_SOLVER_ZOH, "discrete-zoh" },
+    { CONTROLLER_SOLVER_TUSTIN, "discrete-tustin" },
+    { CONTROLLER_SOLVER_ROS2, "ros2" },
+    { CONTROLLER_SOLVER_ODE45, "ode45" }
+  };
+
+  static const struct {
+    int_T numAxes;
+    const char_T *name;
+  } axisCounts[] = {
+    { 1, "1-axis" },
+    { 2, "2-axis" },
+    { 4, "4-axis" },
+    { 8, "8-axis" }
+  };
+
+  static const struct {
+    int_T numRuns;
+    const char_T *name;
+  } runCounts[] = {
+    { 64, "64-runs" },
+    { 1024, "1024-runs" }
+  };
+
+  RT_MODEL_controller_T *const controller_M = &controller_M_;
+  bench_Counters_T ctr;
+  bench_Result_T r;
+  bench_Format_T fmt = BENCH_FORMAT_TEXT;
+  const char_T *tag = BENCH_DEFAULT_TAG;
+  long numSteps = BENCH_DEFAULT_STEPS;
+  size_t i;
+  int opt;
+  while ((opt = getopt(argc, (char *const *)argv, "n:f:t:")) != -1) {
+    switch (opt) {
+     case 'n':
+      numSteps = strtol(optarg, NULL, 10);
+      break;
+
+     case 'f':
+      if (strcmp(optarg, "json") == 0) {
+        fmt = BENCH_FORMAT_JSON;
+      } else if (strcmp(optarg, "csv") == 0) {
+        fmt = BENCH_FORMAT_CSV;
+      } else if (strcmp(optarg, "text") == 0) {
+        fmt = BENCH_FORMAT_TEXT;
+      } else {
+        numSteps = 0L;
+      }
+      break;
+
+     case 't':
+      tag = optarg;
+      break;
+
+     default:
+      numSteps = 0L;
+      break;
+    }
+  }
+
+  if (numSteps <= 0L) {
+    (void) fprintf(stderr,
+                   "usage: %s [-n numSteps] [-f text|json|csv] [-t tag]\n",
+                   argv[0]);
+    return 1;
+  }
+
+  bench_countersOpen(&ctr);
+  if (ctr.leader < 0) {
+    (void) fprintf(stderr, "controller_bench: hardware counters unavailable\n");
+  }
+
+  if (fmt == BENCH_FORMAT_CSV) {
+    (void) printf("tag,bench,variant,iterations,ns_per_op,ops_per_sec,p50_ns,"
+                  "p99_ns,max_ns");
+    for (i = 0U; i < (size_t)BENCH_NUM_COUNTERS; i++) {
+      (void) printf(",%s_per_op", bench_counterNames[i]);
+    }
+
+    (void) printf("\n");
+  }
+
+  bench_makeInputs();
+  (void) memset(&r, 0, sizeof(r));
+  bench_initialize(controller_M, &ctr, numSteps / 100L + 1L, &r);
+  bench_print(fmt, tag, &r);
+  for (i = 0U; i < sizeof(modes) / sizeof(modes[0]); i++) {
+    bench_stepLatency(controller_M, modes[i].mode, modes[i].name, &r);
+    bench_print(fmt, tag, &r);
+  }
+
+  for (i = 0U; i < sizeof(modes) / sizeof(modes[0]); i++) {
+    (void) memset(&r, 0, sizeof(r));
+    bench_sustained(controller_M, modes[i].mode, modes[i].name, false, &ctr,
+                    numSteps, &r);
+    bench_print(fmt, tag, &r);
+  }
+
+  for (i = 0U; i < sizeof(modes) / sizeof(modes[0]); i++) {
+    (void) memset(&r, 0, sizeof(r));
+    bench_sustained(controller_M, modes[i].mode, modes[i].name, true, &ctr,
+                    numSteps, &r);
+    bench_print(fmt, tag, &r);
+  }
+
+  for (i = 0U; i < sizeof(axisCounts) / sizeof(axisCounts[0]); i++) {
+    if (axisCounts[i].numAxes <= CONTROLLER_AXES_MAX) {
+      (void) memset(&r, 0, sizeof(r));
+      bench_axes(controller_M, axisCounts[i].numAxes, axisCounts[i].name,
+                 &ctr, numSteps, &r);
+      bench_print(fmt, tag, &r);
+    }
+  }
+
+  for (i = 0U; i < sizeof(runCounts) / sizeof(runCounts[0]); i++) {
+    bench_closedLoopBatch(controller_M, runCounts[i].numRuns, runCounts[i].name,
+                          &ctr, numSteps, &r);
+    bench_print(fmt, tag, &r);
+  }
+
+  bench_countersClose(&ctr);
+  controller_terminate(controller_M);
+  return 0;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,470 @@
+/*
+ * Self-checks of the controller against properties its interfaces promise.
+ *
+ * Usage: controller_check
+ *
+ * Each check drives model instances through their public entry points and
+ * reports PASS or FAIL with the first violation; the exit status is the
+ * number of failed checks, so the program can gate a regenerated model.
+ * Build with the Simulink Coder headers on the include path, e.g.
+ *
+ *   cc -O2 -I$MATLAB/rtw/c/src -I$MATLAB/simulink/include controller_check.c \
+ *      controller_axes.c controller_batch.c controller.c controller_data.c \
+ *      -lm -o controller_check
+ */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "controller.h"
+#include "controller_axes.h"
+#include "controller_batch.h"
+#include "mc_rng.h"
+
+#define CHECK_PARAM_TICKS              (600L)
+#define CHECK_PARAM_PERIOD             (37L)/* Ticks between published sets */
+#define CHECK_BATCH_INSTANCES          (13)/* Not a multiple of the lanes */
+#define CHECK_BATCH_TICKS              (2000L)
+#define CHECK_BATCH_HOLD               (50L)/* Ticks per input level */
+#define CHECK_AXES_TICKS               (3000L)
+#define CHECK_ZC_STEP_SIZE             (0.01)
+#define CHECK_ZC_TICKS                 (50L)
+#define CHECK_ZC_THRESHOLD             (0.205)/* Inside the 21st major step */
+#define CHECK_ZC_TOL                   (1.0E-9)
+#define CHECK_ZC_MAX_EVENTS            (4)
+
+typedef int_T (*check_Fcn_T)(char_T *msg, size_t msgSize);
+
+/*
+ * controller_SetParams: a published set is taken at the start of the next
+ * tick, and every rate running in that tick uses it.  In ZOH mode the
+ * major-step signals stay in the block I/O, so each tick can be checked
+ * against the set in use: the outer loop output '<S1>/Gain' when the outer
+ * loop ran, the outport with the inner gains, and the filter update with
+ * the ZOH coefficients of the set's filter coefficient.
+ */
+static int_T check_paramSwitch(char_T *msg, size_t msgSize)
+{
+  static RT_MODEL_controller_T model;
+  RT_MODEL_controller_T *const controller_M = &model;
+  static const uint32_T ratios[] = { 1UL, 3UL };
+  size_t r;
+  for (r = 0U; r < sizeof(ratios) / sizeof(ratios[0]); r++) {
+    mcRng_T rng;
+    long pending = -1L;
+    long k;
+    controller_initialize(controller_M);
+    controller_SetRates(controller_M, 0.001, ratios[r]);
+    controller_SetSolverMode(controller_M, CONTROLLER_SOLVER_ZOH);
+    mcRng_init(&rng, 15ULL, (unsigned long long)r);
+    for (k = 0L; k < CHECK_PARAM_TICKS; k++) {
+      const P_controller_T *p;
+      boolean_T outerDue = (boolean_T)rtmStepTask(controller_M, 1);
+      real_T xi = controller_M->X.Integrator_CSTATE;
+      real_T xf = controller_M->X.Filter_CSTATE;
+      real_T nh;
+      real_T alpha;
+      controller_M->U.pitch_sp = mcRng_range(&rng, -0.2, 0.2);
+      controller_M->U.pitch = mcRng_range(&rng, -0.2, 0.2);
+      controller_M->U.pitch_rate = mcRng_range(&rng, -1.0, 1.0);
+      if (k % CHECK_PARAM_PERIOD == 5L) {
+        P_controller_T next = *controller_GetParams(controller_M);
+        next.Gain_Gain = mcRng_range(&rng, 1.0, 8.0);
+        next.PIDController_P = mcRng_range(&rng, 0.1, 1.0);
+        next.PIDController_I = mcRng_range(&rng, 0.1, 1.0);
+        next.PIDController_D = mcRng_range(&rng, 0.001, 0.01);
+        next.PIDController_N = mcRng_range(&rng, 100.0, 1000.0);
+        if (!controller_SetParams(controller_M, &next)) {
+          (void) snprintf(msg, msgSize, "ratio %lu tick %ld: set not taken",
+                          (unsigned long)ratios[r], k);
+          return 1;
+        }
+
+        pending = k;
+      }
+
+      controller_step(controller_M);
+      p = controller_GetParams(controller_M);
+      if ((pending == k) && (controller_M->ParamBank.inUse !=
+                             controller_M->ParamBank.active)) {
+        (void) snprintf(msg, msgSize, "ratio %lu tick %ld: set published "
+                        "before the tick not in use", (unsigned long)ratios[r],
+                        k);
+        return 1;
+      }
+
+      alpha = (p->PIDController_P * controller_M->B.Sum1 + xi) +
+        controller_M->B.FilterCoefficient;
+      nh = p->PIDController_N * controller_M->Timing.stepSize0;
+      if ((controller_M->Y.alpha_pitch != alpha) ||
+          (controller_M->B.DerivativeGain != p->PIDController_D *
+           controller_M->B.Sum1) || (controller_M->B.FilterCoefficient !=
+           (controller_M->B.DerivativeGain - xf) * p->PIDController_N) ||
+          (controller_M->X.Filter_CSTATE != exp(-nh) * xf + -expm1(-nh) *
+           controller_M->B.DerivativeGain) || (outerDue &&
+           (controller_M->B.Gain != p->Gain_Gain * controller_M->B.Sum))) {
+        (void) snprintf(msg, msgSize, "ratio %lu tick %ld: the rates of the "
+                        "tick used different sets", (unsigned long)ratios[r],
+                        k);
+        return 1;
+      }
+    }
+  }
+
+  (void) snprintf(msg, msgSize, "%ld ticks at outer ratios 1 and 3",
+                  CHECK_PARAM_TICKS);
+  return 0;
+}
+
+static real_T check_relErr(real_T a, real_T b)
+{
+  return fabs(a - b) / fmax(1.0, fabs(b));
+}
+
+/*
+ * controller_batch: instances stepped as lanes of a batch follow the same
+ * instances stepped through controller_step in the given solver mode, with
+ * random inputs, a non-default parameter set and an outer rate divider,
+ * within CONTROLLER_BATCH_TOLERANCE.  Returns the largest error, or -1 if
+ * the batch cannot be created.
+ */
+static real_T check_batchMode(controller_SolverMode_T mode)
+{
+  static RT_MODEL_controller_T models[CHECK_BATCH_INSTANCES];
+  controller_Batch_T *batch;
+  P_controller_T params = controller_DefaultP;
+  mcRng_T rng;
+  real_T maxErr = 0.0;
+  long k;
+  int_T i;
+  params.Gain_Gain = 3.0;
+  params.PIDController_P = 0.6;
+  params.PIDController1_I = 0.8;
+  params.PIDController1_D = 0.008;
+  params.PIDController1_N = 400.0;
+  for (i = 0; i < CHECK_BATCH_INSTANCES; i++) {
+    controller_initialize(&models[i]);
+    controller_SetRates(&models[i], 0.001, 3UL);
+    controller_SetSolverMode(&models[i], mode);
+    (void) controller_SetParams(&models[i], &params);
+  }
+
+  batch = controller_batch_create(CHECK_BATCH_INSTANCES, &models[0]);
+  if (batch == (NULL)) {
+    return -1.0;
+  }
+
+  /* The models take the published set at their first step */
+  controller_batch_setParams(batch, &params);
+
+  mcRng_init(&rng, 2ULL, 0ULL);
+  for (k = 0L; k < CHECK_BATCH_TICKS; k++) {
+    for (i = 0; i < CHECK_BATCH_INSTANCES; i++) {
+      RT_MODEL_controller_T *const controller_M = &models[i];
+      if (k % CHECK_BATCH_HOLD == 0L) {
+        controller_M->U.pitch_sp = mcRng_range(&rng, -0.2, 0.2);
+        controller_M->U.pitch = mcRng_range(&rng, -0.2, 0.2);
+        controller_M->U.pitch_rate = mcRng_range(&rng, -1.0, 1.0);
+        controller_M->U.roll_sp = mcRng_range(&rng, -0.2, 0.2);
+        controller_M->U.roll = mcRng_range(&rng, -0.2, 0.2);
+        controller_M->U.roll_rate = mcRng_range(&rng, -1.0, 1.0);
+        batch->U.pitch_sp[i] = controller_M->U.pitch_sp;
+        batch->U.pitch[i] = controller_M->U.pitch;
+        batch->U.pitch_rate[i] = controller_M->U.pitch_rate;
+        batch->U.roll_sp[i] = controller_M->U.roll_sp;
+        batch->U.roll[i] = controller_M->U.roll;
+        batch->U.roll_rate[i] = controller_M->U.roll_rate;
+      }
+
+      controller_step(controller_M);
+    }
+
+    controller_batch_step(batch);
+    for (i = 0; i < CHECK_BATCH_INSTANCES; i++) {
+      const RT_MODEL_controller_T *const controller_M = &models[i];
+      const real_T err[] = {
+        check_relErr(batch->Y.alpha_pitch[i], controller_M->Y.alpha_pitch),
+        check_relErr(batch->Y.alpha_roll[i], controller_M->Y.alpha_roll),
+        check_relErr(batch->Filter_CSTATE[i], controller_M->X.Filter_CSTATE),
+        check_relErr(batch->Integrator_CSTATE[i],
+                     controller_M->X.Integrator_CSTATE),
+        check_relErr(batch->Filter_CSTATE_f[i], controller_M->X.Filter_CSTATE_f),
+        check_relErr(batch->Integrator_CSTATE_i[i],
+                     controller_M->X.Integrator_CSTATE_i)
+      };
+
+      size_t j;
+      for (j = 0U; j < sizeof(err) / sizeof(err[0]); j++) {
+        if (err[j] > maxErr) {
+          maxErr = err[j];
+        }
+      }
+    }
+  }
+
+  controller_batch_destroy(batch);
+  return maxErr;
+}
+
+/* True when the two values have the same bits */
+static boolean_T check_same(real_T a, real_T b)
+{
+  return (boolean_T)(memcmp(&a, &b, sizeof(real_T)) == 0);
+}
+
+/*
+ * controller_axes: with the model's gains and no feed-forward or bias, the
+ * pitch and roll axes of controller_axes_initTvc() follow a model in ZOH
+ * mode bit for bit, at an outer rate divider of 3 and with random inputs.
+ */
+static int_T check_axesVsStep(char_T *msg, size_t msgSize)
+{
+  static RT_MODEL_controller_T model;
+  static controller_Axes_T axes;
+  RT_MODEL_controller_T *const controller_M = &model;
+  mcRng_T rng;
+  long k;
+  controller_initialize(controller_M);
+  controller_SetRates(controller_M, 0.001, 3UL);
+  controller_SetSolverMode(controller_M, CONTROLLER_SOLVER_ZOH);
+  controller_axes_initTvc(&axes, controller_M);
+  mcRng_init(&rng, 17ULL, 0ULL);
+  for (k = 0L; k < CHECK_AXES_TICKS; k++) {
+    ExtU_controller_T *u = &controller_M->U;
+    if (k % CHECK_BATCH_HOLD == 0L) {
+      u->pitch_sp = mcRng_range(&rng, -0.2, 0.2);
+      u->pitch = mcRng_range(&rng, -0.2, 0.2);
+      u->roll_sp = mcRng_range(&rng, -0.2, 0.2);
+      u->roll = mcRng_range(&rng, -0.2, 0.2);
+    }
+
+    u->pitch_rate = mcRng_range(&rng, -1.0, 1.0);
+    u->roll_rate = mcRng_range(&rng, -1.0, 1.0);
+    axes.sp[CONTROLLER_AXIS_PITCH] = u->pitch_sp;
+    axes.pos[CONTROLLER_AXIS_PITCH] = u->pitch;
+    axes.rate[CONTROLLER_AXIS_PITCH] = u->pitch_rate;
+    axes.sp[CONTROLLER_AXIS_ROLL] = u->roll_sp;
+    axes.pos[CONTROLLER_AXIS_ROLL] = u->roll;
+    axes.rate[CONTROLLER_AXIS_ROLL] = u->roll_rate;
+    controller_step(controller_M);
+    controller_axes_step(&axes);
+    if ((!check_same(axes.alpha[CONTROLLER_AXIS_PITCH],
+                     controller_M->Y.alpha_pitch)) || (!check_same
+         (axes.alpha[CONTROLLER_AXIS_ROLL], controller_M->Y.alpha_roll)) ||
+        (!check_same(axes.Filter_CSTATE[CONTROLLER_AXIS_PITCH],
+                     controller_M->X.Filter_CSTATE)) || (!check_same
+         (axes.Integrator_CSTATE[CONTROLLER_AXIS_PITCH],
+          controller_M->X.Integrator_CSTATE)) || (!check_same
+         (axes.Filter_CSTATE[CONTROLLER_AXIS_ROLL],
+          controller_M->X.Filter_CSTATE_f)) || (!check_same
+         (axes.Integrator_CSTATE[CONTROLLER_AXIS_ROLL],
+          controller_M->X.Integrator_CSTATE_i)) || (!check_same
+         (axes.RateCmd[CONTROLLER_AXIS_PITCH], controller_M->B.Gain)) ||
+        (!check_same(axes.RateCmd[CONTROLLER_AXIS_ROLL], controller_M->B.Gain1)))
+    {
+      (void) snprintf(msg, msgSize, "tick %ld: alpha %.17g/%.17g, model "
+                      "%.17g/%.17g", k, axes.alpha[CONTROLLER_AXIS_PITCH],
+                      axes.alpha[CONTROLLER_AXIS_ROLL],
+                      controller_M->Y.alpha_pitch, controller_M->Y.alpha_roll);
+      return 1;
+    }
+  }
+
+  (void) snprintf(msg, msgSize, "pitch and roll x %ld ticks at outer ratio 3, "
+                  "bit-identical", CHECK_AXES_TICKS);
+  return 0;
+}
+
+/* Events seen by the zero-crossing check */
+typedef struct {
+  boolean_T reset;                     /* Event resets the integrator */
+  int_T num;
+  time_T t[CHECK_ZC_MAX_EVENTS];
+} check_ZcLog_T;
+
+static real_T check_zcRamp(const RT_MODEL_controller_T *controller_M, time_T t,
+  const X_controller_T *x, void *ctx)
+{
+  (void) controller_M;
+  (void) t;
+  (void) ctx;
+  return x->Integrator_CSTATE - CHECK_ZC_THRESHOLD;
+}
+
+static void check_zcEvent(RT_MODEL_controller_T *controller_M, time_T t,
+  X_controller_T *x, controller_ZcDirection_T direction, void *ctx)
+{
+  check_ZcLog_T *log = (check_ZcLog_T *)ctx;
+  (void) controller_M;
+  (void) direction;
+  if (log->num < CHECK_ZC_MAX_EVENTS) {
+    log->t[log->num] = t;
+  }
+
+  log->num++;
+  if (log->reset) {
+    x->Integrator_CSTATE = 0.0;
+  }
+}
+
+/*
+ * ODE45 zero-crossing location against an analytic ramp: with the outer
+ * loop output at zero and a constant pitch rate, the '<S37>/Integrator'
+ * state is x(t) = t, so g = x - 0.205 rises through zero at t = 0.205,
+ * inside a major step.  Without an event function the crossing is counted
+ * and the ramp is undisturbed; with one that resets the integrator the
+ * ramp restarts at each event, so the crossings fall at 0.205 and 0.41.
+ */
+static int_T check_zeroCrossing(char_T *msg, size_t msgSize)
+{
+  static RT_MODEL_controller_T model;
+  RT_MODEL_controller_T *const controller_M = &model;
+  int_T pass;
+  for (pass = 0; pass < 2; pass++) {
+    check_ZcLog_T log;
+    int_T expected = (pass == 0) ? 1 : 2;
+    time_T tEnd = CHECK_ZC_STEP_SIZE * (real_T)CHECK_ZC_TICKS;
+    real_T xEnd;
+    long k;
+    int_T i;
+    (void) memset(&log, 0, sizeof(log));
+    log.reset = (boolean_T)(pass == 1);
+    controller_initialize(controller_M);
+    controller_SetRates(controller_M, CHECK_ZC_STEP_SIZE, 1UL);
+    controller_SetSolverMode(controller_M, CONTROLLER_SOLVER_ODE45);
+
+    /* Sum1 = 1/I rad/s, so the Integral Gain input is 1 */
+    controller_M->U.pitch_rate = -1.0 / controller_DefaultP.PIDController_I;
+    if (controller_RegisterZeroCrossing(controller_M, &check_zcRamp,
+         CONTROLLER_ZC_RISING, log.reset ? &check_zcEvent : NULL, &log) < 0) {
+      (void) snprintf(msg, msgSize, "cannot register a signal");
+      return 1;
+    }
+
+    for (k = 0L; k < CHECK_ZC_TICKS; k++) {
+      controller_step(controller_M);
+    }
+
+    xEnd = log.reset ? tEnd - (real_T)expected * CHECK_ZC_THRESHOLD : tEnd;
+    if ((controller_GetSolverStats(controller_M)->zeroCrossings !=
+         (unsigned long long)expected) || (fabs
+         (controller_M->X.Integrator_CSTATE - xEnd) > CHECK_ZC_TOL)) {
+      (void) snprintf(msg, msgSize, "%s reset: %llu crossings (expected %d), "
+                      "integrator %.12g at t = %g (expected %.12g)",
+                      log.reset ? "with" : "without",
+                      controller_GetSolverStats(controller_M)->zeroCrossings,
+                      expected, controller_M->X.Integrator_CSTATE, tEnd, xEnd);
+      return 1;
+    }
+
+    for (i = 0; (i < log.num) && (i < CHECK_ZC_MAX_EVENTS); i++) {
+      if (fabs(log.t[i] - (real_T)(i + 1) * CHECK_ZC_THRESHOLD) > CHECK_ZC_TOL)
+      {
+        (void) snprintf(msg, msgSize, "event %d located at t = %.12g "
+                        "(expected %.12g)", i, log.t[i], (real_T)(i + 1) *
+                        CHECK_ZC_THRESHOLD);
+        return 1;
+      }
+    }
+
+    if (log.num != (log.reset ? expected : 0)) {
+      (void) snprintf(msg, msgSize, "%d event calls", log.num);
+      return 1;
+    }
+  }
+
+  (void) snprintf(msg, msgSize, "ramp crossing at t = %g located within "
+                  "%.0e s, with and without reset", CHECK_ZC_THRESHOLD,
+                  CHECK_ZC_TOL);
+  return 0;
+}
+
+static int_T check_batchVsStep(char_T *msg, size_t msgSize)
+{
+  static const struct {
+    controller_SolverMode_T mode;
+    const char_T *name;
+  } modes[] = {
+    { CONTROLLER_SOLVER_ODE4, "ode4" },
+    { CONTROLLER_SOLVER_ODE4_FUSED, "ode4-fused" },
+    { CONTROLLER_SOLVER_ZOH, "zoh" },
+    { CONTROLLER_SOLVER_TUSTIN, "tustin" }
+  };
+
+  static const controller_SolverMode_T unsupported[] = {
+    CONTROLLER_SOLVER_ROS2, CONTROLLER_SOLVER_ODE45
+  };
+
+  static RT_MODEL_controller_T model;
+  real_T maxErr = 0.0;
+  size_t m;
+  for (m = 0U; m < sizeof(modes) / sizeof(modes[0]); m++) {
+    real_T err = check_batchMode(modes[m].mode);
+    if (err < 0.0) {
+      (void) snprintf(msg, msgSize, "%s: cannot create the batch",
+                      modes[m].name);
+      return 1;
+    }
+
+    if (err > CONTROLLER_BATCH_TOLERANCE) {
+      (void) snprintf(msg, msgSize, "%s: max error %.3e (tolerance %.1e)",
+                      modes[m].name, err, CONTROLLER_BATCH_TOLERANCE);
+      return 1;
+    }
+
+    maxErr = fmax(maxErr, err);
+  }
+
+  /* A model in a mode the batch does not implement is rejected */
+  for (m = 0U; m < sizeof(unsupported) / sizeof(unsupported[0]); m++) {
+    controller_Batch_T *batch;
+    controller_initialize(&model);
+    controller_SetSolverMode(&model, unsupported[m]);
+    batch = controller_batch_create(CHECK_BATCH_INSTANCES, &model);
+    if (batch != (NULL)) {
+      controller_batch_destroy(batch);
+      (void) snprintf(msg, msgSize, "solver mode %d accepted",
+                      (int_T)unsupported[m]);
+      return 1;
+    }
+  }
+
+  (void) snprintf(msg, msgSize, "4 modes x %d instances x %ld ticks, max "
+                  "error %.3e (tolerance %.1e)", CHECK_BATCH_INSTANCES,
+                  CHECK_BATCH_TICKS, maxErr, CONTROLLER_BATCH_TOLERANCE);
+  return 0;
+}
+
+int_T main(void)
+{
+  static const struct {
+    const char_T *name;
+    check_Fcn_T fcn;
+  } checks[] = {
+    { "param_switch", &check_paramSwitch },
+    { "batch_vs_step", &check_batchVsStep },
+    { "axes_vs_step", &check_axesVsStep },
+    { "zero_crossing", &check_zeroCrossing }
+  };
+
+  int_T failed = 0;
+  size_t i;
+  for (i = 0U; i < sizeof(checks) / sizeof(checks[0]); i++) {
+    char_T msg[160];
+    int_T status;
+    msg[0] = '\0';
+    status = checks[i].fcn(msg, sizeof(msg));
+    (void) printf("%-16s %s  %s\n", checks[i].name, (status == 0) ? "PASS" :
+                  "FAIL", msg);
+    if (status != 0) {
+      failed++;
+    }
+  }
+
+  return failed;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
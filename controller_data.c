@@ -1,17 +1,57 @@
+#include "controller.h"
+#include "controller_private.h"
 
+/* Block parameters (default storage) */
+const P_controller_T controller_DefaultP = {
+  /* Expression: Kp_att
+   * Referenced by: '<S1>/Gain'
+   */
+  4.0,
 
-#include "controller.h"
+  /* Expression: Kp_att
+   * Referenced by: '<S1>/Gain1'
+   */
+  4.0,
+
+  /* Mask Parameter: PIDController_P
+   * Referenced by: '<S42>/Proportional Gain'
+   */
+  0.3,
+
+  /* Mask Parameter: PIDController_I
+   * Referenced by: '<S34>/Integral Gain'
+   */
+  0.5,
+
+  /* Mask Parameter: PIDController_D
+   * Referenced by: '<S30>/Derivative Gain'
+   */
+  0.005,
+
+  /* Mask Parameter: PIDController_N
+   * Referenced by: '<S40>/Filter Coefficient'
+   */
+  CONTROLLER_FILTER_COEFFICIENT,
+
+  /* Mask Parameter: PIDController1_P
+   * Referenced by: '<S92>/Proportional Gain'
+   */
+  0.3,
+
+  /* Mask Parameter: PIDController1_I
+   * Referenced by: '<S84>/Integral Gain'
+   */
+  0.5,
+
+  /* Mask Parameter: PIDController1_D
+   * Referenced by: '<S80>/Derivative Gain'
+   */
+  0.005,
 
-/* Invariant block signals (default storage) */
-const ConstB_controller_T controller_ConstB = {
-  0.0,                                 /* '<S1>/Sum' */
-  0.0,                                 /* '<S1>/Sum1' */
-  0.0,                                 /* '<S30>/Derivative Gain' */
-  -0.0,                                /* '<S34>/Integral Gain' */
-  0.0,                                 /* '<S1>/Sum2' */
-  0.0,                                 /* '<S1>/Sum3' */
-  0.0,                                 /* '<S80>/Derivative Gain' */
-  -0.0                                 /* '<S84>/Integral Gain' */
+  /* Mask Parameter: PIDController1_N
+   * Referenced by: '<S90>/Filter Coefficient'
+   */
+  CONTROLLER_FILTER_COEFFICIENT
 };
 
 /*
@@ -0,0 +1,278 @@
+
+#include <math.h>
+#include "controller_numeric.h"
+
+#define CASCADE_Q_MASK32               (0xFFFFFFFFUL)
+
+/*
+ * real_T reference
+ */
+void cascadeD_init(cascadeD_Params_T *p, cascadeD_State_T *s, const
+                   CascadeGains_T *g, time_T h)
+{
+  p->Kp_att = g->Kp_att;
+  p->Kp_rate = g->Kp_rate;
+  p->Kd_rate = g->Kd_rate;
+  p->N = g->N;
+  p->FilterA = exp(-g->N * h);
+  p->FilterB = -expm1(-g->N * h);
+  p->Ki_rate = g->Ki_rate;
+  p->h = h;
+  s->Filter_CSTATE = 0.0;
+  s->Integrator_CSTATE = 0.0;
+  s->RateCmd = 0.0;
+}
+
+real_T cascadeD_step(const cascadeD_Params_T *p, cascadeD_State_T *s, real_T
+                     setpoint, real_T angle, real_T rate)
+{
+  real_T e = s->RateCmd - rate;
+  real_T kde = p->Kd_rate * e;
+  real_T alpha = p->Kp_rate * e + s->Integrator_CSTATE + (kde -
+    s->Filter_CSTATE) * p->N;
+  s->Filter_CSTATE = p->FilterA * s->Filter_CSTATE + p->FilterB * kde;
+  s->Integrator_CSTATE += p->h * (p->Ki_rate * e);
+  s->RateCmd = p->Kp_att * (setpoint - angle);
+  return alpha;
+}
+
+/*
+ * real32_T
+ */
+void cascadeF_init(cascadeF_Params_T *p, cascadeF_State_T *s, const
+                   CascadeGains_T *g, time_T h)
+{
+  p->Kp_att = (real32_T)g->Kp_att;
+  p->Kp_rate = (real32_T)g->Kp_rate;
+  p->Kd_rate = (real32_T)g->Kd_rate;
+  p->N = (real32_T)g->N;
+  p->FilterA = (real32_T)exp(-g->N * h);
+  p->FilterB = (real32_T)-expm1(-g->N * h);
+  p->hKi = (real32_T)(h * g->Ki_rate);
+  s->Filter_CSTATE = 0.0F;
+  s->Integrator_CSTATE = 0.0F;
+  s->RateCmd = 0.0F;
+}
+
+real32_T cascadeF_step(const cascadeF_Params_T *p, cascadeF_State_T *s,
+  real32_T setpoint, real32_T angle, real32_T rate)
+{
+  real32_T e = s->RateCmd - rate;
+  real32_T kde = p->Kd_rate * e;
+  real32_T alpha = p->Kp_rate * e + s->Integrator_CSTATE + (kde -
+    s->Filter_CSTATE) * p->N;
+  s->Filter_CSTATE = p->FilterA * s->Filter_CSTATE + p->FilterB * kde;
+  s->Integrator_CSTATE += p->hKi * e;
+  s->RateCmd = p->Kp_att * (setpoint - angle);
+  return alpha;
+}
+
+/*
+ * Fixed point
+ */
+
+/* Magnitude of a 32-bit value as an unsigned 32-bit quantity */
+static uint32_T cascadeQ_abs(int32_T x)
+{
+  return (x < 0) ? ((~(uint32_T)x + 1UL) & CASCADE_Q_MASK32) : (uint32_T)x;
+}
+
+static int32_T cascadeQ_saturate(uint32_T mag, boolean_T neg)
+{
+  if (mag > (uint32_T)MAX_int32_T) {
+    return neg ? MIN_int32_T : MAX_int32_T;
+  }
+
+  return neg ? -(int32_T)mag : (int32_T)mag;
+}
+
+/*
+ * x * g with the product shifted right by g->frac, rounded to nearest (ties
+ * away from zero) and saturated.  The 64-bit product is formed from 16-bit
+ * halves in 32-bit unsigned arithmetic.
+ */
+#ifdef CASCADE_Q_USE_INT64
+
+/* Same arithmetic with a native 64-bit product, for hosts that have one */
+static int32_T cascadeQ_mul(int32_T x, const cascadeQ_Gain_T *g)
+{
+  boolean_T neg = (boolean_T)((x < 0) != (g->value < 0));
+  unsigned long long m = (unsigned long long)cascadeQ_abs(x) * (unsigned long
+    long)cascadeQ_abs(g->value);
+  if (g->frac > 0) {
+    m = (m + (1ULL << (uint_T)(g->frac - 1))) >> (uint_T)g->frac;
+  }
+
+  return cascadeQ_saturate((m > (unsigned long long)MAX_uint32_T) ?
+    MAX_uint32_T : (uint32_T)m, neg);
+}
+
+#else
+
+static int32_T cascadeQ_mul(int32_T x, const cascadeQ_Gain_T *g)
+{
+  boolean_T neg = (boolean_T)((x < 0) != (g->value < 0));
+  uint32_T a = cascadeQ_abs(x);
+  uint32_T b = cascadeQ_abs(g->value);
+  uint32_T aHi = a >> 16U;
+  uint32_T aLo = a & 65535UL;
+  uint32_T bHi = b >> 16U;
+  uint32_T bLo = b & 65535UL;
+  uint32_T pLoHi = aLo * bHi;
+  uint32_T pHiLo = aHi * bLo;
+  uint32_T lo = aLo * bLo;
+  uint32_T hi = aHi * bHi;
+  uint32_T t;
+  uint32_T mag;
+  int_T shift = g->frac;
+  t = (pLoHi << 16U) & CASCADE_Q_MASK32;
+  lo = (lo + t) & CASCADE_Q_MASK32;
+  if (lo < t) {
+    hi++;
+  }
+
+  t = (pHiLo << 16U) & CASCADE_Q_MASK32;
+  lo = (lo + t) & CASCADE_Q_MASK32;
+  if (lo < t) {
+    hi++;
+  }
+
+  hi += (pLoHi >> 16U) + (pHiLo >> 16U);
+
+  /* Round, then shift the 64-bit (hi, lo) pair right */
+  if (shift == 0) {
+    return cascadeQ_saturate((hi != 0UL) ? MAX_uint32_T : lo, neg);
+  }
+
+  if (shift <= 32) {
+    t = 1UL << (uint_T)(shift - 1);
+    lo = (lo + t) & CASCADE_Q_MASK32;
+    if (lo < t) {
+      hi++;
+    }
+  } else {
+    hi += 1UL << (uint_T)(shift - 33);
+  }
+
+  if (shift >= 32) {
+    mag = hi >> (uint_T)(shift - 32);
+  } else if ((hi >> (uint_T)shift) != 0UL) {
+    mag = MAX_uint32_T;
+  } else {
+    mag = ((hi << (uint_T)(32 - shift)) | (lo >> (uint_T)shift)) &
+      CASCADE_Q_MASK32;
+  }
+
+  return cascadeQ_saturate(mag, neg);
+}
+
+#endif
+
+static int32_T cascadeQ_add(int32_T a, int32_T b)
+{
+  if ((b > 0) && (a > MAX_int32_T - b)) {
+    return MAX_int32_T;
+  }
+
+  if ((b < 0) && (a < MIN_int32_T - b)) {
+    return MIN_int32_T;
+  }
+
+  return a + b;
+}
+
+static int32_T cascadeQ_sub(int32_T a, int32_T b)
+{
+  if ((b < 0) && (a > MAX_int32_T + b)) {
+    return MAX_int32_T;
+  }
+
+  if ((b > 0) && (a < MIN_int32_T + b)) {
+    return MIN_int32_T;
+  }
+
+  return a - b;
+}
+
+/* Quantizes a gain with as many fraction bits as fit in 31 bits */
+static void cascadeQ_gain(real_T v, cascadeQ_Gain_T *g)
+{
+  int_T e;
+  real_T q;
+  if (v == 0.0) {
+    g->value = 0;
+    g->frac = CASCADE_Q_FRAC;
+    return;
+  }
+
+  (void) frexp(v, &e);
+  g->frac = 31 - e;
+  if (g->frac > 62) {
+    g->frac = 62;
+  } else if (g->frac < 0) {
+    g->frac = 0;
+  }
+
+  q = floor(ldexp(fabs(v), g->frac) + 0.5);
+  if (q > (real_T)MAX_int32_T) {
+    q = (real_T)MAX_int32_T;
+  }
+
+  g->value = (v < 0.0) ? -(int32_T)q : (int32_T)q;
+}
+
+int32_T cascadeQ_fromReal(real_T x)
+{
+  real_T q = floor(ldexp(x, CASCADE_Q_FRAC) + 0.5);
+  if (q >= (real_T)MAX_int32_T) {
+    return MAX_int32_T;
+  }
+
+  if (q <= (real_T)MIN_int32_T) {
+    return MIN_int32_T;
+  }
+
+  return (int32_T)q;
+}
+
+real_T cascadeQ_toReal(int32_T x)
+{
+  return ldexp((real_T)x, -CASCADE_Q_FRAC);
+}
+
+void cascadeQ_init(cascadeQ_Params_T *p, cascadeQ_State_T *s, const
+                   CascadeGains_T *g, time_T h)
+{
+  cascadeQ_gain(g->Kp_att, &p->Kp_att);
+  cascadeQ_gain(g->Kp_rate, &p->Kp_rate);
+  cascadeQ_gain(g->Kd_rate, &p->Kd_rate);
+  cascadeQ_gain(g->N, &p->N);
+  cascadeQ_gain(exp(-g->N * h), &p->FilterA);
+  cascadeQ_gain(-expm1(-g->N * h), &p->FilterB);
+  cascadeQ_gain(h * g->Ki_rate, &p->hKi);
+  s->Filter_CSTATE = 0;
+  s->Integrator_CSTATE = 0;
+  s->RateCmd = 0;
+}
+
+int32_T cascadeQ_step(const cascadeQ_Params_T *p, cascadeQ_State_T *s, int32_T
+                      setpoint, int32_T angle, int32_T rate)
+{
+  int32_T e = cascadeQ_sub(s->RateCmd, rate);
+  int32_T kde = cascadeQ_mul(e, &p->Kd_rate);
+  int32_T alpha = cascadeQ_add(cascadeQ_add(cascadeQ_mul(e, &p->Kp_rate),
+    s->Integrator_CSTATE), cascadeQ_mul(cascadeQ_sub(kde, s->Filter_CSTATE),
+    &p->N));
+  s->Filter_CSTATE = cascadeQ_add(cascadeQ_mul(s->Filter_CSTATE, &p->FilterA),
+    cascadeQ_mul(kde, &p->FilterB));
+  s->Integrator_CSTATE = cascadeQ_add(s->Integrator_CSTATE, cascadeQ_mul(e,
+    &p->hKi));
+  s->RateCmd = cascadeQ_mul(cascadeQ_sub(setpoint, angle), &p->Kp_att);
+  return alpha;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
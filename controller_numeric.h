@@ -0,0 +1,161 @@
+
+
+#ifndef controller_numeric_h_
+#define controller_numeric_h_
+#include "rtwtypes.h"
+#include "closed_loop.h"
+
+/*
+ * Numeric variants of one axis of the cascade for targets without an FPU.
+ *
+ * Each variant implements one axis of the model in CONTROLLER_SOLVER_ZOH
+ * mode with the outer loop at the base rate (controller_SetRates ratio 1):
+ * inner PID on the rate error with the derivative filter and integrator
+ * advanced by the exact ZOH update, then outer P on the attitude error,
+ * whose rate command the inner loop takes at the next step, as
+ * controller_step and controller_axes_step run them:
+ *
+ *   e        = rateCmd - rate
+ *   alpha    = Kp_rate*e + xi + N*(Kd_rate*e - xf)
+ *   xf'      = a*xf + b*(Kd_rate*e),   xi' = xi + h*(Ki_rate*e)
+ *   rateCmd' = Kp_att*(sp - angle)
+ *
+ *   D - real_T, the reference, in the operation order of the generated
+ *       code and bit-identical to its '<Root>/alpha_pitch' when built
+ *       without floating point contraction
+ *   F - real32_T
+ *   Q - fixed point: signals and states in Q7.24 in int32_T, each gain in
+ *       the Q format that gives it the most fractional bits.  Products use
+ *       a 32x32->64 bit multiply built from 16-bit halves, rounded to
+ *       nearest and saturated, so no 64-bit integer type is required;
+ *       -DCASCADE_Q_USE_INT64 uses a native 64-bit product instead, with
+ *       identical results.
+ *
+ * Gains are converted once by the *_init functions; the step functions do
+ * no divisions and no conversions.  CONTROLLER_NUMERIC selects the variant
+ * behind the cascade_* names at compile time.
+ */
+#define CONTROLLER_NUMERIC_DOUBLE      0
+#define CONTROLLER_NUMERIC_SINGLE      1
+#define CONTROLLER_NUMERIC_FIXED       2
+#ifndef CONTROLLER_NUMERIC
+#define CONTROLLER_NUMERIC             CONTROLLER_NUMERIC_DOUBLE
+#endif
+
+/* Fraction bits of fixed-point signals and states */
+#define CASCADE_Q_FRAC                 24
+#define CASCADE_Q_ONE                  (1L << CASCADE_Q_FRAC)
+
+/* real_T reference */
+typedef struct {
+  real_T Kp_att;
+  real_T Kp_rate;
+  real_T Kd_rate;
+  real_T N;
+  real_T FilterA;                      /* exp(-N*h) */
+  real_T FilterB;                      /* 1 - exp(-N*h) */
+  real_T Ki_rate;
+  real_T h;
+} cascadeD_Params_T;
+
+typedef struct {
+  real_T Filter_CSTATE;
+  real_T Integrator_CSTATE;
+  real_T RateCmd;                      /* '<S1>/Gain', held one step */
+} cascadeD_State_T;
+
+/* real32_T */
+typedef struct {
+  real32_T Kp_att;
+  real32_T Kp_rate;
+  real32_T Kd_rate;
+  real32_T N;
+  real32_T FilterA;
+  real32_T FilterB;
+  real32_T hKi;
+} cascadeF_Params_T;
+
+typedef struct {
+  real32_T Filter_CSTATE;
+  real32_T Integrator_CSTATE;
+  real32_T RateCmd;
+} cascadeF_State_T;
+
+/* Fixed point: one gain with its own fraction length */
+typedef struct {
+  int32_T value;
+  int_T frac;
+} cascadeQ_Gain_T;
+
+typedef struct {
+  cascadeQ_Gain_T Kp_att;
+  cascadeQ_Gain_T Kp_rate;
+  cascadeQ_Gain_T Kd_rate;
+  cascadeQ_Gain_T N;
+  cascadeQ_Gain_T FilterA;
+  cascadeQ_Gain_T FilterB;
+  cascadeQ_Gain_T hKi;
+} cascadeQ_Params_T;
+
+typedef struct {
+  int32_T Filter_CSTATE;               /* Q7.24 */
+  int32_T Integrator_CSTATE;           /* Q7.24 */
+  int32_T RateCmd;                     /* Q7.24 */
+} cascadeQ_State_T;
+
+extern void cascadeD_init(cascadeD_Params_T *p, cascadeD_State_T *s, const
+  CascadeGains_T *g, time_T h);
+extern real_T cascadeD_step(const cascadeD_Params_T *p, cascadeD_State_T *s,
+  real_T setpoint, real_T angle, real_T rate);
+extern void cascadeF_init(cascadeF_Params_T *p, cascadeF_State_T *s, const
+  CascadeGains_T *g, time_T h);
+extern real32_T cascadeF_step(const cascadeF_Params_T *p, cascadeF_State_T *s,
+  real32_T setpoint, real32_T angle, real32_T rate);
+extern void cascadeQ_init(cascadeQ_Params_T *p, cascadeQ_State_T *s, const
+  CascadeGains_T *g, time_T h);
+extern int32_T cascadeQ_step(const cascadeQ_Params_T *p, cascadeQ_State_T *s,
+  int32_T setpoint, int32_T angle, int32_T rate);
+
+/* Conversions between real_T and Q7.24, saturating */
+extern int32_T cascadeQ_fromReal(real_T x);
+extern real_T cascadeQ_toReal(int32_T x);
+
+/* Compile-time selected variant */
+#if CONTROLLER_NUMERIC == CONTROLLER_NUMERIC_FIXED
+
+typedef int32_T cascade_Signal_T;
+typedef cascadeQ_Params_T cascade_Params_T;
+typedef cascadeQ_State_T cascade_State_T;
+
+#define cascade_init                   cascadeQ_init
+#define cascade_step                   cascadeQ_step
+#define cascade_fromReal(x)            cascadeQ_fromReal(x)
+#define cascade_toReal(x)              cascadeQ_toReal(x)
+#elif CONTROLLER_NUMERIC == CONTROLLER_NUMERIC_SINGLE
+
+typedef real32_T cascade_Signal_T;
+typedef cascadeF_Params_T cascade_Params_T;
+typedef cascadeF_State_T cascade_State_T;
+
+#define cascade_init                   cascadeF_init
+#define cascade_step                   cascadeF_step
+#define cascade_fromReal(x)            ((real32_T)(x))
+#define cascade_toReal(x)              ((real_T)(x))
+#else
+
+typedef real_T cascade_Signal_T;
+typedef cascadeD_Params_T cascade_Params_T;
+typedef cascadeD_State_T cascade_State_T;
+
+#define cascade_init                   cascadeD_init
+#define cascade_step                   cascadeD_step
+#define cascade_fromReal(x)            (x)
+#define cascade_toReal(x)              (x)
+#endif
+#endif                                 /* controller_numeric_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -20,8 +20,27 @@
 #define rtmSetTPtr(rtm, val)           ((rtm)->Timing.t = (val))
 #endif
 
+/* Parameter set of the current step */
+#ifndef rtmGetParams
+#define rtmGetParams(rtm)              (&((rtm)->ParamBank.bank[(rtm)->ParamBank.inUse]))
+#endif
+
+/* Parameter bank indices, shared between the model and
+ * controller_SetParams */
+#define rtmParamIndexLoad(ptr)         __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define rtmParamIndexStore(ptr, val)   __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+
+/* Default of the mask parameters PIDController_N and PIDController1_N,
+ * the derivative filter coefficients */
+#define CONTROLLER_FILTER_COEFFICIENT  664.682083275505
+
 /* private model entry point functions */
-extern void controller_derivatives(void);
+extern void controller_derivatives(RT_MODEL_controller_T *const controller_M);
+
+/* x[k+1] = (*a)*x[k] + (*b)*u[k] of a derivative filter with coefficient N
+ * in the discrete solver modes; zero in the other modes */
+extern void controller_DiscreteFilterCoeffs(controller_SolverMode_T mode,
+  real_T N, time_T h, real_T *a, real_T *b);
 
 #endif                                 /* controller_private_h_ */
 
@@ -0,0 +1,553 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "controller_ss.h"
+#include "controller_batch.h"
+#include "controller_private.h"
+
+#define SS_NXC                         CONTROLLER_SS_NXC
+#define SS_NR                          CONTROLLER_SS_NR
+#define SS_NX                          CONTROLLER_SS_NX
+#define SS_NU                          CONTROLLER_SS_NU
+#define SS_NY                          CONTROLLER_SS_NY
+#define SS_NA                          (SS_NX + SS_NU)/* Augmented for ZOH */
+#define SS_LANES                       CONTROLLER_BATCH_ALIGN_LANES
+#define SS_ALIGN_BYTES                 (SS_LANES * sizeof(real_T))
+#define SS_NUM_ROWS                    (SS_NX + SS_NU + SS_NY)
+#define SS_STABLE_SQUARINGS            (40)/* Ad^(2^40) */
+#define SS_STABLE_BOUND                (1.0E+6)
+
+/*
+ * Response of a scratch instance at (x, u): one controller_step for the
+ * outputs and the rate commands the outer loops leave for the next tick,
+ * then the derivatives at x in a minor step, as the solvers evaluate them.
+ */
+static void controller_ss_probe(const RT_MODEL_controller_T *const
+  controller_M, const real_T *x, const real_T *u, real_T *dx, real_T *y,
+  real_T *r)
+{
+  RT_MODEL_controller_T scratch;
+  XDot_controller_T xdot;
+  controller_initialize(&scratch);
+  scratch.ParamBank.bank[0] = *controller_GetParams(controller_M);
+  controller_SetRates(&scratch, controller_M->Timing.stepSize0, 1UL);
+  (void) memcpy(&scratch.X, x, sizeof(X_controller_T));
+  scratch.B.Gain = x[SS_NXC];
+  scratch.B.Gain1 = x[SS_NXC + 1];
+  (void) memcpy(&scratch.U, u, sizeof(ExtU_controller_T));
+  controller_step(&scratch);
+  (void) memcpy(y, &scratch.Y, sizeof(ExtY_controller_T));
+  r[0] = scratch.B.Gain;
+  r[1] = scratch.B.Gain1;
+
+  /* The inner loop signals of the major step still hold */
+  (void) memcpy(&scratch.X, x, sizeof(X_controller_T));
+  scratch.derivs = (real_T *)&xdot;
+  rtsiSetSimTimeStep(&scratch.solverInfo, MINOR_TIME_STEP);
+  controller_step0(&scratch);
+  controller_derivatives(&scratch);
+  (void) memcpy(dx, &xdot, sizeof(XDot_controller_T));
+}
+
+void controller_ss_extract(const RT_MODEL_controller_T *const controller_M,
+  controller_SS_T *ss)
+{
+  real_T x[SS_NX];
+  real_T u[SS_NU];
+  real_T dx[SS_NXC];
+  real_T y[SS_NY];
+  real_T r[SS_NR];
+  int_T i;
+  int_T j;
+
+  /* The model has no affine terms: column j is the response to unit j.
+   * The rate commands are held within a tick, their derivatives zero. */
+  (void) memset(ss, 0, sizeof(controller_SS_T));
+  for (j = 0; j < SS_NX; j++) {
+    (void) memset(x, 0, sizeof(x));
+    (void) memset(u, 0, sizeof(u));
+    x[j] = 1.0;
+    controller_ss_probe(controller_M, x, u, dx, y, r);
+    for (i = 0; i < SS_NXC; i++) {
+      ss->A[i][j] = dx[i];
+    }
+
+    for (i = 0; i < SS_NY; i++) {
+      ss->C[i][j] = y[i];
+    }
+  }
+
+  for (j = 0; j < SS_NU; j++) {
+    (void) memset(x, 0, sizeof(x));
+    (void) memset(u, 0, sizeof(u));
+    u[j] = 1.0;
+    controller_ss_probe(controller_M, x, u, dx, y, r);
+    for (i = 0; i < SS_NXC; i++) {
+      ss->B[i][j] = dx[i];
+    }
+
+    for (i = 0; i < SS_NY; i++) {
+      ss->D[i][j] = y[i];
+    }
+
+    for (i = 0; i < SS_NR; i++) {
+      ss->Bo[i][j] = r[i];
+    }
+  }
+}
+
+/* c = a*b for n-by-n row-major matrices, c distinct from a and b */
+static void controller_ss_matMul(int_T n, const real_T *a, const real_T *b,
+  real_T *c)
+{
+  int_T i;
+  int_T j;
+  int_T k;
+  for (i = 0; i < n; i++) {
+    for (j = 0; j < n; j++) {
+      real_T acc = 0.0;
+      for (k = 0; k < n; k++) {
+        acc += a[i * n + k] * b[k * n + j];
+      }
+
+      c[i * n + j] = acc;
+    }
+  }
+}
+
+/* e = expm(m) by scaling and squaring with a Taylor series */
+static void controller_ss_expm(const real_T m[SS_NA * SS_NA], real_T e[SS_NA *
+  SS_NA])
+{
+  real_T s[SS_NA * SS_NA];
+  real_T term[SS_NA * SS_NA];
+  real_T tmp[SS_NA * SS_NA];
+  real_T norm = 0.0;
+  real_T scale = 1.0;
+  int_T squarings = 0;
+  int_T i;
+  int_T j;
+  int_T k;
+
+  /* Scale the 1-norm below 1/2, where 18 terms reach full precision */
+  for (j = 0; j < SS_NA; j++) {
+    real_T col = 0.0;
+    for (i = 0; i < SS_NA; i++) {
+      col += fabs(m[i * SS_NA + j]);
+    }
+
+    if (col > norm) {
+      norm = col;
+    }
+  }
+
+  while ((norm * scale > 0.5) && (squarings < 64)) {
+    scale *= 0.5;
+    squarings++;
+  }
+
+  for (i = 0; i < SS_NA * SS_NA; i++) {
+    s[i] = m[i] * scale;
+    e[i] = 0.0;
+    term[i] = 0.0;
+  }
+
+  for (i = 0; i < SS_NA; i++) {
+    e[i * SS_NA + i] = 1.0;
+    term[i * SS_NA + i] = 1.0;
+  }
+
+  for (k = 1; k <= 18; k++) {
+    controller_ss_matMul(SS_NA, term, s, tmp);
+    for (i = 0; i < SS_NA * SS_NA; i++) {
+      term[i] = tmp[i] / (real_T)k;
+      e[i] += term[i];
+    }
+  }
+
+  for (k = 0; k < squarings; k++) {
+    controller_ss_matMul(SS_NA, e, e, tmp);
+    (void) memcpy(e, tmp, sizeof(tmp));
+  }
+}
+
+/* Inverse of a by Gauss-Jordan elimination with partial pivoting */
+static int_T controller_ss_invNx(real_T a[SS_NX][SS_NX], real_T inv[SS_NX]
+  [SS_NX])
+{
+  int_T i;
+  int_T j;
+  int_T k;
+  for (i = 0; i < SS_NX; i++) {
+    for (j = 0; j < SS_NX; j++) {
+      inv[i][j] = (i == j) ? 1.0 : 0.0;
+    }
+  }
+
+  for (k = 0; k < SS_NX; k++) {
+    int_T p = k;
+    real_T d;
+    for (i = k + 1; i < SS_NX; i++) {
+      if (fabs(a[i][k]) > fabs(a[p][k])) {
+        p = i;
+      }
+    }
+
+    if (a[p][k] == 0.0) {
+      return CONTROLLER_SS_ERR_SINGULAR;
+    }
+
+    if (p != k) {
+      for (j = 0; j < SS_NX; j++) {
+        real_T t = a[k][j];
+        a[k][j] = a[p][j];
+        a[p][j] = t;
+        t = inv[k][j];
+        inv[k][j] = inv[p][j];
+        inv[p][j] = t;
+      }
+    }
+
+    d = 1.0 / a[k][k];
+    for (j = 0; j < SS_NX; j++) {
+      a[k][j] *= d;
+      inv[k][j] *= d;
+    }
+
+    for (i = 0; i < SS_NX; i++) {
+      if (i != k) {
+        real_T f = a[i][k];
+        for (j = 0; j < SS_NX; j++) {
+          a[i][j] -= f * a[k][j];
+          inv[i][j] -= f * inv[k][j];
+        }
+      }
+    }
+  }
+
+  return CONTROLLER_SS_OK;
+}
+
+int_T controller_ss_discretize(const controller_SS_T *ss, time_T h,
+  controller_SolverMode_T method, controller_DiscreteSS_T *dss)
+{
+  int_T i;
+  int_T j;
+  int_T k;
+  switch (method) {
+   case CONTROLLER_SOLVER_ZOH:
+    {
+      /* expm([A B; 0 0]*h) = [Ad Bd; 0 I] */
+      real_T m[SS_NA * SS_NA];
+      real_T e[SS_NA * SS_NA];
+      (void) memset(m, 0, sizeof(m));
+      for (i = 0; i < SS_NX; i++) {
+        for (j = 0; j < SS_NX; j++) {
+          m[i * SS_NA + j] = ss->A[i][j] * h;
+        }
+
+        for (j = 0; j < SS_NU; j++) {
+          m[i * SS_NA + SS_NX + j] = ss->B[i][j] * h;
+        }
+      }
+
+      controller_ss_expm(m, e);
+      for (i = 0; i < SS_NX; i++) {
+        for (j = 0; j < SS_NX; j++) {
+          dss->Ad[i][j] = e[i * SS_NA + j];
+        }
+
+        for (j = 0; j < SS_NU; j++) {
+          dss->Bd[i][j] = e[i * SS_NA + SS_NX + j];
+        }
+      }
+    }
+    break;
+
+   case CONTROLLER_SOLVER_TUSTIN:
+    {
+      real_T lhs[SS_NX][SS_NX];
+      real_T inv[SS_NX][SS_NX];
+      for (i = 0; i < SS_NX; i++) {
+        for (j = 0; j < SS_NX; j++) {
+          lhs[i][j] = ((i == j) ? 1.0 : 0.0) - 0.5 * h * ss->A[i][j];
+        }
+      }
+
+      if (controller_ss_invNx(lhs, inv) != CONTROLLER_SS_OK) {
+        return CONTROLLER_SS_ERR_SINGULAR;
+      }
+
+      for (i = 0; i < SS_NX; i++) {
+        for (j = 0; j < SS_NX; j++) {
+          real_T acc = 0.0;
+          for (k = 0; k < SS_NX; k++) {
+            acc += inv[i][k] * (((k == j) ? 1.0 : 0.0) + 0.5 * h * ss->A[k][j]);
+          }
+
+          dss->Ad[i][j] = acc;
+        }
+
+        for (j = 0; j < SS_NU; j++) {
+          real_T acc = 0.0;
+          for (k = 0; k < SS_NX; k++) {
+            acc += inv[i][k] * ss->B[k][j];
+          }
+
+          dss->Bd[i][j] = acc * h;
+        }
+      }
+    }
+    break;
+
+   case CONTROLLER_SOLVER_ODE4:
+   case CONTROLLER_SOLVER_ODE4_FUSED:
+    {
+      /* Horner form of Ad = sum (Ah)^n/n!, n = 0..4, and
+       * Bd = h * sum (Ah)^n/(n+1)! * B, n = 0..3 */
+      real_T ah[SS_NX][SS_NX];
+      real_T p[SS_NX][SS_NX];
+      real_T q[SS_NX][SS_NX];
+      for (i = 0; i < SS_NX; i++) {
+        for (j = 0; j < SS_NX; j++) {
+          ah[i][j] = ss->A[i][j] * h;
+          p[i][j] = ((i == j) ? 1.0 : 0.0) + ah[i][j] / 4.0;
+        }
+      }
+
+      for (k = 3; k >= 1; k--) {
+        controller_ss_matMul(SS_NX, &ah[0][0], &p[0][0], &q[0][0]);
+        for (i = 0; i < SS_NX; i++) {
+          for (j = 0; j < SS_NX; j++) {
+            p[i][j] = ((i == j) ? 1.0 : 0.0) + q[i][j] / (real_T)k;
+          }
+        }
+
+        if (k == 2) {
+          /* p = I + Ah/2 + (Ah)^2/6 + (Ah)^3/24 = phi1 */
+          for (i = 0; i < SS_NX; i++) {
+            for (j = 0; j < SS_NU; j++) {
+              real_T acc = 0.0;
+              int_T l;
+              for (l = 0; l < SS_NX; l++) {
+                acc += p[i][l] * ss->B[l][j];
+              }
+
+              dss->Bd[i][j] = acc * h;
+            }
+          }
+        }
+      }
+
+      (void) memcpy(dss->Ad, p, sizeof(p));
+    }
+    break;
+
+   default:
+    /* ROS2 and ODE45 are not a fixed linear map per step */
+    return CONTROLLER_SS_ERR_MODE;
+  }
+
+  /* The outer loops overwrite the held rate commands at the end of a tick */
+  for (i = SS_NXC; i < SS_NX; i++) {
+    for (j = 0; j < SS_NX; j++) {
+      dss->Ad[i][j] = 0.0;
+    }
+
+    for (j = 0; j < SS_NU; j++) {
+      dss->Bd[i][j] = ss->Bo[i - SS_NXC][j];
+    }
+  }
+
+  (void) memcpy(dss->C, ss->C, sizeof(ss->C));
+  (void) memcpy(dss->D, ss->D, sizeof(ss->D));
+  dss->h = h;
+  dss->method = method;
+  return CONTROLLER_SS_OK;
+}
+
+boolean_T controller_ss_isStable(const controller_DiscreteSS_T *dss)
+{
+  real_T p[SS_NX * SS_NX];
+  real_T q[SS_NX * SS_NX];
+  int_T s;
+  int_T i;
+  (void) memcpy(p, &dss->Ad[0][0], sizeof(p));
+  for (s = 0; s < SS_STABLE_SQUARINGS; s++) {
+    controller_ss_matMul(SS_NX, p, p, q);
+    for (i = 0; i < SS_NX * SS_NX; i++) {
+      /* Written so that NaN fails */
+      if (!(fabs(q[i]) <= SS_STABLE_BOUND)) {
+        return false;
+      }
+    }
+
+    (void) memcpy(p, q, sizeof(p));
+  }
+
+  return true;
+}
+
+controller_SSBatch_T *controller_ss_batch_create(int_T numInstances, const
+  controller_DiscreteSS_T *sys)
+{
+  controller_SSBatch_T *batch;
+  size_t numLanes;
+  size_t bytes;
+  uintptr_t base;
+  real_T *arrays;
+  if (numInstances <= 0) {
+    return (NULL);
+  }
+
+  batch = (controller_SSBatch_T *)malloc(sizeof(controller_SSBatch_T));
+  if (batch == (NULL)) {
+    return (NULL);
+  }
+
+  numLanes = (((size_t)numInstances + SS_LANES - 1U) / SS_LANES) * SS_LANES;
+  bytes = SS_NUM_ROWS * numLanes * sizeof(real_T) + SS_ALIGN_BYTES;
+  batch->memory = calloc(1U, bytes);
+  if (batch->memory == (NULL)) {
+    free(batch);
+    return (NULL);
+  }
+
+  base = ((uintptr_t)batch->memory + SS_ALIGN_BYTES - 1U) & ~((uintptr_t)
+    SS_ALIGN_BYTES - 1U);
+  arrays = (real_T *)base;
+  batch->numInstances = numInstances;
+  batch->numLanes = (int_T)numLanes;
+  batch->X = arrays;
+  batch->U = arrays + SS_NX * numLanes;
+  batch->Y = arrays + (SS_NX + SS_NU) * numLanes;
+  batch->sys = *sys;
+  batch->clockTick0 = 0UL;
+  return batch;
+}
+
+void controller_ss_batch_destroy(controller_SSBatch_T *batch)
+{
+  if (batch != (NULL)) {
+    free(batch->memory);
+    free(batch);
+  }
+}
+
+/*
+ * [Y; X] = [C D; Ad Bd] * [X; U] over blocks of SS_LANES instances.  The
+ * block's states and inputs are gathered first, so X can be overwritten in
+ * place, and the innermost loops run over the lanes for the vectorizer.
+ */
+void controller_ss_batch_step(controller_SSBatch_T *batch)
+{
+  const controller_DiscreteSS_T *sys = &batch->sys;
+  size_t n = (size_t)batch->numLanes;
+  size_t b;
+  for (b = 0U; b < n; b += SS_LANES) {
+    real_T in[SS_NX + SS_NU][SS_LANES];
+    int_T i;
+    int_T j;
+    int_T l;
+    for (i = 0; i < SS_NX; i++) {
+      (void) memcpy(in[i], &batch->X[i * n + b], sizeof(in[i]));
+    }
+
+    for (i = 0; i < SS_NU; i++) {
+      (void) memcpy(in[SS_NX + i], &batch->U[i * n + b], sizeof(in[i]));
+    }
+
+    for (i = 0; i < SS_NY; i++) {
+      real_T acc[SS_LANES];
+      for (l = 0; l < SS_LANES; l++) {
+        acc[l] = 0.0;
+      }
+
+      for (j = 0; j < SS_NX; j++) {
+        real_T c = sys->C[i][j];
+        for (l = 0; l < SS_LANES; l++) {
+          acc[l] += c * in[j][l];
+        }
+      }
+
+      for (j = 0; j < SS_NU; j++) {
+        real_T d = sys->D[i][j];
+        for (l = 0; l < SS_LANES; l++) {
+          acc[l] += d * in[SS_NX + j][l];
+        }
+      }
+
+      (void) memcpy(&batch->Y[i * n + b], acc, sizeof(acc));
+    }
+
+    for (i = 0; i < SS_NX; i++) {
+      real_T acc[SS_LANES];
+      for (l = 0; l < SS_LANES; l++) {
+        acc[l] = 0.0;
+      }
+
+      for (j = 0; j < SS_NX; j++) {
+        real_T a = sys->Ad[i][j];
+        for (l = 0; l < SS_LANES; l++) {
+          acc[l] += a * in[j][l];
+        }
+      }
+
+      for (j = 0; j < SS_NU; j++) {
+        real_T bd = sys->Bd[i][j];
+        for (l = 0; l < SS_LANES; l++) {
+          acc[l] += bd * in[SS_NX + j][l];
+        }
+      }
+
+      (void) memcpy(&batch->X[i * n + b], acc, sizeof(acc));
+    }
+  }
+
+  batch->clockTick0++;
+}
+
+void controller_ss_batch_load(controller_SSBatch_T *batch, int_T idx, const
+  RT_MODEL_controller_T *controller_M)
+{
+  const real_T *x = (const real_T *)&controller_M->X;
+  const real_T *u = (const real_T *)controller_M->inputs;
+  size_t n = (size_t)batch->numLanes;
+  int_T i;
+  for (i = 0; i < SS_NXC; i++) {
+    batch->X[i * n + (size_t)idx] = x[i];
+  }
+
+  batch->X[SS_NXC * n + (size_t)idx] = controller_M->B.Gain;
+  batch->X[(SS_NXC + 1) * n + (size_t)idx] = controller_M->B.Gain1;
+
+  for (i = 0; i < SS_NU; i++) {
+    batch->U[i * n + (size_t)idx] = u[i];
+  }
+}
+
+void controller_ss_batch_store(const controller_SSBatch_T *batch, int_T idx,
+  RT_MODEL_controller_T *controller_M)
+{
+  real_T *x = (real_T *)&controller_M->X;
+  real_T *y = (real_T *)controller_M->outputs;
+  size_t n = (size_t)batch->numLanes;
+  int_T i;
+  for (i = 0; i < SS_NXC; i++) {
+    x[i] = batch->X[i * n + (size_t)idx];
+  }
+
+  controller_M->B.Gain = batch->X[SS_NXC * n + (size_t)idx];
+  controller_M->B.Gain1 = batch->X[(SS_NXC + 1) * n + (size_t)idx];
+
+  for (i = 0; i < SS_NY; i++) {
+    y[i] = batch->Y[i * n + (size_t)idx];
+  }
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,127 @@
+
+
+#ifndef controller_ss_h_
+#define controller_ss_h_
+#include "rtwtypes.h"
+#include "controller.h"
+
+/*
+ * Linear state-space form of the controller.
+ *
+ * With the outer loop at the base rate (outer rate ratio 1) and the rates
+ * run in controller_step order, the model is a linear time-invariant
+ * system in the inports u (ExtU_controller_T order) and the outports y
+ * (ExtY_controller_T order).  Its state x is the continuous states in
+ * X_controller_T order followed by the rate commands '<S1>/Gain' and
+ * '<S1>/Gain1', which the outer loops compute after the base rate and the
+ * inner loops hold until the next tick.  Within a tick
+ *
+ *   dx/dt = A*x + B*u,   y = C*x + D*u
+ *
+ * with the rows of A and B for the rate commands zero, and at the end of
+ * the tick the outer loops set the rate commands to Bo*u.
+ *
+ * controller_ss_extract() obtains A, B, C, D and Bo from the model itself,
+ * by stepping a scratch instance with unit states and inputs, so the
+ * matrices follow the gains of a regenerated model or of any parameter set.
+ * controller_ss_discretize() then computes, for a step h and one of the
+ * model's solver modes, the matrices of the update the generated code
+ * performs with inputs held over the step:
+ *
+ *   x[k+1] = Ad*x[k] + Bd*u[k],   y[k] = C*x[k] + D*u[k]
+ *
+ *   CONTROLLER_SOLVER_ZOH    - Ad = expm(A*h), Bd = integral of expm(A*s)*B
+ *                              over [0, h], by scaling and squaring
+ *   CONTROLLER_SOLVER_TUSTIN - Ad = (I - A*h/2)\(I + A*h/2),
+ *                              Bd = (I - A*h/2)\(B*h)
+ *   CONTROLLER_SOLVER_ODE4, _ODE4_FUSED - the degree 4 Taylor polynomials
+ *                              one Runge-Kutta step applies to a linear
+ *                              system
+ *
+ * and the rows for the rate commands replaced by [0 Bo].
+ *
+ * The controller_SSBatch_T engine steps K instances of one discrete
+ * system as a single small matrix product per tick over states and inputs
+ * stored one row per variable, for sweeps over initial conditions, inputs
+ * and disturbances.  The dense product does several times the arithmetic
+ * of the generated step, so it only outruns controller_step
+ * when the compiler vectorizes it across wide registers: build with the
+ * exact flags of the Makefile (-O3 -march=native).  At -O2 for baseline
+ * x86-64 it is about three times slower than controller_step.
+ */
+#define CONTROLLER_SS_NXC              4    /* Continuous states */
+#define CONTROLLER_SS_NR               2    /* Held rate commands */
+#define CONTROLLER_SS_NX               (CONTROLLER_SS_NXC + CONTROLLER_SS_NR)
+#define CONTROLLER_SS_NU               6
+#define CONTROLLER_SS_NY               2
+
+/* Return codes */
+#define CONTROLLER_SS_OK               (0)
+#define CONTROLLER_SS_ERR_MODE         (-1) /* No linear form for the mode */
+#define CONTROLLER_SS_ERR_SINGULAR     (-2)
+
+typedef struct {
+  real_T A[CONTROLLER_SS_NX][CONTROLLER_SS_NX];
+  real_T B[CONTROLLER_SS_NX][CONTROLLER_SS_NU];
+  real_T C[CONTROLLER_SS_NY][CONTROLLER_SS_NX];
+  real_T D[CONTROLLER_SS_NY][CONTROLLER_SS_NU];
+  real_T Bo[CONTROLLER_SS_NR][CONTROLLER_SS_NU];/* Outer loops */
+} controller_SS_T;
+
+typedef struct {
+  real_T Ad[CONTROLLER_SS_NX][CONTROLLER_SS_NX];
+  real_T Bd[CONTROLLER_SS_NX][CONTROLLER_SS_NU];
+  real_T C[CONTROLLER_SS_NY][CONTROLLER_SS_NX];
+  real_T D[CONTROLLER_SS_NY][CONTROLLER_SS_NU];
+  time_T h;
+  controller_SolverMode_T method;
+} controller_DiscreteSS_T;
+
+/* Continuous matrices for the parameter set controller_M is stepping with */
+extern void controller_ss_extract(const RT_MODEL_controller_T *const
+  controller_M, controller_SS_T *ss);
+
+/* Discrete matrices of the update of solver mode method at step h */
+extern int_T controller_ss_discretize(const controller_SS_T *ss, time_T h,
+  controller_SolverMode_T method, controller_DiscreteSS_T *dss);
+
+/* True when the update x[k+1] = Ad*x[k] is stable: the powers of Ad up to
+ * Ad^(2^40) stay bounded.  False e.g. for ODE4 with the filter pole beyond
+ * the Runge-Kutta stability region, N*h > 2.78. */
+extern boolean_T controller_ss_isStable(const controller_DiscreteSS_T *dss);
+
+/* Batch of instances of one discrete system.  Row r of X holds state r of
+ * every instance, likewise for U and Y; rows are numLanes long. */
+typedef struct {
+  int_T numInstances;                  /* Instances in use */
+  int_T numLanes;                      /* Padded row length */
+  real_T *X;                           /* CONTROLLER_SS_NX rows */
+  real_T *U;                           /* CONTROLLER_SS_NU rows */
+  real_T *Y;                           /* CONTROLLER_SS_NY rows */
+  controller_DiscreteSS_T sys;
+  uint32_T clockTick0;
+  void *memory;                        /* Backing allocation */
+} controller_SSBatch_T;
+
+/* Allocates a batch with zero states and inputs, NULL on failure */
+extern controller_SSBatch_T *controller_ss_batch_create(int_T numInstances,
+  const controller_DiscreteSS_T *sys);
+extern void controller_ss_batch_destroy(controller_SSBatch_T *batch);
+
+/* One tick: Y = C*X + D*U, then X = Ad*X + Bd*U */
+extern void controller_ss_batch_step(controller_SSBatch_T *batch);
+
+/* Load copies one instance's states and inputs from a model into the
+ * batch; store copies its states and last outputs back into a model */
+extern void controller_ss_batch_load(controller_SSBatch_T *batch, int_T idx,
+  const RT_MODEL_controller_T *controller_M);
+extern void controller_ss_batch_store(const controller_SSBatch_T *batch, int_T
+  idx, RT_MODEL_controller_T *controller_M);
+
+#endif                                 /* controller_ss_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
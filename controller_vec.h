@@ -0,0 +1,50 @@
+
+
+#ifndef controller_vec_h_
+#define controller_vec_h_
+#include "rtwtypes.h"
+
+/*
+ * Vector abstraction over the lanes of the structure-of-arrays engines
+ * (controller_batch.c, controller_axes.c).  Their kernels are written once
+ * against these macros and instantiated for the widest instruction set the
+ * including translation unit is compiled for.
+ */
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define BATCH_VLEN                     8
+typedef __m512d batch_vec_T;
+#define bvLoad(p)                      _mm512_load_pd(p)
+#define bvStore(p, v)                  _mm512_store_pd((p), (v))
+#define bvSet1(s)                      _mm512_set1_pd(s)
+#define bvAdd(a, b)                    _mm512_add_pd((a), (b))
+#define bvSub(a, b)                    _mm512_sub_pd((a), (b))
+#define bvMul(a, b)                    _mm512_mul_pd((a), (b))
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define BATCH_VLEN                     4
+typedef __m256d batch_vec_T;
+#define bvLoad(p)                      _mm256_load_pd(p)
+#define bvStore(p, v)                  _mm256_store_pd((p), (v))
+#define bvSet1(s)                      _mm256_set1_pd(s)
+#define bvAdd(a, b)                    _mm256_add_pd((a), (b))
+#define bvSub(a, b)                    _mm256_sub_pd((a), (b))
+#define bvMul(a, b)                    _mm256_mul_pd((a), (b))
+#else
+#define BATCH_VLEN                     1
+typedef real_T batch_vec_T;
+#define bvLoad(p)                      (*(p))
+#define bvStore(p, v)                  (*(p) = (v))
+#define bvSet1(s)                      (s)
+#define bvAdd(a, b)                    ((a) + (b))
+#define bvSub(a, b)                    ((a) - (b))
+#define bvMul(a, b)                    ((a) * (b))
+#endif
+
+#endif                                 /* controller_vec_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -1,43 +1,395 @@
 
 
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
 #include <stddef.h>
 #include <stdio.h>            
+#include <stdlib.h>
+#include <string.h>
 #include "controller.h"                /* Model header file */
+#if defined(__linux__)
+#include <unistd.h>
+#include "rt_executive.h"
+#include "rt_monitor.h"
+#include "rt_persist.h"
+#include "rt_record.h"
+#include "rt_shm.h"
+#include "rt_telemetry.h"
+#endif
+
+#ifdef CONTROLLER_PROBES
+#include <signal.h>
+#include "rt_probe.h"
+
+/* Set by SIGUSR1; the probe histograms are dumped between steps */
+static volatile sig_atomic_t rtProbeDumpRequested = 0;
+static void rt_ProbeDumpHandler(int sig)
+{
+  (void)(sig);
+  rtProbeDumpRequested = 1;
+}
+
+static void rt_PollProbeDump(void)
+{
+  if (rtProbeDumpRequested) {
+    rtProbeDumpRequested = 0;
+    rtProbe_dump(stderr);
+  }
+}
+
+#endif
+
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+
+/* Per-rate overrun detection flags, safe against re-entry from a timer
+ * ISR/thread */
+static atomic_flag OverrunFlags[2] = { ATOMIC_FLAG_INIT, ATOMIC_FLAG_INIT };
+
+#define rtOverrunTestAndSet(i)         atomic_flag_test_and_set(&OverrunFlags[(i)])
+#define rtOverrunClear(i)              atomic_flag_clear(&OverrunFlags[(i)])
+#else
+
+static volatile boolean_T OverrunFlags[2] = { false, false };
+
+#define rtOverrunTestAndSet(i)         (OverrunFlags[(i)] ? true : ((OverrunFlags[(i)] = true), false))
+#define rtOverrunClear(i)              (OverrunFlags[(i)] = false)
+#endif
+
+static RT_MODEL_controller_T controller_M_;
+static RT_MODEL_controller_T *const controller_MPtr = &controller_M_;/* Real-time model */
+
+#if defined(__linux__)
+
+/* Telemetry ring fed by the base rate, NULL when logging is off */
+#define RT_TELEMETRY_CAPACITY          4096U
+
+static rtTelemetry_Record_T rtTelemetryStorage[RT_TELEMETRY_CAPACITY];
+static rtTelemetry_T rtTelemetryRing_;
+static rtTelemetry_T *rtTelemetryRing = NULL;
+
+/* Input/output recorder, NULL when not recording */
+#define RT_RECORD_DEFAULT_CAPACITY     (1048576ULL)
+
+/* Entries beyond -n for the parameter sets that take effect during the run */
+#define RT_RECORD_PARAMS_CAPACITY      (4096ULL)
+
+static rtRecord_T rtRecorder;
+static rtRecord_T *rtRecording = NULL;
+
+/* Latest-value view for low-rate readers, NULL when not monitored */
+static rtMonitor_T rtMonitorStorage;
+static rtMonitor_T *rtMonitorView = NULL;
 
+/* Persistent state image for warm restarts, NULL when off */
+static rtPersist_T rtPersistImage;
+static rtPersist_T *rtPersist = NULL;
 
+/* Shared-memory sensor/actuator transport, NULL when not attached */
+static rtShm_Region_T *rtShmRegion = NULL;
+static rtShm_SensorPayload_T rtShmSensors;
+static unsigned long long rtShmSensorSeq = 0ULL;
+static uint32_T rtShmStaleFrames = 0UL;
+static uint32_T rtShmFailedReads = 0UL;
+
+/* Latest sensor frame into the model inports; on a failed read the
+ * previous inputs are kept */
+static void rt_ShmReadSensors(RT_MODEL_controller_T *const controller_M)
+{
+  unsigned long long seq = rtShm_readSensors(rtShmRegion, &rtShmSensors);
+  if (seq == 0ULL) {
+    rtShmFailedReads++;
+    return;
+  }
+
+  if (seq == rtShmSensorSeq) {
+    rtShmStaleFrames++;
+  }
+
+  rtShmSensorSeq = seq;
+  *rtmGetU(controller_M) = rtShmSensors.U;
+}
+
+#endif
+
+/*
+ * Associating rt_OneStep with a real-time clock or interrupt service routine
+ * is what makes the generated code "real-time".  The function rt_OneStep is
+ * always associated with the base rate of the model.  Subrates are managed
+ * by the base rate from inside the generated code.  Enabling/disabling
+ * interrupts and floating point context switches are target specific.  This
+ * example code indicates where these should take place relative to executing
+ * the generated code step function.  Overrun behavior should be tailored to
+ * your application needs.  This example simply sets an error status in the
+ * real-time model and returns from rt_OneStep.
+ *
+ * Rates are scheduled rate-monotonically: the base rate (inner loop) runs
+ * first and the outer attitude loop runs after it in the ticks where it is
+ * due, so its output reaches the inner loop one base tick later.
  */
-void rt_OneStep(void);
-void rt_OneStep(void)
+void rt_OneStep(RT_MODEL_controller_T *const controller_M);
+void rt_OneStep(RT_MODEL_controller_T *const controller_M)
 {
-  static boolean_T OverrunFlag = false;
+  boolean_T eventFlags[2] = { false, false };
+  int_T i;
+
+#if defined(__linux__)
+
+  rtTelemetry_Record_T rec;
+
+#endif
 
   /* Disable interrupts here */
 
-  /* Check for overrun */
-  if (OverrunFlag) {
+  /* Check base rate for overrun */
+  if (rtOverrunTestAndSet(0)) {
     rtmSetErrorStatus(controller_M, "Overrun");
     return;
   }
 
-  OverrunFlag = true;
-
   /* Save FPU context here (if necessary) */
   /* Re-enable timer or interrupt here */
-  /* Set model inputs here */
 
-  /* Step the model */
-  controller_step();
+  /*
+   * For a bare-board target (i.e., no operating system), the
+   * following code checks whether any subrate overruns,
+   * and also sets the rates that need to run this time step.
+   */
+  controller_SetEventsForThisBaseStep(controller_M, eventFlags);
+
+  /* Set model inputs associated with base rate here */
+#if defined(__linux__)
+
+  if (rtShmRegion != NULL) {
+    rt_ShmReadSensors(controller_M);
+  }
+
+  if (rtTelemetryRing != NULL) {
+    rtTelemetry_captureStates(controller_M, &rec);
+  }
+
+#endif
+
+  /* Step the model for base rate */
+  controller_step0(controller_M);
 
   /* Get model outputs here */
+#if defined(__linux__)
+
+  /* Publish the gimbal commands; the write section covers the copy only,
+   * not the solver step */
+  if (rtShmRegion != NULL) {
+    unsigned long long actuatorSeq = rtShm_writeBegin
+      (&rtShmRegion->actuator.seq);
+    rtShmRegion->actuator.data.Y = *rtmGetY(controller_M);
+    rtShmRegion->actuator.data.stampNs = rtShm_nowNs();
+    rtShmRegion->actuator.data.sensorStampNs = rtShmSensors.stampNs;
+    rtShmRegion->actuator.data.sensorSeq = rtShmSensorSeq;
+    rtShm_writeEnd(&rtShmRegion->actuator.seq, actuatorSeq);
+  }
+
+  if (rtTelemetryRing != NULL) {
+    rtTelemetry_captureOutputs(controller_M, &rec);
+    (void) rtTelemetry_publish(rtTelemetryRing, &rec);
+  }
+
+#endif
+
+  /* Indicate task for base rate complete */
+  rtOverrunClear(0);
+
+  /* Step the model for any subrate */
+  for (i = 1; i < 2; i++) {
+    /* If task "i" is running, don't run any lower priority task */
+    if (!eventFlags[i]) {
+      continue;
+    }
+
+    if (rtOverrunTestAndSet(i)) {
+      rtmSetErrorStatus(controller_M, "Overrun");
+      return;
+    }
+
+    /* Set model inputs associated with subrates here */
+
+    /* Step the model for subrate "i" */
+    switch (i) {
+     case 1 :
+      controller_step1(controller_M);
+
+      /* Get model outputs here */
+      break;
 
-  /* Indicate task complete */
-  OverrunFlag = false;
+     default :
+      break;
+    }
+
+    /* Indicate task complete for sample time "i" */
+    rtOverrunClear(i);
+  }
+
+#if defined(__linux__)
+
+  if (rtRecording != NULL) {
+    rtRecord_step(rtRecording, controller_M);
+  }
+
+  if (rtPersist != NULL) {
+    rtPersist_save(rtPersist, controller_M);
+  }
+
+  if (rtMonitorView != NULL) {
+    rtMonitor_publish(rtMonitorView, controller_M);
+  }
+
+#endif
 
   /* Disable interrupts here */
   /* Restore FPU context here (if necessary) */
   /* Enable interrupts here */
 }
 
+#if defined(__linux__)
+
+/* Executive callback: one base-rate step, false once the model stops */
+static boolean_T rt_ExecStep(void *ctx)
+{
+  RT_MODEL_controller_T *const controller_M = (RT_MODEL_controller_T *)ctx;
+  rt_OneStep(controller_M);
+
+#ifdef CONTROLLER_PROBES
+
+  rt_PollProbeDump();
+
+#endif
+  return (boolean_T)(rtmGetErrorStatus(controller_M) == (NULL) &&
+                     !rtmGetStopRequested(controller_M));
+}
+
+/* Detaches the ring from the base rate and flushes the logger */
+static void rt_StopTelemetry(rtTelemetry_Logger_T *logger)
+{
+  if (rtTelemetryRing == NULL) {
+    return;
+  }
+
+  rtTelemetryRing = NULL;
+  if (rtTelemetry_stopLogger(logger) != RT_TELEMETRY_OK) {
+    (void) fprintf(stderr, "telemetry write error\n");
+  }
+
+  (void) fprintf(stderr, "telemetry: %llu records written, %llu dropped\n",
+                 atomic_load(&logger->written), rtTelemetry_dropped
+                 (&rtTelemetryRing_));
+}
+
+/* Closes the recording */
+static void rt_StopRecording(void)
+{
+  unsigned long long steps;
+  unsigned long long dropped;
+  if (rtRecording == NULL) {
+    return;
+  }
+
+  steps = rtRecording->header->numSteps;
+  dropped = rtRecording->header->dropped;
+  if (rtRecord_stop(rtRecording) != RT_RECORD_OK) {
+    (void) fprintf(stderr, "recording write error\n");
+  }
+
+  (void) fprintf(stderr, "recording: %llu steps, %llu entries, %llu dropped\n",
+                 steps, rtRecording->count, dropped);
+  rtRecording = NULL;
+}
+
+/* Stops the monitor reader; the base rate keeps publishing harmlessly */
+static void rt_StopMonitor(rtMonitor_Printer_T *printer)
+{
+  if (rtMonitorView == NULL) {
+    return;
+  }
+
+  rtMonitor_stopPrinter(printer);
+  rtMonitorView = NULL;
+  (void) fprintf(stderr, "monitor: %llu samples, %llu failed reads\n",
+                 atomic_load(&printer->samples), atomic_load
+                 (&printer->failedReads));
+}
+
+/* Writes back and closes the state image */
+static void rt_StopPersist(void)
+{
+  if (rtPersist == NULL) {
+    return;
+  }
+
+  if (rtPersist_close(rtPersist) != RT_PERSIST_OK) {
+    (void) fprintf(stderr, "state image write error\n");
+  }
+
+  rtPersist = NULL;
+}
+
+/* Detaches the model from shared memory */
+static void rt_StopShm(void)
+{
+  if (rtShmRegion == NULL) {
+    return;
+  }
+
+  rtShm_close(rtShmRegion);
+  rtShmRegion = NULL;
+  (void) fprintf(stderr, "shm: %lu stale sensor frames, %lu failed reads\n",
+                 rtShmStaleFrames, rtShmFailedReads);
+}
+
+/* Solver names accepted by -S, in controller_SolverMode_T order */
+static const char_T *const rtSolverNames[] = { "ode4", "ode4-fused", "zoh",
+  "tustin", "ros2", "ode45" };
+
+/* Reports the work the solver did */
+static void rt_PrintSolverStats(const RT_MODEL_controller_T *const
+  controller_M)
+{
+  const controller_SolverStats_T *s = controller_GetSolverStats(controller_M);
+  (void) fprintf(stderr, "solver %s: %llu steps, %llu rejected, %llu "
+                 "derivative evaluations, %llu Jacobians, %llu zero crossings\n",
+                 rtSolverNames[controller_M->solverMode], s->steps, s->rejected,
+                 s->derivEvals, s->jacobianEvals, s->zeroCrossings);
+}
+
+static void rt_Usage(const char *prog)
+{
+  (void) fprintf(stderr,
+                 "usage: %s [-r] [-p prio] [-c cpu] [-o skip|catchup|abort] [-t] [-n cycles]\n"
+                 "          [-l telemetry.bin|telemetry.csv] [-b step] [-s shm]\n"
+                 "          [-R recording] [-P state] [-m rateHz]\n"
+                 "          [-S ode4|ode4-fused|zoh|tustin|ros2|ode45]\n"
+                 "  -r  run in real time at the model base rate\n"
+                 "  -p  SCHED_FIFO priority (1-99)\n"
+                 "  -c  pin to CPU\n"
+                 "  -o  overrun policy (default skip)\n"
+                 "  -t  use timerfd instead of clock_nanosleep\n"
+                 "  -n  number of base-rate cycles, 0 = until stopped (also without -r)\n"
+                 "  -l  log base-rate telemetry, CSV if the name ends in .csv\n"
+                 "  -b  base step size in seconds\n"
+                 "  -s  read sensors from and write actuators to the named shared\n"
+                 "      memory object (e.g. " RT_SHM_DEFAULT_NAME ")\n"
+                 "  -R  record inputs and outputs of every step for replay_main\n"
+                 "  -P  keep the model state in the named file at every step and\n"
+                 "      resume from it when it holds a valid state, whose step\n"
+                 "      size and solver -b and -S must then match\n"
+                 "  -m  print the latest states and outputs at rateHz from a\n"
+                 "      monitor thread\n"
+                 "  -S  solver for the continuous states (default ode4)\n",
+                 prog);
+}
+
+#endif
+
 /*
  * The example main function illustrates what is required by your
  * application code to initialize, execute, and terminate the generated code.
@@ -46,23 +398,301 @@ void rt_OneStep(void)
  */
 int_T main(int_T argc, const char *argv[])
 {
+  RT_MODEL_controller_T *const controller_M = controller_MPtr;
+
+#ifdef CONTROLLER_PROBES
+
+  (void) signal(SIGUSR1, &rt_ProbeDumpHandler);
+
+#endif
+
+#if defined(__linux__)
+
+  rtExecConfig_T cfg;
+  rtExecStats_T stats;
+  rtTelemetry_Logger_T logger;
+  const char_T *telemetryPath = NULL;
+  const char_T *shmName = NULL;
+  const char_T *recordPath = NULL;
+  const char_T *persistPath = NULL;
+  rtMonitor_Printer_T monitor;
+  real_T monitorRate = 0.0;
+  int_T solverMode = -1;
+  time_T baseStep = 0.0;
+  boolean_T realTime = false;
+  uint32_T cycles = 0UL;
+  int opt;
+
+  /* Initialize model */
+  controller_initialize(controller_M);
+  rtExec_defaultConfig(&cfg, controller_M->Timing.stepSize0);
+  while ((opt = getopt(argc, (char *const *)argv, "rp:c:o:tn:l:b:s:R:P:m:S:")) != -1) {
+    switch (opt) {
+     case 'r':
+      realTime = true;
+      break;
+
+     case 'p':
+      cfg.priority = atoi(optarg);
+      break;
+
+     case 'c':
+      cfg.cpu = atoi(optarg);
+      break;
+
+     case 'o':
+      if (strcmp(optarg, "skip") == 0) {
+        cfg.overrunPolicy = RT_EXEC_OVERRUN_SKIP;
+      } else if (strcmp(optarg, "catchup") == 0) {
+        cfg.overrunPolicy = RT_EXEC_OVERRUN_CATCH_UP;
+      } else if (strcmp(optarg, "abort") == 0) {
+        cfg.overrunPolicy = RT_EXEC_OVERRUN_ABORT;
+      } else {
+        rt_Usage(argv[0]);
+        return 1;
+      }
+      break;
+
+     case 't':
+      cfg.timer = RT_EXEC_TIMER_TIMERFD;
+      break;
+
+     case 'n':
+      cfg.maxCycles = (uint32_T)strtoul(optarg, NULL, 10);
+      break;
+
+     case 'l':
+      telemetryPath = optarg;
+      break;
+
+     case 'b':
+      baseStep = strtod(optarg, NULL);
+      if (!(baseStep > 0.0)) {
+        rt_Usage(argv[0]);
+        return 1;
+      }
+      break;
+
+     case 's':
+      shmName = optarg;
+      break;
+
+     case 'R':
+      recordPath = optarg;
+      break;
+
+     case 'P':
+      persistPath = optarg;
+      break;
+
+     case 'S':
+      for (solverMode = (int_T)(sizeof(rtSolverNames) / sizeof(rtSolverNames[0]))
+           - 1; solverMode >= 0; solverMode--) {
+        if (strcmp(optarg, rtSolverNames[solverMode]) == 0) {
+          break;
+        }
+      }
+
+      if (solverMode < 0) {
+        rt_Usage(argv[0]);
+        return 1;
+      }
+      break;
+
+     case 'm':
+      monitorRate = strtod(optarg, NULL);
+      if (!(monitorRate > 0.0)) {
+        rt_Usage(argv[0]);
+        return 1;
+      }
+      break;
+
+     default:
+      rt_Usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (baseStep > 0.0) {
+    controller_SetRates(controller_M, baseStep, CONTROLLER_OUTER_RATE_RATIO);
+    cfg.period = baseStep;
+  }
+
+  if (solverMode >= 0) {
+    controller_SetSolverMode(controller_M, (controller_SolverMode_T)solverMode);
+  }
+
+  /* Warm start */
+  if (persistPath != NULL) {
+    int_T status;
+    if (rtPersist_open(&rtPersistImage, persistPath) != RT_PERSIST_OK) {
+      (void) fprintf(stderr, "cannot open state image %s\n", persistPath);
+      return 1;
+    }
+
+    rtPersist = &rtPersistImage;
+    status = rtPersist_warmStart(rtPersist, controller_M);
+    if (status == RT_PERSIST_OK) {
+      /* The image carries its own rates and solver, -b and -S may only
+       * repeat them */
+      if (((baseStep > 0.0) && (baseStep != controller_M->Timing.stepSize0))
+          || ((solverMode >= 0) && ((controller_SolverMode_T)solverMode !=
+            controller_M->solverMode))) {
+        (void) fprintf(stderr,
+                       "state image %s was saved with -S %s -b %g, which -S/-b contradict\n",
+                       persistPath, rtSolverNames[controller_M->solverMode],
+                       controller_M->Timing.stepSize0);
+        rt_StopPersist();
+        return 1;
+      }
+
+      cfg.period = controller_M->Timing.stepSize0;
+      (void) fprintf(stderr, "warm start at t = %g s (save %llu)\n",
+                     controller_M->Timing.tArray[0], rtPersist->seq);
+    }
+  }
+
+  if (shmName != NULL) {
+    if (rtShm_open(shmName, &rtShmRegion) != RT_SHM_OK) {
+      (void) fprintf(stderr, "cannot attach to shared memory %s\n", shmName);
+      rt_StopPersist();
+      return 1;
+    }
+  }
+
+  if (recordPath != NULL) {
+    if (rtRecord_start(&rtRecorder, recordPath, (cfg.maxCycles > 0UL) ?
+                       (unsigned long long)cfg.maxCycles +
+                       RT_RECORD_PARAMS_CAPACITY :
+                       RT_RECORD_DEFAULT_CAPACITY, controller_M) !=
+        RT_RECORD_OK) {
+      (void) fprintf(stderr, "cannot record to %s\n", recordPath);
+      rt_StopShm();
+      rt_StopPersist();
+      return 1;
+    }
+
+    rtRecording = &rtRecorder;
+  }
+
+  if (telemetryPath != NULL) {
+    size_t len = strlen(telemetryPath);
+    rtTelemetry_Format_T format = ((len >= 4U) && (strcmp(&telemetryPath[len -
+      4U], ".csv") == 0)) ? RT_TELEMETRY_FORMAT_CSV : RT_TELEMETRY_FORMAT_BINARY;
+    (void) rtTelemetry_init(&rtTelemetryRing_, rtTelemetryStorage,
+      RT_TELEMETRY_CAPACITY);
+    if (rtTelemetry_startLogger(&logger, &rtTelemetryRing_, telemetryPath,
+         format) != RT_TELEMETRY_OK) {
+      (void) fprintf(stderr, "cannot log telemetry to %s\n", telemetryPath);
+      rt_StopRecording();
+      rt_StopShm();
+      rt_StopPersist();
+      return 1;
+    }
+
+    rtTelemetryRing = &rtTelemetryRing_;
+  }
+
+  if (monitorRate > 0.0) {
+    rtMonitor_init(&rtMonitorStorage);
+    if (rtMonitor_startPrinter(&monitor, &rtMonitorStorage, monitorRate,
+         stderr) != RT_MONITOR_OK) {
+      (void) fprintf(stderr, "cannot start the monitor\n");
+      rt_StopTelemetry(&logger);
+      rt_StopRecording();
+      rt_StopShm();
+      rt_StopPersist();
+      return 1;
+    }
+
+    rtMonitorView = &rtMonitorStorage;
+  }
+
+  if (realTime) {
+    /* Attach rt_OneStep to the periodic executive at the base rate */
+    memset(&stats, 0, sizeof(stats));
+    if (rtExec_run(&cfg, &rt_ExecStep, (void *)controller_M, &stats) ==
+        RT_EXEC_ERR_OVERRUN) {
+      rtmSetErrorStatus(controller_M, "Overrun");
+    }
+
+    rtExec_printStats(&stats);
+    rt_PrintSolverStats(controller_M);
+    if (rtmGetErrorStatus(controller_M) != (NULL)) {
+      (void) fprintf(stderr, "%s\n", rtmGetErrorStatus(controller_M));
+    }
+
+    rt_StopMonitor(&monitor);
+    rt_StopTelemetry(&logger);
+    rt_StopRecording();
+    rt_StopShm();
+    rt_StopPersist();
+
+#ifdef CONTROLLER_PROBES
+
+    rtProbe_dump(stderr);
+
+#endif
+
+    /* Terminate model */
+    controller_terminate(controller_M);
+    return (rtmGetErrorStatus(controller_M) == (NULL)) ? 0 : 1;
+  }
+
+#else
+
   /* Unused arguments */
   (void)(argc);
   (void)(argv);
 
   /* Initialize model */
-  controller_initialize();
+  controller_initialize(controller_M);
+
+#endif
 
   /* Simulating the model step behavior (in non real-time) to
    *  simulate model behavior at stop time.
    */
   while (rtmGetErrorStatus(controller_M) == (NULL)&& !rtmGetStopRequested
          (controller_M)) {
-    rt_OneStep();
+    rt_OneStep(controller_M);
+
+#ifdef CONTROLLER_PROBES
+
+    rt_PollProbeDump();
+
+#endif
+
+#if defined(__linux__)
+
+    /* Counted here, a warm-started model does not begin at tick 0 */
+    if ((cfg.maxCycles > 0UL) && (++cycles >= cfg.maxCycles)) {
+      break;
+    }
+
+#endif
+
   }
 
+#if defined(__linux__)
+
+  rt_PrintSolverStats(controller_M);
+  rt_StopMonitor(&monitor);
+  rt_StopTelemetry(&logger);
+  rt_StopRecording();
+  rt_StopShm();
+  rt_StopPersist();
+
+#endif
+
+#ifdef CONTROLLER_PROBES
+
+  rtProbe_dump(stderr);
+
+#endif
+
   /* Terminate model */
-  controller_terminate();
+  controller_terminate(controller_M);
   return 0;
 }
 
@@ -0,0 +1,414 @@
+
+#define _POSIX_C_SOURCE                200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mc_campaign.h"
+#include "mc_rng.h"
+
+#define MC_CHECKPOINT_MAGIC            "TVCMC02"
+
+/* Checkpoint file header; followed by numDone (index, mcRun_Result_T) pairs */
+typedef struct {
+  char_T magic[8];
+  unsigned long long campaignHash;
+  long long numRuns;
+  long long numDone;
+  long long recordSize;
+} mcCheckpoint_Header_T;
+
+/*
+ * Work-stealing range of one worker: [begin, end) packed into one word so
+ * that the owner (taking from the front) and thieves (taking the back half)
+ * both update it with a single compare-and-swap.
+ */
+typedef struct {
+  _Atomic unsigned long long range;
+  char_T pad[56];                      /* Keep ranges on separate cache lines */
+} mcWorker_Range_T;
+
+typedef struct mcShared_tag mcShared_T;
+
+typedef struct {
+  mcShared_T *shared;
+  int_T id;
+  pthread_t thread;
+} mcWorker_T;
+
+struct mcShared_tag {
+  const mcCampaign_Config_T *cfg;
+  mcRun_Result_T *results;
+  atomic_uchar *done;
+  mcWorker_Range_T *ranges;
+  int_T numWorkers;
+  atomic_int finishedWorkers;
+  atomic_long completedRuns;
+};
+
+#define MC_PACK(b, e)                  ((((unsigned long long)(b)) << 32) | (unsigned long long)(e))
+#define MC_BEGIN(r)                    ((int32_T)((r) >> 32))
+#define MC_END(r)                      ((int32_T)((r) & 0xFFFFFFFFULL))
+
+/* FNV-1a over the fields that define the campaign's results */
+static unsigned long long mcCampaign_hash(const mcCampaign_Config_T *cfg)
+{
+  const real_T fields[] = {
+    cfg->base.plant.mass, cfg->base.plant.inertia, cfg->base.plant.thrustArm,
+    cfg->base.plant.gravityArm, cfg->base.plant.damping,
+    cfg->base.plant.gimbalTimeConstant, cfg->base.plant.gimbalLimit,
+    cfg->base.plant.gravity, cfg->base.gains.Kp_att, cfg->base.gains.Kp_rate,
+    cfg->base.gains.Ki_rate, cfg->base.gains.Kd_rate, cfg->base.gains.N,
+    cfg->base.stepSize, (real_T)cfg->base.outerRateRatio, (real_T)
+    cfg->base.solverMode, (real_T)cfg->base.plantSubsteps, cfg->base.duration,
+    cfg->base.setpointPitch, cfg->base.setpointRoll, cfg->base.settlingBand,
+    cfg->base.divergenceLimit, (real_T)cfg->numRuns, cfg->maxInitialTilt,
+    cfg->gainSpread, cfg->disturbanceStd, cfg->angleNoiseStd,
+    cfg->rateNoiseStd, (real_T)sizeof(mcRun_Result_T)
+  };
+
+  const unsigned char *p = (const unsigned char *)fields;
+  unsigned long long h = 1469598103934665603ULL ^ cfg->seed;
+  size_t i;
+  for (i = 0; i < sizeof(fields); i++) {
+    h = (h ^ p[i]) * 1099511628211ULL;
+  }
+
+  return h;
+}
+
+static real_T mcCampaign_noise(void *ctx)
+{
+  return mcRng_normal((mcRng_T *)ctx);
+}
+
+void mcCampaign_defaultConfig(mcCampaign_Config_T *cfg)
+{
+  (void) memset((void *)cfg, 0, sizeof(mcCampaign_Config_T));
+  closedLoop_defaultConfig(&cfg->base);
+  cfg->seed = 20251029ULL;
+  cfg->numRuns = 1000;
+  cfg->maxInitialTilt = 0.3;
+  cfg->gainSpread = 0.2;
+  cfg->disturbanceStd = 0.05;
+  cfg->angleNoiseStd = 0.002;
+  cfg->rateNoiseStd = 0.01;
+}
+
+void mcCampaign_defaultOptions(mcCampaign_Options_T *opt)
+{
+  opt->numThreads = 0;
+  opt->checkpointPath = NULL;
+  opt->checkpointInterval = 10.0;
+  opt->verbose = false;
+}
+
+void mcCampaign_evalRun(const mcCampaign_Config_T *cfg, int32_T index,
+  mcRun_Result_T *out)
+{
+  closedLoop_Config_T run = cfg->base;
+  mcRng_T rng;
+  mcRng_init(&rng, cfg->seed, (unsigned long long)index);
+
+  /* Randomized scenario; draw order defines the campaign */
+  out->initialPitch = mcRng_range(&rng, -cfg->maxInitialTilt,
+    cfg->maxInitialTilt);
+  out->initialRoll = mcRng_range(&rng, -cfg->maxInitialTilt,
+    cfg->maxInitialTilt);
+  out->gainScale[0] = mcRng_range(&rng, 1.0 - cfg->gainSpread, 1.0 +
+    cfg->gainSpread);
+  out->gainScale[1] = mcRng_range(&rng, 1.0 - cfg->gainSpread, 1.0 +
+    cfg->gainSpread);
+  out->gainScale[2] = mcRng_range(&rng, 1.0 - cfg->gainSpread, 1.0 +
+    cfg->gainSpread);
+  out->gainScale[3] = mcRng_range(&rng, 1.0 - cfg->gainSpread, 1.0 +
+    cfg->gainSpread);
+  out->disturbancePitch = cfg->disturbanceStd * mcRng_normal(&rng);
+  out->disturbanceRoll = cfg->disturbanceStd * mcRng_normal(&rng);
+  out->disturbanceTime = mcRng_range(&rng, 0.3, 0.7) * cfg->base.duration;
+  run.initialPitch = out->initialPitch;
+  run.initialRoll = out->initialRoll;
+  run.gains.Kp_att *= out->gainScale[0];
+  run.gains.Kp_rate *= out->gainScale[1];
+  run.gains.Ki_rate *= out->gainScale[2];
+  run.gains.Kd_rate *= out->gainScale[3];
+  run.disturbancePitch = out->disturbancePitch;
+  run.disturbanceRoll = out->disturbanceRoll;
+  run.disturbanceTime = out->disturbanceTime;
+  run.angleNoiseStd = cfg->angleNoiseStd;
+  run.rateNoiseStd = cfg->rateNoiseStd;
+
+  /* Sensor noise continues the same stream */
+  closedLoop_run(&run, &mcCampaign_noise, (void *)&rng, 0.0, &out->result);
+}
+
+/* Owner side: takes the next index from the front of its own range */
+static int32_T mcWorker_take(mcWorker_Range_T *r)
+{
+  unsigned long long cur = atomic_load(&r->range);
+  while (MC_BEGIN(cur) < MC_END(cur)) {
+    if (atomic_compare_exchange_weak(&r->range, &cur, MC_PACK(MC_BEGIN(cur) + 1,
+          MC_END(cur)))) {
+      return MC_BEGIN(cur);
+    }
+  }
+
+  return -1;
+}
+
+/* Thief side: moves the back half of some victim's range into 'self' */
+static boolean_T mcWorker_steal(mcShared_T *sh, int_T self)
+{
+  int_T n = sh->numWorkers;
+  int_T k;
+  for (k = 1; k < n; k++) {
+    mcWorker_Range_T *victim = &sh->ranges[(self + k) % n];
+    unsigned long long cur = atomic_load(&victim->range);
+    while (MC_END(cur) - MC_BEGIN(cur) > 0) {
+      int32_T b = MC_BEGIN(cur);
+      int32_T e = MC_END(cur);
+      int32_T mid = b + (e - b) / 2;
+      if (atomic_compare_exchange_weak(&victim->range, &cur, MC_PACK(b, mid))) {
+        atomic_store(&sh->ranges[self].range, MC_PACK(mid, e));
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+static void *mcWorker_main(void *arg)
+{
+  mcWorker_T *w = (mcWorker_T *)arg;
+  mcShared_T *sh = w->shared;
+  for (;;) {
+    int32_T i = mcWorker_take(&sh->ranges[w->id]);
+    if (i < 0) {
+      if (!mcWorker_steal(sh, w->id)) {
+        break;
+      }
+
+      continue;
+    }
+
+    if (atomic_load_explicit(&sh->done[i], memory_order_acquire) != 0U) {
+      continue;
+    }
+
+    mcCampaign_evalRun(sh->cfg, i, &sh->results[i]);
+    atomic_store_explicit(&sh->done[i], 1U, memory_order_release);
+    (void) atomic_fetch_add(&sh->completedRuns, 1L);
+  }
+
+  (void) atomic_fetch_add(&sh->finishedWorkers, 1);
+  return NULL;
+}
+
+/* Writes all completed runs atomically (temporary file + rename) */
+static int_T mcCheckpoint_write(const char_T *path, const mcCampaign_Config_T
+  *cfg, const mcRun_Result_T *results, atomic_uchar *done)
+{
+  mcCheckpoint_Header_T hdr;
+  char_T tmp[4096];
+  FILE *f;
+  long long i;
+  int_T ok = 1;
+  if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+    return MC_ERR_CHECKPOINT_IO;
+  }
+
+  f = fopen(tmp, "wb");
+  if (f == NULL) {
+    return MC_ERR_CHECKPOINT_IO;
+  }
+
+  (void) memset(&hdr, 0, sizeof(hdr));
+  (void) memcpy(hdr.magic, MC_CHECKPOINT_MAGIC, sizeof(MC_CHECKPOINT_MAGIC));
+  hdr.campaignHash = mcCampaign_hash(cfg);
+  hdr.numRuns = cfg->numRuns;
+  hdr.recordSize = (long long)sizeof(mcRun_Result_T);
+  ok &= (fwrite(&hdr, sizeof(hdr), 1, f) == 1U);
+  for (i = 0; (i < cfg->numRuns) && ok; i++) {
+    if (atomic_load_explicit(&done[i], memory_order_acquire) != 0U) {
+      ok &= (fwrite(&i, sizeof(i), 1, f) == 1U);
+      ok &= (fwrite(&results[i], sizeof(mcRun_Result_T), 1, f) == 1U);
+      hdr.numDone++;
+    }
+  }
+
+  /* Patch the record count into the header */
+  ok &= (fseek(f, 0L, SEEK_SET) == 0);
+  ok &= (fwrite(&hdr, sizeof(hdr), 1, f) == 1U);
+  ok &= (fflush(f) == 0);
+  ok &= (fsync(fileno(f)) == 0);
+  ok &= (fclose(f) == 0);
+  if (!ok || (rename(tmp, path) != 0)) {
+    (void) remove(tmp);
+    return MC_ERR_CHECKPOINT_IO;
+  }
+
+  return MC_OK;
+}
+
+/* Restores completed runs; a missing file is not an error */
+static int_T mcCheckpoint_read(const char_T *path, const mcCampaign_Config_T
+  *cfg, mcRun_Result_T *results, atomic_uchar *done, int32_T *numRestored)
+{
+  mcCheckpoint_Header_T hdr;
+  FILE *f = fopen(path, "rb");
+  long long k;
+  *numRestored = 0;
+  if (f == NULL) {
+    return MC_OK;
+  }
+
+  if ((fread(&hdr, sizeof(hdr), 1, f) != 1U) || (memcmp(hdr.magic,
+        MC_CHECKPOINT_MAGIC, sizeof(MC_CHECKPOINT_MAGIC)) != 0)) {
+    (void) fclose(f);
+    return MC_ERR_CHECKPOINT_IO;
+  }
+
+  if ((hdr.campaignHash != mcCampaign_hash(cfg)) || (hdr.numRuns !=
+       cfg->numRuns) || (hdr.recordSize != (long long)sizeof(mcRun_Result_T))) {
+    (void) fclose(f);
+    return MC_ERR_CHECKPOINT_MISMATCH;
+  }
+
+  for (k = 0; k < hdr.numDone; k++) {
+    long long i;
+    if ((fread(&i, sizeof(i), 1, f) != 1U) || (i < 0) || (i >= cfg->numRuns) ||
+        (fread(&results[i], sizeof(mcRun_Result_T), 1, f) != 1U)) {
+      (void) fclose(f);
+      return MC_ERR_CHECKPOINT_IO;
+    }
+
+    atomic_store(&done[i], 1U);
+    (*numRestored)++;
+  }
+
+  (void) fclose(f);
+  return MC_OK;
+}
+
+static real_T mcCampaign_now(void)
+{
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (real_T)ts.tv_sec + 1.0E-9 * (real_T)ts.tv_nsec;
+}
+
+int_T mcCampaign_run(const mcCampaign_Config_T *cfg, const mcCampaign_Options_T
+                     *opt, mcRun_Result_T *results, int32_T *numResumed)
+{
+  mcShared_T sh;
+  mcWorker_T *workers;
+  int32_T restored = 0;
+  int_T numThreads = opt->numThreads;
+  int_T status = MC_OK;
+  int_T started = 0;
+  int_T w;
+  real_T lastCheckpoint;
+  if (numThreads <= 0) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    numThreads = (ncpu > 0L) ? (int_T)ncpu : 1;
+  }
+
+  if (numThreads > cfg->numRuns) {
+    numThreads = (cfg->numRuns > 0) ? (int_T)cfg->numRuns : 1;
+  }
+
+  (void) memset(&sh, 0, sizeof(sh));
+  sh.cfg = cfg;
+  sh.results = results;
+  sh.numWorkers = numThreads;
+  sh.done = (atomic_uchar *)calloc((size_t)cfg->numRuns + 1U, sizeof
+    (atomic_uchar));
+  sh.ranges = (mcWorker_Range_T *)calloc((size_t)numThreads, sizeof
+    (mcWorker_Range_T));
+  workers = (mcWorker_T *)calloc((size_t)numThreads, sizeof(mcWorker_T));
+  if ((sh.done == NULL) || (sh.ranges == NULL) || (workers == NULL)) {
+    free((void *)sh.done);
+    free(sh.ranges);
+    free(workers);
+    return MC_ERR_ALLOC;
+  }
+
+  atomic_init(&sh.finishedWorkers, 0);
+  atomic_init(&sh.completedRuns, 0L);
+  if (opt->checkpointPath != NULL) {
+    status = mcCheckpoint_read(opt->checkpointPath, cfg, results, sh.done,
+      &restored);
+  }
+
+  if (status == MC_OK) {
+    /* Contiguous initial split; stealing rebalances */
+    for (w = 0; w < numThreads; w++) {
+      int32_T b = (int32_T)(((long long)cfg->numRuns * w) / numThreads);
+      int32_T e = (int32_T)(((long long)cfg->numRuns * (w + 1)) / numThreads);
+      atomic_init(&sh.ranges[w].range, MC_PACK(b, e));
+      workers[w].shared = &sh;
+      workers[w].id = w;
+    }
+
+    for (w = 0; w < numThreads; w++) {
+      if (pthread_create(&workers[w].thread, NULL, &mcWorker_main, &workers[w])
+          != 0) {
+        status = MC_ERR_THREAD;
+        break;
+      }
+
+      started++;
+    }
+
+    /* Unstarted workers' ranges are stolen by the others */
+    (void) atomic_fetch_add(&sh.finishedWorkers, numThreads - started);
+
+    /* Monitor: periodic checkpoints and progress */
+    lastCheckpoint = mcCampaign_now();
+    while ((started > 0) && (atomic_load(&sh.finishedWorkers) < numThreads)) {
+      struct timespec nap = { 0, 50000000L };
+      (void) nanosleep(&nap, NULL);
+      if ((opt->checkpointPath != NULL) && (mcCampaign_now() - lastCheckpoint >=
+           opt->checkpointInterval)) {
+        if (mcCheckpoint_write(opt->checkpointPath, cfg, results, sh.done) !=
+            MC_OK) {
+          (void) fprintf(stderr, "mc_campaign: checkpoint write failed\n");
+        }
+
+        lastCheckpoint = mcCampaign_now();
+        if (opt->verbose) {
+          (void) fprintf(stderr, "mc_campaign: %ld/%ld runs\n", (long)restored +
+                         atomic_load(&sh.completedRuns), (long)cfg->numRuns);
+        }
+      }
+    }
+
+    for (w = 0; w < started; w++) {
+      (void) pthread_join(workers[w].thread, NULL);
+    }
+
+    if ((status == MC_OK) && (opt->checkpointPath != NULL)) {
+      status = mcCheckpoint_write(opt->checkpointPath, cfg, results, sh.done);
+    }
+  }
+
+  if (numResumed != NULL) {
+    *numResumed = restored;
+  }
+
+  free((void *)sh.done);
+  free(sh.ranges);
+  free(workers);
+  return status;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,81 @@
+
+
+#ifndef mc_campaign_h_
+#define mc_campaign_h_
+#include "rtwtypes.h"
+#include "closed_loop.h"
+
+/*
+ * Parallel Monte Carlo campaign of randomized closed-loop runs.
+ *
+ * Run i draws its initial tilt, gain perturbations, disturbance and sensor
+ * noise from its own counter-based random stream (seed, i), so every run's
+ * result is independent of the thread count and of the order in which runs
+ * are executed.  Runs are spread over a pool of worker threads that steal
+ * halves of each other's remaining index ranges.  Completed runs are
+ * periodically written to a checkpoint file, from which an interrupted
+ * campaign resumes without repeating finished runs.
+ */
+
+/* Campaign definition */
+typedef struct {
+  closedLoop_Config_T base;            /* Nominal scenario */
+  unsigned long long seed;
+  int32_T numRuns;
+  real_T maxInitialTilt;               /* Initial pitch/roll ~ U(-max, max) [rad] */
+  real_T gainSpread;                   /* Gains scaled by U(1-s, 1+s) */
+  real_T disturbanceStd;               /* Disturbance torque ~ N(0, std) [N m] */
+  real_T angleNoiseStd;                /* Attitude sensor noise [rad] */
+  real_T rateNoiseStd;                 /* Rate sensor noise [rad/s] */
+} mcCampaign_Config_T;
+
+/* Execution options, not part of the campaign's identity */
+typedef struct {
+  int_T numThreads;                    /* 0 = number of online CPUs */
+  const char_T *checkpointPath;        /* NULL = no checkpointing */
+  real_T checkpointInterval;           /* Seconds between checkpoints */
+  boolean_T verbose;                   /* Progress on stderr */
+} mcCampaign_Options_T;
+
+/* Randomized inputs and outcome of one run */
+typedef struct {
+  real_T initialPitch;
+  real_T initialRoll;
+  real_T gainScale[4];                 /* Kp_att, Kp_rate, Ki_rate, Kd_rate */
+  real_T disturbancePitch;
+  real_T disturbanceRoll;
+  time_T disturbanceTime;
+  closedLoop_Result_T result;
+} mcRun_Result_T;
+
+/* Return codes */
+#define MC_OK                          (0)
+#define MC_ERR_ALLOC                   (-1)
+#define MC_ERR_THREAD                  (-2)
+#define MC_ERR_CHECKPOINT_IO           (-3)
+#define MC_ERR_CHECKPOINT_MISMATCH     (-4)
+
+/* Default campaign: 1000 runs around closedLoop_defaultConfig */
+extern void mcCampaign_defaultConfig(mcCampaign_Config_T *cfg);
+extern void mcCampaign_defaultOptions(mcCampaign_Options_T *opt);
+
+/* Evaluates run 'index' of the campaign; pure function of (cfg, index) */
+extern void mcCampaign_evalRun(const mcCampaign_Config_T *cfg, int32_T index,
+  mcRun_Result_T *out);
+
+/*
+ * Runs all runs not yet completed.  results must hold cfg->numRuns entries.
+ * If opt->checkpointPath names an existing checkpoint of the same campaign,
+ * its runs are restored first.  *numResumed receives the number of restored
+ * runs (may be NULL).
+ */
+extern int_T mcCampaign_run(const mcCampaign_Config_T *cfg, const
+  mcCampaign_Options_T *opt, mcRun_Result_T *results, int32_T *numResumed);
+
+#endif                                 /* mc_campaign_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
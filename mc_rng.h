@@ -0,0 +1,119 @@
+
+
+#ifndef mc_rng_h_
+#define mc_rng_h_
+#include <math.h>
+#include "rtwtypes.h"
+
+/*
+ * Counter-based random numbers (Philox4x32-10, Salmon et al., SC'11).
+ *
+ * Every draw is a pure function of (key, counter), so a stream identified
+ * by a campaign seed and a run index produces the same sequence no matter
+ * which thread evaluates the run or in which order runs are executed.
+ */
+typedef struct {
+  uint32_T key[2];                     /* Campaign seed */
+  uint32_T ctr[4];                     /* {draw lo, draw hi, run lo, run hi} */
+  uint32_T buf[4];                     /* Last block */
+  int_T used;                          /* Words consumed from buf */
+} mcRng_T;
+
+#define MC_PHILOX_M0                   0xD2511F53UL
+#define MC_PHILOX_M1                   0xCD9E8D57UL
+#define MC_PHILOX_W0                   0x9E3779B9UL
+#define MC_PHILOX_W1                   0xBB67AE85UL
+
+static inline void mcRng_mulhilo(uint32_T a, uint32_T b, uint32_T *hi, uint32_T *lo)
+{
+  unsigned long long p = (unsigned long long)a * (unsigned long long)b;
+  *hi = (uint32_T)(p >> 32);
+  *lo = (uint32_T)(p & 0xFFFFFFFFULL);
+}
+
+/* One Philox4x32-10 block for counter ctr under key */
+static inline void mcRng_philox(const uint32_T key[2], const uint32_T ctr[4], uint32_T
+  out[4])
+{
+  uint32_T c0 = ctr[0];
+  uint32_T c1 = ctr[1];
+  uint32_T c2 = ctr[2];
+  uint32_T c3 = ctr[3];
+  uint32_T k0 = key[0];
+  uint32_T k1 = key[1];
+  int_T r;
+  for (r = 0; r < 10; r++) {
+    uint32_T hi0, lo0, hi1, lo1;
+    mcRng_mulhilo(MC_PHILOX_M0, c0, &hi0, &lo0);
+    mcRng_mulhilo(MC_PHILOX_M1, c2, &hi1, &lo1);
+    c0 = (uint32_T)(hi1 ^ c1 ^ k0);
+    c1 = lo1;
+    c2 = (uint32_T)(hi0 ^ c3 ^ k1);
+    c3 = lo0;
+    k0 = (uint32_T)((k0 + MC_PHILOX_W0) & 0xFFFFFFFFUL);
+    k1 = (uint32_T)((k1 + MC_PHILOX_W1) & 0xFFFFFFFFUL);
+  }
+
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+/* Starts the stream of run 'run' in a campaign seeded with 'seed' */
+static inline void mcRng_init(mcRng_T *rng, unsigned long long seed, unsigned long
+  long run)
+{
+  rng->key[0] = (uint32_T)(seed & 0xFFFFFFFFULL);
+  rng->key[1] = (uint32_T)(seed >> 32);
+  rng->ctr[0] = 0UL;
+  rng->ctr[1] = 0UL;
+  rng->ctr[2] = (uint32_T)(run & 0xFFFFFFFFULL);
+  rng->ctr[3] = (uint32_T)(run >> 32);
+  rng->used = 4;
+}
+
+static inline uint32_T mcRng_next32(mcRng_T *rng)
+{
+  if (rng->used >= 4) {
+    mcRng_philox(rng->key, rng->ctr, rng->buf);
+    rng->ctr[0] = (uint32_T)((rng->ctr[0] + 1UL) & 0xFFFFFFFFUL);
+    if (rng->ctr[0] == 0UL) {
+      rng->ctr[1]++;
+    }
+
+    rng->used = 0;
+  }
+
+  return rng->buf[rng->used++];
+}
+
+/* Uniform in [0, 1) with 53 random bits */
+static inline real_T mcRng_uniform(mcRng_T *rng)
+{
+  uint32_T a = mcRng_next32(rng) >> 5;
+  uint32_T b = mcRng_next32(rng) >> 6;
+  return ((real_T)a * 67108864.0 + (real_T)b) * (1.0 / 9007199254740992.0);
+}
+
+/* Uniform in [lo, hi) */
+static inline real_T mcRng_range(mcRng_T *rng, real_T lo, real_T hi)
+{
+  return lo + (hi - lo) * mcRng_uniform(rng);
+}
+
+/* Standard normal by Box-Muller; one draw per call keeps streams simple */
+static inline real_T mcRng_normal(mcRng_T *rng)
+{
+  real_T u1 = 1.0 - mcRng_uniform(rng);
+  real_T u2 = mcRng_uniform(rng);
+  return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+#endif                                 /* mc_rng_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
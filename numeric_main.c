@@ -0,0 +1,306 @@
+
+/*
+ * Accuracy and cost of the numeric variants of the cascade.
+ *
+ * Usage: numeric_main [-r runs] [-n steps] [-s seed]
+ *
+ * Each run draws gains within +/-20% of closedLoop_defaultGains and a long
+ * randomized input sequence: piecewise-constant setpoints, an attitude
+ * that tracks them with random-walk noise, and the matching noisy rate.
+ * The real_T reference is first checked bit for bit against the pitch
+ * outport of controller_step in CONTROLLER_SOLVER_ZOH mode over the same
+ * inputs; any difference fails the run with exit status 1.  The real32_T
+ * and fixed-point variants then see the same inputs as the reference, and
+ * the max and RMS errors of their gimbal commands against it are reported
+ * together with the time and TSC cycles per step.  The
+ * nominal gains come from closed_loop.c, which needs the plant and the
+ * model, so build with all of them, e.g.
+ *
+ *   cc -O2 -I$MATLAB/rtw/c/src -I$MATLAB/simulink/include numeric_main.c \
+ *      controller_numeric.c closed_loop.c pendulum_plant.c controller.c \
+ *      controller_data.c -lm -o numeric_main
+ *
+ * or make numeric_main.
+ */
+#define _POSIX_C_SOURCE                199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "controller_numeric.h"
+#include "mc_rng.h"
+
+#define NUMERIC_NUM_VARIANTS           3
+
+typedef struct {
+  real_T maxErr;
+  real_T sumSqErr;
+  real_T ns;
+  real_T cycles;
+} numeric_Stats_T;
+
+static real_T numeric_now_ns(void)
+{
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (real_T)ts.tv_sec * 1.0E9 + (real_T)ts.tv_nsec;
+}
+
+static unsigned long long numeric_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+
+  return (unsigned long long)__rdtsc();
+
+#else
+
+  return 0ULL;
+
+#endif
+}
+
+/*
+ * Steps the generated model in ZOH mode at step h with gains g through the
+ * pitch inputs; returns the first step whose '<Root>/alpha_pitch' differs
+ * from ref in any bit, or -1.
+ */
+static long numeric_checkModel(const CascadeGains_T *g, time_T h, const real_T
+  *sp, const real_T *angle, const real_T *rate, const real_T *ref, long
+  numSteps)
+{
+  static RT_MODEL_controller_T model;
+  RT_MODEL_controller_T *const controller_M = &model;
+  P_controller_T params;
+  long k;
+  controller_initialize(controller_M);
+  controller_SetRates(controller_M, h, 1UL);
+  controller_SetSolverMode(controller_M, CONTROLLER_SOLVER_ZOH);
+  params = *controller_GetParams(controller_M);
+  closedLoop_gainsToParams(g, &params);
+  (void) controller_SetParams(controller_M, &params);
+  for (k = 0L; k < numSteps; k++) {
+    ExtU_controller_T *u = rtmGetU(controller_M);
+    real_T alpha;
+    u->pitch_sp = sp[k];
+    u->pitch = angle[k];
+    u->pitch_rate = rate[k];
+    controller_step(controller_M);
+    alpha = rtmGetY(controller_M)->alpha_pitch;
+    if (memcmp(&alpha, &ref[k], sizeof(real_T)) != 0) {
+      break;
+    }
+  }
+
+  controller_terminate(controller_M);
+  return (k < numSteps) ? k : -1L;
+}
+
+int_T main(int_T argc, const char *argv[])
+{
+  static const char_T *const names[NUMERIC_NUM_VARIANTS] = {
+    "real_T (reference)", "real32_T", "fixed Q7.24"
+  };
+
+  numeric_Stats_T stats[NUMERIC_NUM_VARIANTS];
+  CascadeGains_T nominal;
+  unsigned long long seed = 1ULL;
+  long numRuns = 20L;
+  long numSteps = 200000L;
+  time_T h = 0.001;
+  real_T refMax = 0.0;
+  real_T *sp;
+  real_T *angle;
+  real_T *rate;
+  real32_T *spF;
+  real32_T *angleF;
+  real32_T *rateF;
+  int32_T *spQ;
+  int32_T *angleQ;
+  int32_T *rateQ;
+  real_T *outD;
+  real32_T *outF;
+  int32_T *outQ;
+  long run;
+  long k;
+  int_T v;
+  int opt;
+  while ((opt = getopt(argc, (char *const *)argv, "r:n:s:")) != -1) {
+    switch (opt) {
+     case 'r':
+      numRuns = strtol(optarg, NULL, 10);
+      break;
+
+     case 'n':
+      numSteps = strtol(optarg, NULL, 10);
+      break;
+
+     case 's':
+      seed = strtoull(optarg, NULL, 0);
+      break;
+
+     default:
+      numRuns = 0L;
+      break;
+    }
+  }
+
+  if ((numRuns <= 0L) || (numSteps <= 0L)) {
+    (void) fprintf(stderr, "usage: %s [-r runs] [-n steps] [-s seed]\n",
+                   argv[0]);
+    return 1;
+  }
+
+  sp = (real_T *)malloc((size_t)numSteps * sizeof(real_T));
+  angle = (real_T *)malloc((size_t)numSteps * sizeof(real_T));
+  rate = (real_T *)malloc((size_t)numSteps * sizeof(real_T));
+  spF = (real32_T *)malloc((size_t)numSteps * sizeof(real32_T));
+  angleF = (real32_T *)malloc((size_t)numSteps * sizeof(real32_T));
+  rateF = (real32_T *)malloc((size_t)numSteps * sizeof(real32_T));
+  spQ = (int32_T *)malloc((size_t)numSteps * sizeof(int32_T));
+  angleQ = (int32_T *)malloc((size_t)numSteps * sizeof(int32_T));
+  rateQ = (int32_T *)malloc((size_t)numSteps * sizeof(int32_T));
+  outD = (real_T *)malloc((size_t)numSteps * sizeof(real_T));
+  outF = (real32_T *)malloc((size_t)numSteps * sizeof(real32_T));
+  outQ = (int32_T *)malloc((size_t)numSteps * sizeof(int32_T));
+  if ((sp == NULL) || (angle == NULL) || (rate == NULL) || (spF == NULL) ||
+      (angleF == NULL) || (rateF == NULL) || (spQ == NULL) || (angleQ == NULL)
+      || (rateQ == NULL) || (outD == NULL) || (outF == NULL) || (outQ == NULL))
+  {
+    (void) fprintf(stderr, "numeric_main: out of memory\n");
+    return 1;
+  }
+
+  closedLoop_defaultGains(&nominal);
+  for (v = 0; v < NUMERIC_NUM_VARIANTS; v++) {
+    stats[v].maxErr = 0.0;
+    stats[v].sumSqErr = 0.0;
+    stats[v].ns = 0.0;
+    stats[v].cycles = 0.0;
+  }
+
+  for (run = 0L; run < numRuns; run++) {
+    mcRng_T rng;
+    CascadeGains_T g = nominal;
+    cascadeD_Params_T pD;
+    cascadeD_State_T sD;
+    cascadeF_Params_T pF;
+    cascadeF_State_T sF;
+    cascadeQ_Params_T pQ;
+    cascadeQ_State_T sQ;
+    real_T a = 0.0;
+    real_T s = 0.0;
+    real_T t0;
+    unsigned long long c0;
+    long bad;
+    mcRng_init(&rng, seed, (unsigned long)run);
+    g.Kp_att *= mcRng_range(&rng, 0.8, 1.2);
+    g.Kp_rate *= mcRng_range(&rng, 0.8, 1.2);
+    g.Ki_rate *= mcRng_range(&rng, 0.8, 1.2);
+    g.Kd_rate *= mcRng_range(&rng, 0.8, 1.2);
+
+    /* Inputs */
+    for (k = 0L; k < numSteps; k++) {
+      real_T aPrev = a;
+      if ((k % 500L) == 0L) {
+        s = mcRng_range(&rng, -0.3, 0.3);
+      }
+
+      a += 0.005 * (s - a) + 0.0005 * mcRng_normal(&rng);
+      sp[k] = s;
+      angle[k] = a;
+      rate[k] = (a - aPrev) / h + 0.01 * mcRng_normal(&rng);
+      spF[k] = (real32_T)sp[k];
+      angleF[k] = (real32_T)angle[k];
+      rateF[k] = (real32_T)rate[k];
+      spQ[k] = cascadeQ_fromReal(sp[k]);
+      angleQ[k] = cascadeQ_fromReal(angle[k]);
+      rateQ[k] = cascadeQ_fromReal(rate[k]);
+    }
+
+    /* Each variant over the whole sequence, timed */
+    cascadeD_init(&pD, &sD, &g, h);
+    t0 = numeric_now_ns();
+    c0 = numeric_cycles();
+    for (k = 0L; k < numSteps; k++) {
+      outD[k] = cascadeD_step(&pD, &sD, sp[k], angle[k], rate[k]);
+    }
+
+    stats[0].cycles += (real_T)(numeric_cycles() - c0);
+    stats[0].ns += numeric_now_ns() - t0;
+    bad = numeric_checkModel(&g, h, sp, angle, rate, outD, numSteps);
+    if (bad >= 0L) {
+      (void) fprintf(stderr, "numeric_main: run %ld: the reference differs "
+                     "from controller_step at step %ld\n", run, bad);
+      return 1;
+    }
+
+    cascadeF_init(&pF, &sF, &g, h);
+    t0 = numeric_now_ns();
+    c0 = numeric_cycles();
+    for (k = 0L; k < numSteps; k++) {
+      outF[k] = cascadeF_step(&pF, &sF, spF[k], angleF[k], rateF[k]);
+    }
+
+    stats[1].cycles += (real_T)(numeric_cycles() - c0);
+    stats[1].ns += numeric_now_ns() - t0;
+    cascadeQ_init(&pQ, &sQ, &g, h);
+    t0 = numeric_now_ns();
+    c0 = numeric_cycles();
+    for (k = 0L; k < numSteps; k++) {
+      outQ[k] = cascadeQ_step(&pQ, &sQ, spQ[k], angleQ[k], rateQ[k]);
+    }
+
+    stats[2].cycles += (real_T)(numeric_cycles() - c0);
+    stats[2].ns += numeric_now_ns() - t0;
+
+    /* Errors against the reference */
+    for (k = 0L; k < numSteps; k++) {
+      real_T eF = (real_T)outF[k] - outD[k];
+      real_T eQ = cascadeQ_toReal(outQ[k]) - outD[k];
+      refMax = fmax(refMax, fabs(outD[k]));
+      stats[1].maxErr = fmax(stats[1].maxErr, fabs(eF));
+      stats[1].sumSqErr += eF * eF;
+      stats[2].maxErr = fmax(stats[2].maxErr, fabs(eQ));
+      stats[2].sumSqErr += eQ * eQ;
+    }
+  }
+
+  (void) printf("%ld runs x %ld steps, seed %llu, max |alpha| %.6g rad, "
+                "reference identical to controller_step\n", numRuns, numSteps,
+                seed, refMax);
+  (void) printf("%-20s %14s %14s %10s %12s\n", "variant", "max err [rad]",
+                "rms err [rad]", "ns/step", "cycles/step");
+  for (v = 0; v < NUMERIC_NUM_VARIANTS; v++) {
+    real_T n = (real_T)numRuns * (real_T)numSteps;
+    (void) printf("%-20s %14.3e %14.3e %10.2f %12.1f\n", names[v],
+                  stats[v].maxErr, sqrt(stats[v].sumSqErr / n), stats[v].ns / n,
+                  stats[v].cycles / n);
+  }
+
+  free(outQ);
+  free(outF);
+  free(outD);
+  free(rateQ);
+  free(angleQ);
+  free(spQ);
+  free(rateF);
+  free(angleF);
+  free(spF);
+  free(rate);
+  free(angle);
+  free(sp);
+  return 0;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,345 @@
+
+#include <math.h>
+#include <string.h>
+#include "pendulum_plant.h"
+
+#define PLANT_PI_2                     1.5707963267948966
+#define PLANT_2_PI                     0.63661977236758134
+
+/* Quadrant count plant_sincos reduces over; beyond it the result is
+ * meaningless anyway and the conversion to int_T must stay defined */
+#define PLANT_SINCOS_MAX_QUADRANTS     (1.0E6)
+
+/* q limited to +/-PLANT_SINCOS_MAX_QUADRANTS; written so that NaN selects
+ * the bound */
+static inline real_T plant_clampQuadrants(real_T q)
+{
+  q = (q < PLANT_SINCOS_MAX_QUADRANTS) ? q : PLANT_SINCOS_MAX_QUADRANTS;
+  return (q > -PLANT_SINCOS_MAX_QUADRANTS) ? q : -PLANT_SINCOS_MAX_QUADRANTS;
+}
+
+/*
+ * sin and cos of x in one call.  Reduces to |r| <= pi/4 and evaluates odd
+ * and even Taylor polynomials of degree 13/14 (error below 1e-13 for the
+ * attitude range of interest) in Estrin form, which is several times
+ * cheaper than libm and keeps the derivative function free of calls and
+ * long dependency chains.  Angles of a diverged run, NaN or beyond
+ * PLANT_SINCOS_MAX_QUADRANTS quarter turns, are clamped before the integer
+ * conversion; the results are then garbage (NaN for NaN) but defined.
+ */
+static inline void plant_sincos(real_T x, real_T *s, real_T *c)
+{
+  real_T q = plant_clampQuadrants(x * PLANT_2_PI);
+  int_T k = (int_T)(q + ((q >= 0.0) ? 0.5 : -0.5));
+  real_T r = x - (real_T)k * PLANT_PI_2;
+  real_T r2 = r * r;
+  real_T r4 = r2 * r2;
+  real_T r8 = r4 * r4;
+  real_T sr = r * (((1.0 - r2 * (1.0 / 6.0)) + r4 * ((1.0 / 120.0) - r2 * (1.0 /
+    5040.0))) + r8 * (((1.0 / 362880.0) - r2 * (1.0 / 39916800.0)) + r4 * (1.0 /
+    6227020800.0)));
+  real_T cr = ((1.0 - r2 * 0.5) + r4 * ((1.0 / 24.0) - r2 * (1.0 / 720.0))) + r8
+    * (((1.0 / 40320.0) - r2 * (1.0 / 3628800.0)) + r4 * ((1.0 / 479001600.0) -
+        r2 * (1.0 / 87178291200.0)));
+
+  /* Quadrant fix-up without branches, so lane loops vectorize */
+  {
+    real_T signS = ((k & 2) != 0) ? -1.0 : 1.0;
+    real_T signC = (((k + 1) & 2) != 0) ? -1.0 : 1.0;
+    int_T swap = k & 1;
+    *s = signS * ((swap != 0) ? cr : sr);
+    *c = signC * ((swap != 0) ? sr : cr);
+  }
+}
+
+static inline real_T plant_saturate(real_T u, real_T limit)
+{
+  return (u > limit) ? limit : ((u < -limit) ? -limit : u);
+}
+
+/*
+ * Per-step constants of the derivative function, so that the four stage
+ * evaluations need no divisions
+ */
+typedef struct {
+  real_T invJ;                         /* 1/inertia */
+  real_T tArmInvJ;                     /* thrust*thrustArm/inertia */
+  real_T mghInvJ;                      /* mass*gravity*gravityArm/inertia */
+  real_T dampInvJ;                     /* damping/inertia */
+  real_T invTau;                       /* 1/gimbalTimeConstant */
+  real_T aCmdPitch;                    /* Saturated gimbal commands */
+  real_T aCmdRoll;
+  real_T thrustAccel;                  /* thrust/mass */
+  real_T gravity;
+} plant_StepConsts_T;
+
+static void plant_step_consts(const P_plant_T *p, const real_T *u,
+  plant_StepConsts_T *k)
+{
+  const U_plant_T *us = (const U_plant_T *)u;
+  k->invJ = 1.0 / p->inertia;
+  k->tArmInvJ = us->thrust * p->thrustArm * k->invJ;
+  k->mghInvJ = p->mass * p->gravity * p->gravityArm * k->invJ;
+  k->dampInvJ = p->damping * k->invJ;
+  k->invTau = 1.0 / p->gimbalTimeConstant;
+  k->aCmdPitch = plant_saturate(us->alphaCmdPitch, p->gimbalLimit);
+  k->aCmdRoll = plant_saturate(us->alphaCmdRoll, p->gimbalLimit);
+  k->thrustAccel = us->thrust / p->mass;
+  k->gravity = p->gravity;
+}
+
+/* Derivative kernel on plain arrays, shared by all stepping paths */
+static void plant_deriv_kernel(const plant_StepConsts_T *k, const real_T *x,
+  const real_T *u, real_T *xdot)
+{
+  const X_plant_T *xs = (const X_plant_T *)x;
+  const U_plant_T *us = (const U_plant_T *)u;
+  X_plant_T *d = (X_plant_T *)xdot;
+  real_T sp, cp, sr, cr, sap, cap, sar, car;
+  plant_sincos(xs->pitch, &sp, &cp);
+  plant_sincos(xs->roll, &sr, &cr);
+  plant_sincos(xs->alphaPitch, &sap, &cap);
+  plant_sincos(xs->alphaRoll, &sar, &car);
+
+  /* Attitude: gimbal torque, gravity torque about the center of rotation,
+   * aerodynamic damping and external disturbance.  The thrust acts below
+   * the center of rotation, so its lateral component turns the body the
+   * other way. */
+  d->pitch = xs->pitchRate;
+  d->pitchRate = k->mghInvJ * sp - k->tArmInvJ * sap - k->dampInvJ *
+    xs->pitchRate + us->disturbancePitch * k->invJ;
+  d->roll = xs->rollRate;
+  d->rollRate = k->mghInvJ * sr - k->tArmInvJ * sar - k->dampInvJ *
+    xs->rollRate + us->disturbanceRoll * k->invJ;
+
+  /* Gimbal actuator */
+  d->alphaPitch = (k->aCmdPitch - xs->alphaPitch) * k->invTau;
+  d->alphaRoll = (k->aCmdRoll - xs->alphaRoll) * k->invTau;
+
+  /* Translation: thrust along the tilted gimbal axis, gravity along -z.
+   * sin/cos of (theta + alpha) by the angle-sum identities. */
+  {
+    real_T sTp = sp * cap + cp * sap;
+    real_T cTp = cp * cap - sp * sap;
+    real_T sTr = sr * car + cr * sar;
+    real_T cTr = cr * car - sr * sar;
+    d->posX = xs->velX;
+    d->velX = k->thrustAccel * sTp;
+    d->posY = xs->velY;
+    d->velY = k->thrustAccel * sTr;
+    d->posZ = xs->velZ;
+    d->velZ = k->thrustAccel * cTp * cTr - k->gravity;
+  }
+}
+
+/* ODE4 step on plain arrays; y holds x on entry and ynew on return */
+static void plant_ode4_kernel(const P_plant_T *p, real_T *y, const real_T *u,
+  time_T h)
+{
+  real_T f0[PLANT_NUM_STATES];
+  real_T f1[PLANT_NUM_STATES];
+  real_T f2[PLANT_NUM_STATES];
+  real_T f3[PLANT_NUM_STATES];
+  real_T x[PLANT_NUM_STATES];
+  real_T temp = 0.5 * h;
+  plant_StepConsts_T k;
+  int_T i;
+  plant_step_consts(p, u, &k);
+
+  /* f0 = f(t,y) */
+  plant_deriv_kernel(&k, y, u, f0);
+
+  /* f1 = f(t + (h/2), y + (h/2)*f0) */
+  for (i = 0; i < PLANT_NUM_STATES; i++) {
+    x[i] = y[i] + (temp*f0[i]);
+  }
+
+  plant_deriv_kernel(&k, x, u, f1);
+
+  /* f2 = f(t + (h/2), y + (h/2)*f1) */
+  for (i = 0; i < PLANT_NUM_STATES; i++) {
+    x[i] = y[i] + (temp*f1[i]);
+  }
+
+  plant_deriv_kernel(&k, x, u, f2);
+
+  /* f3 = f(t + h, y + h*f2) */
+  for (i = 0; i < PLANT_NUM_STATES; i++) {
+    x[i] = y[i] + (h*f2[i]);
+  }
+
+  plant_deriv_kernel(&k, x, u, f3);
+
+  /* ynew = y + (h/6)*(f0 + 2*f1 + 2*f2 + f3) */
+  temp = h / 6.0;
+  for (i = 0; i < PLANT_NUM_STATES; i++) {
+    y[i] = y[i] + temp*(f0[i] + 2.0*f1[i] + 2.0*f2[i] + f3[i]);
+  }
+}
+
+void plant_defaultParams(P_plant_T *p)
+{
+  const real_T length = 1.0;
+  const real_T radius = 0.05;
+  p->mass = 1.0;
+  p->inertia = p->mass * (3.0 * radius * radius + length * length) / 12.0;
+  p->thrustArm = 0.5 * length;
+  p->gravityArm = 0.0;
+  p->damping = 0.01;
+  p->gimbalTimeConstant = 0.02;
+  p->gimbalLimit = 0.2617993877991494;/* 15 deg */
+  p->gravity = 9.80665;
+}
+
+real_T plant_hoverThrust(const P_plant_T *p)
+{
+  return p->mass * p->gravity;
+}
+
+void plant_initialize(X_plant_T *x)
+{
+  (void) memset((void *)x, 0, sizeof(X_plant_T));
+}
+
+void plant_derivatives(const P_plant_T *p, const X_plant_T *x, const U_plant_T
+  *u, X_plant_T *xdot)
+{
+  plant_StepConsts_T k;
+  plant_step_consts(p, (const real_T *)u, &k);
+  plant_deriv_kernel(&k, (const real_T *)x, (const real_T *)u, (real_T *)xdot);
+}
+
+void plant_step(const P_plant_T *p, X_plant_T *x, const U_plant_T *u, time_T h)
+{
+  plant_ode4_kernel(p, (real_T *)x, (const real_T *)u, h);
+}
+
+/*
+ * Batched stepping works on blocks of PLANT_BATCH_BLOCK plants with the lane
+ * index innermost, so each stage of the ODE4 update is a straight-line loop
+ * over lanes that the compiler can vectorize.
+ */
+#define PLANT_BATCH_BLOCK              8
+
+typedef struct {
+  real_T tArmInvJ[PLANT_BATCH_BLOCK];
+  real_T distPitchInvJ[PLANT_BATCH_BLOCK];
+  real_T distRollInvJ[PLANT_BATCH_BLOCK];
+  real_T aCmdPitch[PLANT_BATCH_BLOCK];
+  real_T aCmdRoll[PLANT_BATCH_BLOCK];
+  real_T thrustAccel[PLANT_BATCH_BLOCK];
+} plant_BlockInputs_T;
+
+static void plant_deriv_block(const plant_StepConsts_T *k, const
+  plant_BlockInputs_T *restrict in, real_T (*restrict x)[PLANT_BATCH_BLOCK],
+  real_T (*restrict d)[PLANT_BATCH_BLOCK])
+{
+  int_T j;
+  for (j = 0; j < PLANT_BATCH_BLOCK; j++) {
+    real_T sp, cp, sr, cr, sap, cap, sar, car;
+    plant_sincos(x[0][j], &sp, &cp);
+    plant_sincos(x[2][j], &sr, &cr);
+    plant_sincos(x[4][j], &sap, &cap);
+    plant_sincos(x[5][j], &sar, &car);
+    d[0][j] = x[1][j];
+    d[1][j] = k->mghInvJ * sp - in->tArmInvJ[j] * sap - k->dampInvJ * x[1][j] +
+      in->distPitchInvJ[j];
+    d[2][j] = x[3][j];
+    d[3][j] = k->mghInvJ * sr - in->tArmInvJ[j] * sar - k->dampInvJ * x[3][j] +
+      in->distRollInvJ[j];
+    d[4][j] = (in->aCmdPitch[j] - x[4][j]) * k->invTau;
+    d[5][j] = (in->aCmdRoll[j] - x[5][j]) * k->invTau;
+    d[6][j] = x[7][j];
+    d[7][j] = in->thrustAccel[j] * (sp * cap + cp * sap);
+    d[8][j] = x[9][j];
+    d[9][j] = in->thrustAccel[j] * (sr * car + cr * sar);
+    d[10][j] = x[11][j];
+    d[11][j] = in->thrustAccel[j] * (cp * cap - sp * sap) * (cr * car - sr * sar)
+      - k->gravity;
+  }
+}
+
+void plant_step_batch(const P_plant_T *p, real_T *const xs[PLANT_NUM_STATES],
+                      const real_T *const us[PLANT_NUM_INPUTS], int_T n, time_T
+                      h)
+{
+  real_T y[PLANT_NUM_STATES][PLANT_BATCH_BLOCK];
+  real_T x[PLANT_NUM_STATES][PLANT_BATCH_BLOCK];
+  real_T f0[PLANT_NUM_STATES][PLANT_BATCH_BLOCK];
+  real_T f1[PLANT_NUM_STATES][PLANT_BATCH_BLOCK];
+  real_T f2[PLANT_NUM_STATES][PLANT_BATCH_BLOCK];
+  real_T f3[PLANT_NUM_STATES][PLANT_BATCH_BLOCK];
+  plant_BlockInputs_T in;
+  plant_StepConsts_T k;
+  real_T zero[PLANT_NUM_INPUTS] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+  real_T temp = 0.5 * h;
+  real_T sixth = h / 6.0;
+  int_T base;
+  int_T i;
+  int_T j;
+
+  /* Parameter-only constants are shared by all lanes */
+  plant_step_consts(p, zero, &k);
+  for (base = 0; base < n; base += PLANT_BATCH_BLOCK) {
+    int_T nl = (n - base < PLANT_BATCH_BLOCK) ? (n - base) : PLANT_BATCH_BLOCK;
+
+    /* Gather; unused tail lanes repeat the last plant */
+    for (j = 0; j < PLANT_BATCH_BLOCK; j++) {
+      int_T src = base + ((j < nl) ? j : (nl - 1));
+      for (i = 0; i < PLANT_NUM_STATES; i++) {
+        y[i][j] = xs[i][src];
+      }
+
+      in.tArmInvJ[j] = us[2][src] * p->thrustArm * k.invJ;
+      in.distPitchInvJ[j] = us[3][src] * k.invJ;
+      in.distRollInvJ[j] = us[4][src] * k.invJ;
+      in.aCmdPitch[j] = plant_saturate(us[0][src], p->gimbalLimit);
+      in.aCmdRoll[j] = plant_saturate(us[1][src], p->gimbalLimit);
+      in.thrustAccel[j] = us[2][src] / p->mass;
+    }
+
+    /* f0 = f(t,y) */
+    plant_deriv_block(&k, &in, y, f0);
+
+    /* f1 = f(t + (h/2), y + (h/2)*f0) */
+    for (i = 0; i < PLANT_NUM_STATES; i++) {
+      for (j = 0; j < PLANT_BATCH_BLOCK; j++) {
+        x[i][j] = y[i][j] + (temp*f0[i][j]);
+      }
+    }
+
+    plant_deriv_block(&k, &in, x, f1);
+
+    /* f2 = f(t + (h/2), y + (h/2)*f1) */
+    for (i = 0; i < PLANT_NUM_STATES; i++) {
+      for (j = 0; j < PLANT_BATCH_BLOCK; j++) {
+        x[i][j] = y[i][j] + (temp*f1[i][j]);
+      }
+    }
+
+    plant_deriv_block(&k, &in, x, f2);
+
+    /* f3 = f(t + h, y + h*f2) */
+    for (i = 0; i < PLANT_NUM_STATES; i++) {
+      for (j = 0; j < PLANT_BATCH_BLOCK; j++) {
+        x[i][j] = y[i][j] + (h*f2[i][j]);
+      }
+    }
+
+    plant_deriv_block(&k, &in, x, f3);
+
+    /* ynew = y + (h/6)*(f0 + 2*f1 + 2*f2 + f3), scattered back */
+    for (i = 0; i < PLANT_NUM_STATES; i++) {
+      for (j = 0; j < nl; j++) {
+        xs[i][base + j] = y[i][j] + sixth*(f0[i][j] + 2.0*f1[i][j] + 2.0*f2[i]
+          [j] + f3[i][j]);
+      }
+    }
+  }
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
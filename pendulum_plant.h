@@ -0,0 +1,122 @@
+
+
+#ifndef pendulum_plant_h_
+#define pendulum_plant_h_
+#include "rtwtypes.h"
+
+/*
+ * Thrust-vectored pendulum plant.
+ *
+ * A cylinder of mass m and pitch/roll inertia J rotating about a center of
+ * rotation, with a two-axis gimbaled propeller a distance thrustArm below
+ * it.  Pitch and roll each have their own gimbal angle alpha, driven by a
+ * first-order actuator with a deflection limit.  The thrust vector, tilted
+ * by body attitude plus gimbal angle, accelerates the center of mass
+ * against gravity:
+ *
+ *   J*omega'  = -T*thrustArm*sin(alpha) + m*g*gravityArm*sin(theta)
+ *               - damping*omega + disturbance
+ *   alpha'    = (sat(alphaCmd) - alpha) / gimbalTimeConstant
+ *   m*v'      = T*[sin(theta_p + alpha_p);
+ *                  sin(theta_r + alpha_r);
+ *                  cos(theta_p + alpha_p)*cos(theta_r + alpha_r)] - m*g*e_z
+ *
+ * gravityArm is the height of the center of mass above the center of
+ * rotation: 0 for free flight, positive for a test rig hinged below the
+ * center of mass (the unstable "broom balancer" configuration).
+ *
+ * Signs: positive theta and alpha tilt the thrust toward +x (+y for roll).
+ * The gimbal is below the center of rotation, so a positive alpha pushes
+ * the center of mass toward +x while turning the body toward negative
+ * theta.  A controller whose output alpha asks for positive angular
+ * acceleration, such as the model's alpha_pitch/alpha_roll, drives the
+ * gimbal with alphaCmd = PLANT_GIMBAL_SIGN*alpha.
+ *
+ * States are integrated with the same fixed-step ODE4 scheme as the
+ * controller.  Stepping never allocates.  The state and input structures
+ * are plain arrays of real_T so they can be laid out as structure-of-arrays
+ * for batched stepping with plant_step_batch().  The gimbal actuator is
+ * stiff relative to the controller's 0.2 s default base rate; step the plant
+ * at h < 2.7*gimbalTimeConstant (e.g. 1 kHz).
+ */
+
+/* Gimbal deflection per unit of commanded torque direction */
+#define PLANT_GIMBAL_SIGN              (-1.0)
+
+/* Plant parameters */
+typedef struct {
+  real_T mass;                         /* [kg] */
+  real_T inertia;                      /* Pitch/roll inertia [kg m^2] */
+  real_T thrustArm;                    /* Rotation center to gimbal [m] */
+  real_T gravityArm;                   /* Rotation center to CoM [m] */
+  real_T damping;                      /* Aerodynamic damping [N m s/rad] */
+  real_T gimbalTimeConstant;           /* [s] */
+  real_T gimbalLimit;                  /* Max gimbal deflection [rad] */
+  real_T gravity;                      /* [m/s^2] */
+} P_plant_T;
+
+/* Continuous states */
+#define PLANT_NUM_STATES               12
+
+typedef struct {
+  real_T pitch;                        /* theta_p [rad] */
+  real_T pitchRate;                    /* omega_p [rad/s] */
+  real_T roll;                         /* theta_r [rad] */
+  real_T rollRate;                     /* omega_r [rad/s] */
+  real_T alphaPitch;                   /* Gimbal angle, pitch [rad] */
+  real_T alphaRoll;                    /* Gimbal angle, roll [rad] */
+  real_T posX;                         /* [m] */
+  real_T velX;                         /* [m/s] */
+  real_T posY;                         /* [m] */
+  real_T velY;                         /* [m/s] */
+  real_T posZ;                         /* Altitude [m] */
+  real_T velZ;                         /* [m/s] */
+} X_plant_T;
+
+/* Inputs, held constant over a step */
+#define PLANT_NUM_INPUTS               5
+
+typedef struct {
+  real_T alphaCmdPitch;                /* Gimbal command, pitch [rad] */
+  real_T alphaCmdRoll;                 /* Gimbal command, roll [rad] */
+  real_T thrust;                       /* [N] */
+  real_T disturbancePitch;             /* External torque, pitch [N m] */
+  real_T disturbanceRoll;              /* External torque, roll [N m] */
+} U_plant_T;
+
+/* Fills p with the default vehicle: 1 kg, 1 m x 0.1 m cylinder in free
+ * flight, gimbal 20 ms / +-15 deg. */
+extern void plant_defaultParams(P_plant_T *p);
+
+/* Thrust that balances gravity at zero attitude */
+extern real_T plant_hoverThrust(const P_plant_T *p);
+
+/* Zeroes the state */
+extern void plant_initialize(X_plant_T *x);
+
+/* State derivatives at (x, u) */
+extern void plant_derivatives(const P_plant_T *p, const X_plant_T *x, const
+  U_plant_T *u, X_plant_T *xdot);
+
+/* Advances x by one ODE4 step of size h */
+extern void plant_step(const P_plant_T *p, X_plant_T *x, const U_plant_T *u,
+  time_T h);
+
+/*
+ * Advances n plants stored as structure-of-arrays: xs[k][i] is state k of
+ * plant i (in X_plant_T member order) and us[k][i] input k of plant i (in
+ * U_plant_T member order).  All plants share the parameters p.  Gives the
+ * same states as plant_step() on each plant; controller_bench's
+ * closed_loop_batch runs it against the controller batch.
+ */
+extern void plant_step_batch(const P_plant_T *p, real_T *const
+  xs[PLANT_NUM_STATES], const real_T *const us[PLANT_NUM_INPUTS], int_T n,
+  time_T h);
+
+#endif                                 /* pendulum_plant_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
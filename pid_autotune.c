@@ -0,0 +1,502 @@
+#define _POSIX_C_SOURCE                200809L
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "pid_autotune.h"
+
+/* Nelder-Mead coefficients */
+#define PID_TUNE_REFLECT               1.0
+#define PID_TUNE_EXPAND                2.0
+#define PID_TUNE_CONTRACT              0.5
+#define PID_TUNE_SHRINK                0.5
+
+/* Speculative candidates evaluated per iteration */
+#define PID_TUNE_CAND_REFLECT          0
+#define PID_TUNE_CAND_EXPAND           1
+#define PID_TUNE_CAND_OUTSIDE          2
+#define PID_TUNE_CAND_INSIDE           3
+#define PID_TUNE_NUM_CAND              (PID_TUNE_NUM_PARAMS + 1)
+
+/* Per-scenario cost of a tip-over, scaled up the earlier it happens */
+#define PID_TUNE_DIVERGED_COST         1.0E+4
+
+/* Cost of an abandoned run: known to be worse than the worst vertex */
+#define PID_TUNE_ABANDONED_COST        1.0E+30
+
+/* One batch of (candidate x scenario) closed-loop runs */
+typedef struct {
+  const closedLoop_Config_T *scenarios;
+  int_T numScenarios;
+  const pidTune_Weights_T *weights;
+  const CascadeGains_T *cands;
+  int_T numCands;
+  real_T abandonIse;                   /* 0 = run every scenario to the end */
+  real_T *cost;                        /* [numCands * numScenarios] */
+} pidTune_Batch_T;
+
+/*
+ * Persistent worker pool.  The tuner publishes a batch, bumps 'generation'
+ * and works on it alongside the workers; tasks are claimed from an atomic
+ * counter, so any thread may run any (candidate, scenario) pair.
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t finished;
+  unsigned long generation;
+  int_T busy;
+  boolean_T quit;
+  const pidTune_Batch_T *batch;
+  atomic_int next;
+  atomic_long simulations;
+  atomic_long abandoned;
+  pthread_t *threads;
+  int_T numThreads;                    /* Workers, excluding the tuner */
+} pidTune_Pool_T;
+
+static real_T pidTune_scenarioCost(const closedLoop_Config_T *cfg, const
+  closedLoop_Result_T *r, const pidTune_Weights_T *w)
+{
+  int32_T numSteps = (int32_T)(cfg->duration / cfg->stepSize + 0.5);
+  if (r->diverged) {
+    return PID_TUNE_DIVERGED_COST * (2.0 - (real_T)r->stepsRun / (real_T)
+      numSteps);
+  }
+
+  if (r->stepsRun < numSteps) {
+    return PID_TUNE_ABANDONED_COST;
+  }
+
+  return w->ise * r->ise + w->overshoot * r->overshoot + w->settlingTime *
+    r->settlingTime + w->gimbalEffort * r->gimbalEffort;
+}
+
+/* Claims (candidate, scenario) pairs and runs each on its own model
+ * instance through closedLoop_run */
+static void pidTune_runTasks(pidTune_Pool_T *pool)
+{
+  const pidTune_Batch_T *b = pool->batch;
+  int_T numTasks = b->numCands * b->numScenarios;
+  int_T t;
+  while ((t = atomic_fetch_add(&pool->next, 1)) < numTasks) {
+    closedLoop_Config_T cfg = b->scenarios[t % b->numScenarios];
+    closedLoop_Result_T r;
+    cfg.gains = b->cands[t / b->numScenarios];
+    closedLoop_run(&cfg, NULL, NULL, b->abandonIse, &r);
+    b->cost[t] = pidTune_scenarioCost(&cfg, &r, b->weights);
+    (void) atomic_fetch_add(&pool->simulations, 1L);
+    if (b->cost[t] == PID_TUNE_ABANDONED_COST) {
+      (void) atomic_fetch_add(&pool->abandoned, 1L);
+    }
+  }
+}
+
+static void *pidTune_worker(void *arg)
+{
+  pidTune_Pool_T *pool = (pidTune_Pool_T *)arg;
+  unsigned long seen = 0UL;
+  for (;;) {
+    (void) pthread_mutex_lock(&pool->lock);
+    while ((pool->generation == seen) && (!pool->quit)) {
+      (void) pthread_cond_wait(&pool->start, &pool->lock);
+    }
+
+    if (pool->quit) {
+      (void) pthread_mutex_unlock(&pool->lock);
+      break;
+    }
+
+    seen = pool->generation;
+    (void) pthread_mutex_unlock(&pool->lock);
+    pidTune_runTasks(pool);
+    (void) pthread_mutex_lock(&pool->lock);
+    if (--pool->busy == 0) {
+      (void) pthread_cond_signal(&pool->finished);
+    }
+
+    (void) pthread_mutex_unlock(&pool->lock);
+  }
+
+  return NULL;
+}
+
+/* Runs one batch to completion and reduces it to per-candidate mean cost */
+static void pidTune_evaluate(pidTune_Pool_T *pool, pidTune_Batch_T *b, real_T
+  *candCost)
+{
+  int_T c;
+  int_T s;
+  pool->batch = b;
+  atomic_store(&pool->next, 0);
+  (void) pthread_mutex_lock(&pool->lock);
+  pool->busy = pool->numThreads;
+  pool->generation++;
+  (void) pthread_cond_broadcast(&pool->start);
+  (void) pthread_mutex_unlock(&pool->lock);
+  pidTune_runTasks(pool);
+  (void) pthread_mutex_lock(&pool->lock);
+  while (pool->busy > 0) {
+    (void) pthread_cond_wait(&pool->finished, &pool->lock);
+  }
+
+  (void) pthread_mutex_unlock(&pool->lock);
+
+  /* Fixed summation order keeps the result independent of scheduling */
+  for (c = 0; c < b->numCands; c++) {
+    real_T sum = 0.0;
+    for (s = 0; s < b->numScenarios; s++) {
+      sum += b->cost[c * b->numScenarios + s];
+    }
+
+    candCost[c] = fmin(sum / (real_T)b->numScenarios, PID_TUNE_ABANDONED_COST);
+  }
+}
+
+static void pidTune_toGains(const real_T y[PID_TUNE_NUM_PARAMS],
+  CascadeGains_T *g)
+{
+  g->Kp_att = exp(y[0]);
+  g->Kp_rate = exp(y[1]);
+  g->Ki_rate = exp(y[2]);
+  g->Kd_rate = exp(y[3]);
+  g->N = exp(y[4]);
+}
+
+/*
+ * ISE beyond which a single scenario run proves its candidate's mean cost
+ * above fWorst, or 0 when no ISE does.  With nonnegative weights every
+ * scenario cost is nonnegative; a run that finishes costs at least
+ * weights.ise * ISE and one that still tips over at least
+ * PID_TUNE_DIVERGED_COST, so the bound holds only while the budget of the
+ * worst vertex is below a tip-over.
+ */
+static real_T pidTune_abandonIse(int_T numScenarios, real_T fWorst, const
+  pidTune_Weights_T *w)
+{
+  real_T budget = (real_T)numScenarios * fWorst;
+  if ((w->ise <= 0.0) || (budget >= PID_TUNE_DIVERGED_COST)) {
+    return 0.0;
+  }
+
+  return budget / w->ise;
+}
+
+static boolean_T pidTune_validWeights(const pidTune_Weights_T *w)
+{
+  /* Written so that NaN fails */
+  return (w->ise >= 0.0) && (w->overshoot >= 0.0) && (w->settlingTime >= 0.0)
+    && (w->gimbalEffort >= 0.0) && (w->ise + w->overshoot + w->settlingTime +
+    w->gimbalEffort > 0.0);
+}
+
+static int_T pidTune_cmpVertex(const real_T *a, const real_T *b)
+{
+  return (a[PID_TUNE_NUM_PARAMS] < b[PID_TUNE_NUM_PARAMS]) ? -1 :
+    ((a[PID_TUNE_NUM_PARAMS] > b[PID_TUNE_NUM_PARAMS]) ? 1 : 0);
+}
+
+/* Insertion sort of the simplex by cost; stable, so ties keep their order */
+static void pidTune_sortSimplex(real_T v[PID_TUNE_NUM_CAND][PID_TUNE_NUM_PARAMS
+  + 1])
+{
+  int_T i;
+  int_T j;
+  for (i = 1; i < PID_TUNE_NUM_CAND; i++) {
+    real_T tmp[PID_TUNE_NUM_PARAMS + 1];
+    (void) memcpy(tmp, v[i], sizeof(tmp));
+    for (j = i - 1; (j >= 0) && (pidTune_cmpVertex(v[j], tmp) > 0); j--) {
+      (void) memcpy(v[j + 1], v[j], sizeof(tmp));
+    }
+
+    (void) memcpy(v[j + 1], tmp, sizeof(tmp));
+  }
+}
+
+void pidTune_defaultOptions(pidTune_Options_T *opt)
+{
+  opt->weights.ise = 100.0;
+  opt->weights.overshoot = 10.0;
+  opt->weights.settlingTime = 1.0;
+  opt->weights.gimbalEffort = 1.0;
+  opt->maxIterations = 200;
+  opt->numThreads = 0;
+  opt->initialStep = 0.5;
+  opt->tolerance = 1.0E-6;
+  opt->verbose = false;
+}
+
+int_T pidTune_defaultScenarios(const closedLoop_Config_T *base,
+  closedLoop_Config_T *scenarios, int_T maxScenarios)
+{
+  /* initial pitch, initial roll, setpoint pitch, disturbance pitch, roll */
+  static const real_T table[][5] = {
+    { 0.1, 0.0, 0.0, 0.0, 0.0 },
+    { 0.0, -0.1, 0.0, 0.0, 0.0 },
+    { 0.3, -0.2, 0.0, 0.0, 0.0 },
+    { 0.0, 0.0, 0.2, 0.0, 0.0 },
+    { 0.0, 0.0, 0.0, 0.05, 0.0 },
+    { 0.0, 0.0, 0.0, 0.0, -0.05 },
+    { 0.05, 0.05, 0.0, 0.1, 0.1 },
+    { -0.4, 0.0, 0.0, 0.0, 0.0 }
+  };
+
+  int_T n = (int_T)(sizeof(table) / sizeof(table[0]));
+  int_T i;
+  if (n > maxScenarios) {
+    n = maxScenarios;
+  }
+
+  for (i = 0; i < n; i++) {
+    closedLoop_Config_T *s = &scenarios[i];
+    *s = *base;
+    s->duration = 5.0;
+    s->initialPitch = table[i][0];
+    s->initialRoll = table[i][1];
+    s->setpointPitch = table[i][2];
+    s->setpointRoll = 0.0;
+    s->disturbancePitch = table[i][3];
+    s->disturbanceRoll = table[i][4];
+    s->disturbanceTime = 1.0;
+    s->angleNoiseStd = 0.0;
+    s->rateNoiseStd = 0.0;
+  }
+
+  return n;
+}
+
+real_T pidTune_cost(const closedLoop_Config_T *scenarios, int_T numScenarios,
+                    const CascadeGains_T *gains, const pidTune_Weights_T *w)
+{
+  real_T sum = 0.0;
+  int_T s;
+  for (s = 0; s < numScenarios; s++) {
+    closedLoop_Config_T cfg = scenarios[s];
+    closedLoop_Result_T r;
+    cfg.gains = *gains;
+    closedLoop_run(&cfg, NULL, NULL, 0.0, &r);
+    sum += pidTune_scenarioCost(&cfg, &r, w);
+  }
+
+  return sum / (real_T)numScenarios;
+}
+
+int_T pidTune_run(const closedLoop_Config_T *scenarios, int_T numScenarios,
+                  const CascadeGains_T *initial, const pidTune_Options_T *opt,
+                  pidTune_Result_T *result)
+{
+  /* Simplex vertices: log-gains followed by cost, sorted best first */
+  real_T v[PID_TUNE_NUM_CAND][PID_TUNE_NUM_PARAMS + 1];
+  real_T y[PID_TUNE_NUM_CAND][PID_TUNE_NUM_PARAMS];
+  CascadeGains_T cands[PID_TUNE_NUM_CAND];
+  real_T candCost[PID_TUNE_NUM_CAND];
+  real_T *cost;
+  pidTune_Pool_T pool;
+  pidTune_Batch_T batch;
+  int_T numThreads = opt->numThreads;
+  int_T status = PID_TUNE_OK;
+  int_T iter = 0;
+  int_T i;
+  int_T j;
+  if ((numScenarios <= 0) || (numScenarios > PID_TUNE_MAX_SCENARIOS) ||
+      (initial->Kp_att <= 0.0) || (initial->Kp_rate <= 0.0) ||
+      (initial->Ki_rate <= 0.0) || (initial->Kd_rate <= 0.0) ||
+      (initial->N <= 0.0) || (!pidTune_validWeights(&opt->weights))) {
+    return PID_TUNE_ERR_ARGS;
+  }
+
+  /* The gains are tuned for one controller configuration */
+  for (i = 1; i < numScenarios; i++) {
+    if ((scenarios[i].stepSize != scenarios[0].stepSize) ||
+        (scenarios[i].outerRateRatio != scenarios[0].outerRateRatio) ||
+        (scenarios[i].solverMode != scenarios[0].solverMode)) {
+      return PID_TUNE_ERR_ARGS;
+    }
+  }
+
+  if (numThreads <= 0) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    numThreads = (ncpu > 0L) ? (int_T)ncpu : 1;
+  }
+
+  cost = (real_T *)malloc((size_t)(PID_TUNE_NUM_CAND * numScenarios) * sizeof
+    (real_T));
+  (void) memset(&pool, 0, sizeof(pool));
+  pool.threads = (pthread_t *)calloc((size_t)numThreads, sizeof(pthread_t));
+  if ((cost == NULL) || (pool.threads == NULL)) {
+    free(cost);
+    free(pool.threads);
+    return PID_TUNE_ERR_ALLOC;
+  }
+
+  (void) pthread_mutex_init(&pool.lock, NULL);
+  (void) pthread_cond_init(&pool.start, NULL);
+  (void) pthread_cond_init(&pool.finished, NULL);
+  atomic_init(&pool.next, 0);
+  atomic_init(&pool.simulations, 0L);
+  atomic_init(&pool.abandoned, 0L);
+
+  /* The calling thread is the last member of the pool */
+  for (i = 0; i < numThreads - 1; i++) {
+    if (pthread_create(&pool.threads[i], NULL, &pidTune_worker, &pool) != 0) {
+      status = PID_TUNE_ERR_THREAD;
+      break;
+    }
+
+    pool.numThreads++;
+  }
+
+  (void) memset(result, 0, sizeof(pidTune_Result_T));
+  batch.scenarios = scenarios;
+  batch.numScenarios = numScenarios;
+  batch.weights = &opt->weights;
+  batch.cands = cands;
+  batch.cost = cost;
+
+  /* Initial simplex: the starting point and one step along each axis */
+  v[0][0] = log(initial->Kp_att);
+  v[0][1] = log(initial->Kp_rate);
+  v[0][2] = log(initial->Ki_rate);
+  v[0][3] = log(initial->Kd_rate);
+  v[0][4] = log(initial->N);
+  for (i = 1; i < PID_TUNE_NUM_CAND; i++) {
+    (void) memcpy(v[i], v[0], sizeof(v[0]));
+    v[i][i - 1] += opt->initialStep;
+  }
+
+  for (i = 0; i < PID_TUNE_NUM_CAND; i++) {
+    pidTune_toGains(v[i], &cands[i]);
+  }
+
+  batch.numCands = PID_TUNE_NUM_CAND;
+  batch.abandonIse = 0.0;
+  pidTune_evaluate(&pool, &batch, candCost);
+  result->evaluations += PID_TUNE_NUM_CAND;
+  for (i = 0; i < PID_TUNE_NUM_CAND; i++) {
+    v[i][PID_TUNE_NUM_PARAMS] = candCost[i];
+  }
+
+  pidTune_sortSimplex(v);
+  while ((status == PID_TUNE_OK) && (iter < opt->maxIterations)) {
+    const int_T w = PID_TUNE_NUM_PARAMS;
+    real_T fBest = v[0][PID_TUNE_NUM_PARAMS];
+    real_T fSecond = v[w - 1][PID_TUNE_NUM_PARAMS];
+    real_T fWorst = v[w][PID_TUNE_NUM_PARAMS];
+    real_T centroid[PID_TUNE_NUM_PARAMS];
+    const real_T *accept = NULL;
+    real_T fAccept = 0.0;
+    if (fWorst - fBest <= opt->tolerance * fmax(fabs(fBest), 1.0E-12)) {
+      break;
+    }
+
+    for (j = 0; j < PID_TUNE_NUM_PARAMS; j++) {
+      centroid[j] = 0.0;
+      for (i = 0; i < w; i++) {
+        centroid[j] += v[i][j];
+      }
+
+      centroid[j] /= (real_T)w;
+    }
+
+    /* Reflection, expansion and both contractions, all at once */
+    for (j = 0; j < PID_TUNE_NUM_PARAMS; j++) {
+      real_T d = centroid[j] - v[w][j];
+      y[PID_TUNE_CAND_REFLECT][j] = centroid[j] + PID_TUNE_REFLECT * d;
+      y[PID_TUNE_CAND_EXPAND][j] = centroid[j] + PID_TUNE_EXPAND * d;
+      y[PID_TUNE_CAND_OUTSIDE][j] = centroid[j] + PID_TUNE_CONTRACT * d;
+      y[PID_TUNE_CAND_INSIDE][j] = centroid[j] - PID_TUNE_CONTRACT * d;
+    }
+
+    for (i = 0; i < 4; i++) {
+      pidTune_toGains(y[i], &cands[i]);
+    }
+
+    /* One scenario past this ISE puts the candidate behind the worst vertex */
+    batch.numCands = 4;
+    batch.abandonIse = pidTune_abandonIse(numScenarios, fWorst, &opt->weights);
+    pidTune_evaluate(&pool, &batch, candCost);
+    result->evaluations += 4;
+    if (candCost[PID_TUNE_CAND_REFLECT] < fBest) {
+      if (candCost[PID_TUNE_CAND_EXPAND] < candCost[PID_TUNE_CAND_REFLECT]) {
+        accept = y[PID_TUNE_CAND_EXPAND];
+        fAccept = candCost[PID_TUNE_CAND_EXPAND];
+      } else {
+        accept = y[PID_TUNE_CAND_REFLECT];
+        fAccept = candCost[PID_TUNE_CAND_REFLECT];
+      }
+    } else if (candCost[PID_TUNE_CAND_REFLECT] < fSecond) {
+      accept = y[PID_TUNE_CAND_REFLECT];
+      fAccept = candCost[PID_TUNE_CAND_REFLECT];
+    } else if (candCost[PID_TUNE_CAND_REFLECT] < fWorst) {
+      if (candCost[PID_TUNE_CAND_OUTSIDE] <= candCost[PID_TUNE_CAND_REFLECT]) {
+        accept = y[PID_TUNE_CAND_OUTSIDE];
+        fAccept = candCost[PID_TUNE_CAND_OUTSIDE];
+      }
+    } else if (candCost[PID_TUNE_CAND_INSIDE] < fWorst) {
+      accept = y[PID_TUNE_CAND_INSIDE];
+      fAccept = candCost[PID_TUNE_CAND_INSIDE];
+    }
+
+    if (accept != NULL) {
+      (void) memcpy(v[w], accept, sizeof(y[0]));
+      v[w][PID_TUNE_NUM_PARAMS] = fAccept;
+    } else {
+      /* Shrink towards the best vertex; new vertices are always kept */
+      for (i = 1; i < PID_TUNE_NUM_CAND; i++) {
+        for (j = 0; j < PID_TUNE_NUM_PARAMS; j++) {
+          v[i][j] = v[0][j] + PID_TUNE_SHRINK * (v[i][j] - v[0][j]);
+        }
+
+        pidTune_toGains(v[i], &cands[i - 1]);
+      }
+
+      batch.numCands = PID_TUNE_NUM_PARAMS;
+      batch.abandonIse = 0.0;
+      pidTune_evaluate(&pool, &batch, candCost);
+      result->evaluations += PID_TUNE_NUM_PARAMS;
+      for (i = 1; i < PID_TUNE_NUM_CAND; i++) {
+        v[i][PID_TUNE_NUM_PARAMS] = candCost[i - 1];
+      }
+    }
+
+    pidTune_sortSimplex(v);
+    iter++;
+    if (opt->verbose) {
+      (void) fprintf(stderr, "pid_autotune: iter %d cost %.9g (worst %.9g)\n",
+                     (int)iter, v[0][PID_TUNE_NUM_PARAMS], v[w]
+                     [PID_TUNE_NUM_PARAMS]);
+    }
+  }
+
+  (void) pthread_mutex_lock(&pool.lock);
+  pool.quit = true;
+  (void) pthread_cond_broadcast(&pool.start);
+  (void) pthread_mutex_unlock(&pool.lock);
+  for (i = 0; i < pool.numThreads; i++) {
+    (void) pthread_join(pool.threads[i], NULL);
+  }
+
+  (void) pthread_cond_destroy(&pool.finished);
+  (void) pthread_cond_destroy(&pool.start);
+  (void) pthread_mutex_destroy(&pool.lock);
+  pidTune_toGains(v[0], &result->best);
+  result->params = controller_DefaultP;
+  closedLoop_gainsToParams(&result->best, &result->params);
+  result->bestCost = v[0][PID_TUNE_NUM_PARAMS];
+  result->iterations = iter;
+  result->simulations = atomic_load(&pool.simulations);
+  result->abandoned = atomic_load(&pool.abandoned);
+  free(pool.threads);
+  free(cost);
+  return status;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,88 @@
+
+
+#ifndef pid_autotune_h_
+#define pid_autotune_h_
+#include "rtwtypes.h"
+#include "closed_loop.h"
+
+/*
+ * Parallel autotuning of the cascade gains (outer P, inner PID).
+ *
+ * A candidate gain set is scored by running it through a fixed set of
+ * closed-loop scenarios and summing weighted ISE, overshoot, settling time
+ * and gimbal effort.  Every scenario runs the generated model through
+ * closedLoop_run with the scenario's controller step, outer rate divider
+ * and solver mode, which all scenarios must share: the tuned gains hold for
+ * that configuration, and the result carries them as a model parameter set
+ * for controller_SetParams.  The search is Nelder-Mead in log-gain space; each
+ * iteration evaluates reflection, expansion and both contractions
+ * speculatively, so (candidates x scenarios) closed-loop runs execute in
+ * parallel on a persistent thread pool.  A scenario run is abandoned as soon
+ * as its ISE alone proves the candidate cannot beat the worst simplex
+ * vertex, whether the run would finish or still tip over, and diverging
+ * runs stop at tip-over.
+ *
+ * Results depend only on the inputs, not on the number of threads.
+ */
+
+#define PID_TUNE_NUM_PARAMS            5 /* Kp_att, Kp_rate, Ki_rate, Kd_rate, N */
+#define PID_TUNE_MAX_SCENARIOS         64
+
+typedef struct {
+  real_T ise;
+  real_T overshoot;
+  real_T settlingTime;
+  real_T gimbalEffort;
+} pidTune_Weights_T;
+
+typedef struct {
+  pidTune_Weights_T weights;
+  int_T maxIterations;
+  int_T numThreads;                    /* 0 = number of online CPUs */
+  real_T initialStep;                  /* Initial simplex size in log-gain */
+  real_T tolerance;                    /* Stop when cost spread falls below */
+  boolean_T verbose;
+} pidTune_Options_T;
+
+typedef struct {
+  CascadeGains_T best;
+  P_controller_T params;               /* best as a model parameter set */
+  real_T bestCost;
+  int_T iterations;
+  long evaluations;                    /* Candidate gain sets scored */
+  long simulations;                    /* Closed-loop runs started */
+  long abandoned;                      /* Runs stopped by early abandon */
+} pidTune_Result_T;
+
+/* Return codes */
+#define PID_TUNE_OK                    (0)
+#define PID_TUNE_ERR_ARGS              (-1)
+#define PID_TUNE_ERR_THREAD            (-2)
+#define PID_TUNE_ERR_ALLOC             (-3)
+
+extern void pidTune_defaultOptions(pidTune_Options_T *opt);
+
+/* Fills up to maxScenarios scenarios around base: initial tilts on each
+ * axis and disturbance steps.  Returns the number written. */
+extern int_T pidTune_defaultScenarios(const closedLoop_Config_T *base,
+  closedLoop_Config_T *scenarios, int_T maxScenarios);
+
+/* Cost of one gain set over the scenarios (single-threaded) */
+extern real_T pidTune_cost(const closedLoop_Config_T *scenarios, int_T
+  numScenarios, const CascadeGains_T *gains, const pidTune_Weights_T *w);
+
+/* Tunes starting from 'initial', the derivative filter N included.  The
+ * weights must be nonnegative and not all zero.  Returns PID_TUNE_ERR_ARGS
+ * when they are not, or when the scenarios differ in controller step,
+ * outer rate divider or solver mode. */
+extern int_T pidTune_run(const closedLoop_Config_T *scenarios, int_T
+  numScenarios, const CascadeGains_T *initial, const pidTune_Options_T *opt,
+  pidTune_Result_T *result);
+
+#endif                                 /* pid_autotune_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,83 @@
+/*
+ * Replays a recording made with ert_main -R and checks it bit for bit.
+ *
+ * Usage: replay_main [-r repeats] recording
+ *
+ * Each repeat restores the recorded starting point into a fresh model
+ * instance, feeds every recorded input and parameter change back in as fast
+ * as the CPU allows and compares each step's outputs with the recording.
+ * Reports the first mismatching step and the speed relative to real time;
+ * exits with status 1 if any output differs, so a regenerated model can be
+ * checked against recordings of the previous one, and also when the
+ * recorder dropped steps, since the log then misses the end of the run.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "rt_record.h"
+
+int_T main(int_T argc, const char *argv[])
+{
+  rtRecord_ReplayResult_T result;
+  unsigned long long mismatches = 0ULL;
+  real_T seconds = 0.0;
+  real_T recorded = 0.0;
+  long repeats = 1L;
+  long r;
+  int opt;
+  while ((opt = getopt(argc, (char *const *)argv, "r:")) != -1) {
+    switch (opt) {
+     case 'r':
+      repeats = strtol(optarg, NULL, 10);
+      break;
+
+     default:
+      repeats = 0L;
+      break;
+    }
+  }
+
+  if ((repeats <= 0L) || (optind != argc - 1)) {
+    (void) fprintf(stderr, "usage: %s [-r repeats] recording\n", argv[0]);
+    return 2;
+  }
+
+  for (r = 0L; r < repeats; r++) {
+    int_T status = rtRecord_replay(argv[optind], &result);
+    if (status != RT_RECORD_OK) {
+      (void) fprintf(stderr, "replay_main: cannot replay %s (%d)\n",
+                     argv[optind], (int)status);
+      return 2;
+    }
+
+    if (result.dropped != 0ULL) {
+      (void) fprintf(stderr,
+                     "replay_main: %s dropped %llu steps, the log is incomplete\n",
+                     argv[optind], result.dropped);
+      return 1;
+    }
+
+    if ((result.mismatches != 0ULL) && (mismatches == 0ULL)) {
+      (void) printf("repeat %ld: %llu of %llu steps differ, first at step %llu\n",
+                    r, result.mismatches, result.steps, result.firstMismatch);
+    }
+
+    mismatches += result.mismatches;
+    seconds += result.replaySeconds;
+    recorded += result.recordedTime;
+  }
+
+  (void) printf("%ld x %llu steps (%.6g s of model time) replayed in %.6g s, "
+                "%.1f ns/step, %.0fx real time: %s\n", repeats, result.steps,
+                result.recordedTime, seconds, (result.steps > 0ULL) ? seconds *
+                1.0E9 / ((real_T)repeats * (real_T)result.steps) : 0.0,
+                (seconds > 0.0) ? recorded / seconds : 0.0, (mismatches == 0ULL)
+                ? "bit-exact" : "MISMATCH");
+  return (mismatches == 0ULL) ? 0 : 1;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,262 @@
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdint.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+#include "rt_executive.h"
+
+typedef long long rtExecNs_T;
+
+#define RT_EXEC_NS_PER_SEC             (1000000000LL)
+
+static rtExecNs_T rtExec_now(void)
+{
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (rtExecNs_T)ts.tv_sec * RT_EXEC_NS_PER_SEC + (rtExecNs_T)ts.tv_nsec;
+}
+
+static struct timespec rtExec_toTimespec(rtExecNs_T ns)
+{
+  struct timespec ts;
+  ts.tv_sec = (time_t)(ns / RT_EXEC_NS_PER_SEC);
+  ts.tv_nsec = (long)(ns % RT_EXEC_NS_PER_SEC);
+  return ts;
+}
+
+static int32_T rtExec_clampNs(rtExecNs_T ns)
+{
+  if (ns > (rtExecNs_T)MAX_int32_T) {
+    return MAX_int32_T;
+  } else if (ns < (rtExecNs_T)MIN_int32_T) {
+    return MIN_int32_T;
+  }
+
+  return (int32_T)ns;
+}
+
+/* Blocks until the absolute CLOCK_MONOTONIC time 'release' */
+static int_T rtExec_waitUntil(const rtExecConfig_T *cfg, int_T tfd, rtExecNs_T
+  release)
+{
+  struct timespec ts = rtExec_toTimespec(release);
+  if (cfg->timer == RT_EXEC_TIMER_TIMERFD) {
+    struct itimerspec its;
+    uint64_t expirations;
+    if (release <= rtExec_now()) {
+      return RT_EXEC_OK;
+    }
+
+    (void) memset(&its, 0, sizeof(its));
+    its.it_value = ts;
+    if (timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL) != 0) {
+      return RT_EXEC_ERR_TIMER;
+    }
+
+    while (read(tfd, &expirations, sizeof(expirations)) < 0) {
+      if (errno != EINTR) {
+        return RT_EXEC_ERR_TIMER;
+      }
+    }
+  } else {
+    int err;
+    while ((err = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL))
+           != 0) {
+      if (err != EINTR) {
+        return RT_EXEC_ERR_TIMER;
+      }
+    }
+  }
+
+  return RT_EXEC_OK;
+}
+
+/* Applies scheduling policy, CPU affinity and memory locking */
+static void rtExec_applyAttributes(const rtExecConfig_T *cfg, rtExecStats_T
+  *stats)
+{
+  if (cfg->cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cfg->cpu, &set);
+    stats->affinityApplied = (boolean_T)(sched_setaffinity(0, sizeof(set), &set)
+      == 0);
+  }
+
+  if (cfg->priority > 0) {
+    struct sched_param sp;
+    (void) memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = cfg->priority;
+    stats->schedFifoApplied = (boolean_T)(sched_setscheduler(0, SCHED_FIFO, &sp)
+      == 0);
+    stats->memoryLocked = (boolean_T)(mlockall(MCL_CURRENT | MCL_FUTURE) == 0);
+  }
+}
+
+void rtExec_defaultConfig(rtExecConfig_T *cfg, time_T period)
+{
+  cfg->period = period;
+  cfg->priority = 0;
+  cfg->cpu = -1;
+  cfg->overrunPolicy = RT_EXEC_OVERRUN_SKIP;
+  cfg->timer = RT_EXEC_TIMER_NANOSLEEP;
+  cfg->maxCycles = 0UL;
+}
+
+void rtExec_resetStats(rtExecStats_T *stats)
+{
+  rtExecSample_T *trace = stats->trace;
+  uint32_T traceLength = stats->traceLength;
+  (void) memset(stats, 0, sizeof(rtExecStats_T));
+  stats->wakeLatencyMinNs = MAX_int32_T;
+  stats->wakeLatencyMaxNs = MIN_int32_T;
+  stats->execTimeMinNs = MAX_int32_T;
+  stats->execTimeMaxNs = MIN_int32_T;
+  stats->trace = trace;
+  stats->traceLength = traceLength;
+}
+
+int_T rtExec_run(const rtExecConfig_T *cfg, rtExecStepFcn_T step, void *ctx,
+                 rtExecStats_T *stats)
+{
+  rtExecNs_T period = (rtExecNs_T)(cfg->period * (real_T)RT_EXEC_NS_PER_SEC +
+    0.5);
+  rtExecNs_T release;
+  int_T tfd = -1;
+  int_T status = RT_EXEC_OK;
+  boolean_T running = true;
+  if ((period <= 0) || (step == NULL) || (stats == NULL)) {
+    return RT_EXEC_ERR_CONFIG;
+  }
+
+  rtExec_resetStats(stats);
+  rtExec_applyAttributes(cfg, stats);
+  if (cfg->timer == RT_EXEC_TIMER_TIMERFD) {
+    tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tfd < 0) {
+      return RT_EXEC_ERR_TIMER;
+    }
+  }
+
+  release = rtExec_now() + period;
+  while (running) {
+    rtExecNs_T wake;
+    rtExecNs_T end;
+    rtExecNs_T next;
+    int32_T latency;
+    int32_T exec;
+    boolean_T miss;
+    status = rtExec_waitUntil(cfg, tfd, release);
+    if (status != RT_EXEC_OK) {
+      break;
+    }
+
+    /* Execute one release */
+    wake = rtExec_now();
+    running = step(ctx);
+    end = rtExec_now();
+    next = release + period;
+    miss = (boolean_T)(end > next);
+    latency = rtExec_clampNs(wake - release);
+    exec = rtExec_clampNs(end - wake);
+
+    /* Record cycle statistics */
+    if (latency < stats->wakeLatencyMinNs) {
+      stats->wakeLatencyMinNs = latency;
+    }
+
+    if (latency > stats->wakeLatencyMaxNs) {
+      stats->wakeLatencyMaxNs = latency;
+    }
+
+    if (exec < stats->execTimeMinNs) {
+      stats->execTimeMinNs = exec;
+    }
+
+    if (exec > stats->execTimeMaxNs) {
+      stats->execTimeMaxNs = exec;
+    }
+
+    stats->wakeLatencySumNs += (real_T)latency;
+    stats->execTimeSumNs += (real_T)exec;
+    if ((stats->trace != NULL) && (stats->traceLength > 0UL)) {
+      rtExecSample_T *s = &stats->trace[stats->cycles % stats->traceLength];
+      s->cycle = stats->cycles;
+      s->wakeLatencyNs = latency;
+      s->execTimeNs = exec;
+      s->deadlineMiss = miss;
+    }
+
+    stats->cycles++;
+
+    /* Overrun handling */
+    if (miss) {
+      stats->deadlineMisses++;
+      switch (cfg->overrunPolicy) {
+       case RT_EXEC_OVERRUN_ABORT:
+        status = RT_EXEC_ERR_OVERRUN;
+        running = false;
+        break;
+
+       case RT_EXEC_OVERRUN_CATCH_UP:
+        /* Keep the release timeline; the wait returns immediately */
+        break;
+
+       default:
+        {
+          /* Realign to the first release boundary after the step ended */
+          rtExecNs_T k = (end - release) / period + 1;
+          stats->skippedReleases += (uint32_T)(k - 1);
+          next = release + k * period;
+        }
+        break;
+      }
+    }
+
+    release = next;
+    if ((cfg->maxCycles != 0UL) && (stats->cycles >= cfg->maxCycles)) {
+      running = false;
+    }
+  }
+
+  if (tfd >= 0) {
+    (void) close(tfd);
+  }
+
+  return status;
+}
+
+void rtExec_printStats(const rtExecStats_T *stats)
+{
+  real_T n = (stats->cycles > 0UL) ? (real_T)stats->cycles : 1.0;
+  if (stats->cycles == 0UL) {
+    (void) printf("rt_executive: no cycles executed\n");
+    return;
+  }
+
+  (void) printf("rt_executive: %lu cycles, %lu deadline misses, %lu skipped releases\n",
+                (unsigned long)stats->cycles, (unsigned long)
+                stats->deadlineMisses, (unsigned long)stats->skippedReleases);
+  (void) printf("  wake-up latency [ns]: min %ld  mean %.0f  max %ld\n", (long)
+                stats->wakeLatencyMinNs, stats->wakeLatencySumNs / n, (long)
+                stats->wakeLatencyMaxNs);
+  (void) printf("  execution time  [ns]: min %ld  mean %.0f  max %ld\n", (long)
+                stats->execTimeMinNs, stats->execTimeSumNs / n, (long)
+                stats->execTimeMaxNs);
+  (void) printf("  SCHED_FIFO %s, CPU affinity %s, memory locked %s\n",
+                stats->schedFifoApplied ? "yes" : "no", stats->affinityApplied ?
+                "yes" : "no", stats->memoryLocked ? "yes" : "no");
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
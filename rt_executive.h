@@ -0,0 +1,95 @@
+
+
+#ifndef rt_executive_h_
+#define rt_executive_h_
+#include "rtwtypes.h"
+
+/*
+ * Periodic real-time executive for Linux.
+ *
+ * Calls a step function at a fixed period on an absolute CLOCK_MONOTONIC
+ * timeline, using either clock_nanosleep(TIMER_ABSTIME) or a timerfd.  The
+ * calling thread can be switched to SCHED_FIFO and pinned to one CPU.  Each
+ * cycle's wake-up latency and execution time are measured, and a cycle
+ * whose step does not finish before the next release is a deadline miss
+ * handled according to the configured overrun policy.
+ */
+
+/* What to do when a step runs past the next release time */
+typedef enum {
+  RT_EXEC_OVERRUN_SKIP = 0,            /* Drop missed releases, realign */
+  RT_EXEC_OVERRUN_CATCH_UP,            /* Run missed releases back to back */
+  RT_EXEC_OVERRUN_ABORT                /* Stop with RT_EXEC_ERR_OVERRUN */
+} rtExecOverrunPolicy_T;
+
+typedef enum {
+  RT_EXEC_TIMER_NANOSLEEP = 0,         /* clock_nanosleep(TIMER_ABSTIME) */
+  RT_EXEC_TIMER_TIMERFD                /* timerfd_create/read */
+} rtExecTimer_T;
+
+/* Return codes of rtExec_run */
+#define RT_EXEC_OK                     (0)
+#define RT_EXEC_ERR_CONFIG             (-1)
+#define RT_EXEC_ERR_TIMER              (-2)
+#define RT_EXEC_ERR_OVERRUN            (-3)
+
+typedef struct {
+  time_T period;                       /* Step period in seconds */
+  int_T priority;                      /* SCHED_FIFO priority, 0 = keep policy */
+  int_T cpu;                           /* CPU to pin to, -1 = no pinning */
+  rtExecOverrunPolicy_T overrunPolicy;
+  rtExecTimer_T timer;
+  uint32_T maxCycles;                  /* Releases to run, 0 = until stopped */
+} rtExecConfig_T;
+
+/* Per-cycle sample, recorded into an optional caller-owned trace buffer */
+typedef struct {
+  uint32_T cycle;                      /* Release index */
+  int32_T wakeLatencyNs;               /* Actual start - scheduled release */
+  int32_T execTimeNs;                  /* Duration of the step call */
+  boolean_T deadlineMiss;              /* Step ended after the next release */
+} rtExecSample_T;
+
+typedef struct {
+  uint32_T cycles;                     /* Steps executed */
+  uint32_T deadlineMisses;             /* Steps that overran their period */
+  uint32_T skippedReleases;            /* Releases dropped by SKIP policy */
+  int32_T wakeLatencyMinNs;
+  int32_T wakeLatencyMaxNs;
+  real_T wakeLatencySumNs;
+  int32_T execTimeMinNs;
+  int32_T execTimeMaxNs;
+  real_T execTimeSumNs;
+  boolean_T schedFifoApplied;          /* SCHED_FIFO request succeeded */
+  boolean_T affinityApplied;           /* CPU pinning request succeeded */
+  boolean_T memoryLocked;              /* mlockall succeeded */
+
+  /* Optional trace buffer, written cyclically; may be NULL */
+  rtExecSample_T *trace;
+  uint32_T traceLength;
+} rtExecStats_T;
+
+/* Step callback; returns false to stop the executive */
+typedef boolean_T (*rtExecStepFcn_T)(void *ctx);
+
+/* Fills cfg with defaults for the given period */
+extern void rtExec_defaultConfig(rtExecConfig_T *cfg, time_T period);
+
+/* Clears the statistics, keeping the trace buffer binding */
+extern void rtExec_resetStats(rtExecStats_T *stats);
+
+/* Runs the periodic loop in the calling thread until the step returns
+ * false, maxCycles is reached or an abort-policy overrun occurs. */
+extern int_T rtExec_run(const rtExecConfig_T *cfg, rtExecStepFcn_T step, void
+  *ctx, rtExecStats_T *stats);
+
+/* Prints a summary of the statistics to stdout */
+extern void rtExec_printStats(const rtExecStats_T *stats);
+
+#endif                                 /* rt_executive_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
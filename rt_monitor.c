@@ -0,0 +1,81 @@
+#include <string.h>
+#include <time.h>
+#include "rt_monitor.h"
+
+void rtMonitor_init(rtMonitor_T *mon)
+{
+  (void) memset(&mon->data, 0, sizeof(rtMonitor_View_T));
+  atomic_init(&mon->seq, 0ULL);
+}
+
+static void *rtMonitor_printerMain(void *arg)
+{
+  rtMonitor_Printer_T *printer = (rtMonitor_Printer_T *)arg;
+  rtMonitor_View_T view;
+  unsigned long long lastSeq = 0ULL;
+  struct timespec next;
+  (void) clock_gettime(CLOCK_MONOTONIC, &next);
+  while (!atomic_load(&printer->stop)) {
+    unsigned long long seq = rtMonitor_read(printer->mon, &view);
+    if (seq == 0ULL) {
+      /* Not a failure before the first publication */
+      if (atomic_load_explicit(&printer->mon->seq, memory_order_relaxed) !=
+          0ULL) {
+        (void) atomic_fetch_add(&printer->failedReads, 1ULL);
+      }
+    } else if (seq != lastSeq) {
+      lastSeq = seq;
+      (void) atomic_fetch_add(&printer->samples, 1ULL);
+      (void) fprintf(printer->file,
+                     "t %10.4f  alpha [% .4e % .4e]  t %10.4f  x [% .4e % .4e"
+                     " % .4e % .4e]  age %llu ns\n", view.t, view.Y.alpha_pitch,
+                     view.Y.alpha_roll, view.tNext, view.X.Filter_CSTATE,
+                     view.X.Integrator_CSTATE, view.X.Filter_CSTATE_f,
+                     view.X.Integrator_CSTATE_i, rtShm_nowNs() - view.stampNs);
+    }
+
+    next.tv_nsec += printer->periodNs;
+    while (next.tv_nsec >= 1000000000L) {
+      next.tv_nsec -= 1000000000L;
+      next.tv_sec++;
+    }
+
+    (void) clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+  }
+
+  return NULL;
+}
+
+int_T rtMonitor_startPrinter(rtMonitor_Printer_T *printer, rtMonitor_T *mon,
+  real_T rateHz, FILE *file)
+{
+  (void) memset(printer, 0, sizeof(rtMonitor_Printer_T));
+  if (!(rateHz > 0.0) || !(rateHz <= 1.0E6)) {
+    return RT_MONITOR_ERR_CONFIG;
+  }
+
+  printer->mon = mon;
+  printer->file = file;
+  printer->periodNs = (long)(1.0E9 / rateHz + 0.5);
+  atomic_init(&printer->stop, false);
+  atomic_init(&printer->samples, 0ULL);
+  atomic_init(&printer->failedReads, 0ULL);
+  if (pthread_create(&printer->thread, NULL, &rtMonitor_printerMain, printer)
+      != 0) {
+    return RT_MONITOR_ERR_THREAD;
+  }
+
+  return RT_MONITOR_OK;
+}
+
+void rtMonitor_stopPrinter(rtMonitor_Printer_T *printer)
+{
+  atomic_store(&printer->stop, true);
+  (void) pthread_join(printer->thread, NULL);
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,111 @@
+
+
+#ifndef rt_monitor_h_
+#define rt_monitor_h_
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include "rtwtypes.h"
+#include "controller.h"
+#include "rt_shm.h"
+
+/*
+ * Latest-value monitor of the controller for low-rate consumers (UI,
+ * health monitor, ground-station bridge).
+ *
+ * The control task publishes a consistent view of the states, block
+ * signals, outputs and timing once per base-rate step with
+ * rtMonitor_publish(), under the same seqlock as the shared-memory rig
+ * (rt_shm.h): the writer never waits for readers, and any number of
+ * readers on any threads copy the latest complete view with
+ * rtMonitor_read(), retrying only if a publication overlaps their copy.
+ * Unlike the telemetry ring nothing is queued; a reader that falls behind
+ * simply sees the newest step.
+ */
+
+/*
+ * View of the model after a base-rate tick.  The outputs Y were computed at
+ * time t, from the states at t; the tick then advanced the states to tNext
+ * and left the block signals as the tick's rates wrote them: the outer loop
+ * outputs '<S1>/Gain' and '<S1>/Gain1' are those the next tick's inner loop
+ * uses, and with the ODE4 solvers the filter coefficients hold the last
+ * minor stage.
+ */
+typedef struct {
+  time_T t;                            /* Model time of the outputs Y */
+  time_T tNext;                        /* Model time of X, start of next tick */
+  uint32_T clockTick0;
+  uint32_T clockTick1;
+  uint32_T TID[2];
+  X_controller_T X;                    /* Continuous states at tNext */
+  B_controller_T B;                    /* Block signals after the tick */
+  ExtY_controller_T Y;                 /* Outputs at t */
+  unsigned long long stampNs;          /* CLOCK_MONOTONIC at publication */
+} rtMonitor_View_T;
+
+/* The sequence gets a cache line of its own; readers polling it for news
+ * do not touch the view the writer is filling */
+typedef struct {
+  _Alignas(RT_SHM_FRAME_SIZE) _Atomic unsigned long long seq;
+  _Alignas(RT_SHM_FRAME_SIZE / 2) rtMonitor_View_T data;
+} rtMonitor_T;
+
+/* Control task: publishes the model's view at the end of a base-rate tick,
+ * after every rate due in it has run */
+static inline void rtMonitor_publish(rtMonitor_T *mon, const
+  RT_MODEL_controller_T *const controller_M)
+{
+  unsigned long long s = rtShm_writeBegin(&mon->seq);
+  mon->data.t = (real_T)(controller_M->Timing.clockTick0 - 1UL) *
+    controller_M->Timing.stepSize0;
+  mon->data.tNext = controller_M->Timing.t[0];
+  mon->data.clockTick0 = controller_M->Timing.clockTick0;
+  mon->data.clockTick1 = controller_M->Timing.clockTick1;
+  mon->data.TID[0] = controller_M->Timing.TaskCounters.TID[0];
+  mon->data.TID[1] = controller_M->Timing.TaskCounters.TID[1];
+  mon->data.X = controller_M->X;
+  mon->data.B = controller_M->B;
+  mon->data.Y = *controller_M->outputs;
+  mon->data.stampNs = rtShm_nowNs();
+  rtShm_writeEnd(&mon->seq, s);
+}
+
+/* Any thread: copies the latest view, returns its (even, nonzero) sequence
+ * or 0 if nothing was published yet or the copy kept being overtaken */
+static inline unsigned long long rtMonitor_read(rtMonitor_T *mon,
+  rtMonitor_View_T *out)
+{
+  return rtShm_read(&mon->seq, &mon->data, out, sizeof(rtMonitor_View_T));
+}
+
+/* Return codes */
+#define RT_MONITOR_OK                  (0)
+#define RT_MONITOR_ERR_CONFIG          (-1)
+#define RT_MONITOR_ERR_THREAD          (-2)
+
+/*
+ * Example consumer: a thread that prints one line per period with the
+ * latest view, as a dashboard or health monitor would sample it.
+ */
+typedef struct {
+  rtMonitor_T *mon;
+  FILE *file;
+  long periodNs;
+  pthread_t thread;
+  atomic_bool stop;
+  _Atomic unsigned long long samples;
+  _Atomic unsigned long long failedReads;
+} rtMonitor_Printer_T;
+
+extern void rtMonitor_init(rtMonitor_T *mon);
+extern int_T rtMonitor_startPrinter(rtMonitor_Printer_T *printer, rtMonitor_T
+  *mon, real_T rateHz, FILE *file);
+extern void rtMonitor_stopPrinter(rtMonitor_Printer_T *printer);
+
+#endif                                 /* rt_monitor_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
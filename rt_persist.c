@@ -0,0 +1,106 @@
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "rt_persist.h"
+
+#ifndef MAP_POPULATE
+#define MAP_POPULATE                   0
+#endif
+
+int_T rtPersist_open(rtPersist_T *persist, const char_T *path)
+{
+  rtPersist_Image_T *image;
+  struct stat st;
+  void *p;
+  int fd;
+  (void) memset(persist, 0, sizeof(rtPersist_T));
+  fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    return RT_PERSIST_ERR_IO;
+  }
+
+  if ((fstat(fd, &st) != 0) || ((st.st_size != (off_t)sizeof
+        (rtPersist_Image_T)) && (ftruncate(fd, (off_t)sizeof(rtPersist_Image_T))
+        != 0))) {
+    (void) close(fd);
+    return RT_PERSIST_ERR_IO;
+  }
+
+  p = mmap(NULL, sizeof(rtPersist_Image_T), PROT_READ | PROT_WRITE, MAP_SHARED
+           | MAP_POPULATE, fd, 0);
+  (void) close(fd);
+  if (p == MAP_FAILED) {
+    return RT_PERSIST_ERR_IO;
+  }
+
+  /* Anything else is reformatted, which invalidates both slots */
+  image = (rtPersist_Image_T *)p;
+  if ((image->magic != RT_PERSIST_MAGIC) || (image->slotSize != (unsigned long
+        long)sizeof(rtPersist_Slot_T))) {
+    (void) memset(p, 0, sizeof(rtPersist_Image_T));
+    image->magic = RT_PERSIST_MAGIC;
+    image->slotSize = (unsigned long long)sizeof(rtPersist_Slot_T);
+  }
+
+  persist->image = image;
+  persist->seq = 0ULL;
+  persist->next = 0UL;
+  return RT_PERSIST_OK;
+}
+
+int_T rtPersist_warmStart(rtPersist_T *persist, RT_MODEL_controller_T *const
+  controller_M)
+{
+  const rtPersist_Slot_T *best = NULL;
+  uint32_T i;
+  for (i = 0UL; i < 2UL; i++) {
+    const rtPersist_Slot_T *slot = &persist->image->slot[i];
+    if ((slot->seq != 0ULL) && (slot->checksum == rtPersist_checksum(slot)) &&
+        ((best == NULL) || (slot->seq > best->seq))) {
+      best = slot;
+    }
+  }
+
+  if (best == NULL) {
+    return RT_PERSIST_COLD;
+  }
+
+  controller_Restore(controller_M, &best->state);
+
+  /* Continue the count and overwrite the other slot first */
+  persist->seq = best->seq;
+  persist->next = (best == &persist->image->slot[0]) ? 1UL : 0UL;
+  return RT_PERSIST_OK;
+}
+
+int_T rtPersist_sync(rtPersist_T *persist)
+{
+  if (msync((void *)persist->image, sizeof(rtPersist_Image_T), MS_SYNC) != 0) {
+    return RT_PERSIST_ERR_IO;
+  }
+
+  return RT_PERSIST_OK;
+}
+
+int_T rtPersist_close(rtPersist_T *persist)
+{
+  int_T status;
+  if (persist->image == NULL) {
+    return RT_PERSIST_OK;
+  }
+
+  status = rtPersist_sync(persist);
+  (void) munmap((void *)persist->image, sizeof(rtPersist_Image_T));
+  persist->image = NULL;
+  return status;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
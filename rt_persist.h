@@ -0,0 +1,105 @@
+
+
+#ifndef rt_persist_h_
+#define rt_persist_h_
+#include <stddef.h>
+#include <string.h>
+#include "rtwtypes.h"
+#include "controller.h"
+
+/*
+ * Crash-consistent persistent image of the controller state.
+ *
+ * The image is a small file mapped MAP_SHARED with two slots, each holding
+ * a controller_Snapshot_T, its save count and a checksum over both.  Every
+ * base-rate step overwrites the older slot in place (a plain memory copy,
+ * no system call); the newer slot is never touched, so a process that dies
+ * at any point, even in the middle of a save, leaves at least one complete
+ * slot behind in the page cache.  After a restart rtPersist_warmStart()
+ * loads the slot with the highest save count whose checksum verifies and
+ * the controller resumes with its integrator and filter states, timing and
+ * parameters intact instead of from zero.
+ *
+ * The kernel writes the image back to storage in the background; call
+ * rtPersist_sync() where it also has to survive a power loss.
+ */
+#define RT_PERSIST_MAGIC               (0x5456435045520001ULL)/* "TVCPER", v1 */
+
+/* Return codes */
+#define RT_PERSIST_OK                  (0)
+#define RT_PERSIST_COLD                (1)  /* No valid slot, model unchanged */
+#define RT_PERSIST_ERR_IO              (-1)
+
+typedef struct {
+  unsigned long long seq;              /* Save count, 0 = never written */
+  controller_Snapshot_T state;
+  unsigned long long checksum;         /* Over seq and state */
+} rtPersist_Slot_T;
+
+/* Layout of the image file */
+typedef struct {
+  unsigned long long magic;
+  unsigned long long slotSize;         /* Rejects images of other builds */
+  rtPersist_Slot_T slot[2];
+} rtPersist_Image_T;
+
+/* Owned by the thread that steps the model */
+typedef struct {
+  rtPersist_Image_T *image;            /* Mapped file */
+  unsigned long long seq;              /* Save count of the newest slot */
+  uint32_T next;                       /* Slot the next save overwrites */
+} rtPersist_T;
+
+/* Fletcher-style sum over the 64-bit words of seq and state; catches torn
+ * and partially written slots */
+static inline unsigned long long rtPersist_checksum(const rtPersist_Slot_T
+  *slot)
+{
+  const char_T *p = (const char_T *)slot;
+  size_t n = offsetof(rtPersist_Slot_T, checksum) / sizeof(unsigned long long);
+  unsigned long long a = RT_PERSIST_MAGIC;
+  unsigned long long b = 0ULL;
+  size_t i;
+  for (i = 0U; i < n; i++) {
+    unsigned long long w;
+    (void) memcpy(&w, &p[i * sizeof(unsigned long long)], sizeof(w));
+    a += w;
+    b += a;
+  }
+
+  return a ^ (b << 1);
+}
+
+/* Maps the image at path, creating an empty one if it does not exist or
+ * was written by an incompatible build */
+extern int_T rtPersist_open(rtPersist_T *persist, const char_T *path);
+
+/* Restores the newest valid slot into an initialized model; RT_PERSIST_COLD
+ * leaves the model as it is */
+extern int_T rtPersist_warmStart(rtPersist_T *persist, RT_MODEL_controller_T *
+  const controller_M);
+
+/* Saves the model state; call between steps */
+static inline void rtPersist_save(rtPersist_T *persist, const
+  RT_MODEL_controller_T *const controller_M)
+{
+  rtPersist_Slot_T *slot = &persist->image->slot[persist->next];
+  slot->seq = ++persist->seq;
+  controller_Snapshot(controller_M, &slot->state);
+  slot->checksum = rtPersist_checksum(slot);
+  persist->next ^= 1UL;
+}
+
+/* Writes the image back to storage and waits for it */
+extern int_T rtPersist_sync(rtPersist_T *persist);
+
+/* Syncs and unmaps the image */
+extern int_T rtPersist_close(rtPersist_T *persist);
+
+#endif                                 /* rt_persist_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,115 @@
+#define _POSIX_C_SOURCE                199309L
+
+#include "rt_probe.h"
+#ifdef CONTROLLER_PROBES
+
+#include <string.h>
+#include <time.h>
+
+rtProbe_Hist_T rtProbe_hist[RT_PROBE_NUM];
+
+static const char_T *const rtProbe_names[RT_PROBE_NUM] = {
+  "controller_step0", "controller_step1", "<S40>/Filter Coefficient",
+  "<S90>/Filter Coefficient", "<S32>/Filter (derivative)",
+  "<S37>/Integrator (derivative)", "<S82>/Filter (derivative)",
+  "<S87>/Integrator (derivative)", "ode4 stage 1", "ode4 stage 2",
+  "ode4 stage 3", "ode4 stage 4", "ode4 update", "ode4-fused update",
+  "discrete update"
+};
+
+/* Lower bound of a bucket, inverse of rtProbe_bucket */
+static rtProbe_Tick_T rtProbe_bucketValue(int_T b)
+{
+  int_T shift;
+  if (b < RT_PROBE_SUB_COUNT) {
+    return (rtProbe_Tick_T)b;
+  }
+
+  shift = b / RT_PROBE_SUB_COUNT - 1;
+  return ((rtProbe_Tick_T)(RT_PROBE_SUB_COUNT + b % RT_PROBE_SUB_COUNT)) <<
+    shift;
+}
+
+static rtProbe_Tick_T rtProbe_percentile(const rtProbe_Hist_T *h, real_T p)
+{
+  unsigned long long rank = (unsigned long long)(p * (real_T)h->count);
+  unsigned long long seen = 0ULL;
+  int_T b;
+  if (rank >= h->count) {
+    return h->max;
+  }
+
+  for (b = 0; b < RT_PROBE_NUM_BUCKETS; b++) {
+    seen += h->buckets[b];
+    if (seen > rank) {
+      rtProbe_Tick_T v = rtProbe_bucketValue(b);
+      return (v < h->min) ? h->min : v;
+    }
+  }
+
+  return h->max;
+}
+
+/* Nanoseconds per tick, measured against CLOCK_MONOTONIC once */
+static real_T rtProbe_nsPerTick(void)
+{
+  static real_T nsPerTick = 0.0;
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  if (nsPerTick == 0.0) {
+    struct timespec t0;
+    struct timespec t1;
+    struct timespec nap = { 0, 20000000L };
+    rtProbe_Tick_T c0;
+    rtProbe_Tick_T c1;
+    (void) clock_gettime(CLOCK_MONOTONIC, &t0);
+    c0 = rtProbe_now();
+    (void) nanosleep(&nap, NULL);
+    (void) clock_gettime(CLOCK_MONOTONIC, &t1);
+    c1 = rtProbe_now();
+    nsPerTick = ((real_T)(t1.tv_sec - t0.tv_sec) * 1.0E+9 + (real_T)
+                 (t1.tv_nsec - t0.tv_nsec)) / (real_T)(c1 - c0);
+  }
+
+#else
+
+  nsPerTick = 1.0;
+
+#endif
+
+  return nsPerTick;
+}
+
+void rtProbe_reset(void)
+{
+  (void) memset(rtProbe_hist, 0, sizeof(rtProbe_hist));
+}
+
+void rtProbe_dump(FILE *f)
+{
+  real_T k = rtProbe_nsPerTick();
+  int_T i;
+  (void) fprintf(f, "%-32s %12s %10s %10s %10s %10s %10s %10s [ns]\n", "probe",
+                 "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+  for (i = 0; i < (int_T)RT_PROBE_NUM; i++) {
+    const rtProbe_Hist_T *h = &rtProbe_hist[i];
+    if (h->count == 0ULL) {
+      continue;
+    }
+
+    (void) fprintf(f, "%-32s %12llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                   rtProbe_names[i], h->count, k * (real_T)h->sum / (real_T)
+                   h->count, k * (real_T)rtProbe_percentile(h, 0.5), k * (real_T)
+                   rtProbe_percentile(h, 0.9), k * (real_T)rtProbe_percentile(h,
+      0.99), k * (real_T)rtProbe_percentile(h, 0.999), k * (real_T)h->max);
+  }
+}
+
+#endif                                 /* CONTROLLER_PROBES */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
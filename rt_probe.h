@@ -0,0 +1,134 @@
+
+
+#ifndef rt_probe_h_
+#define rt_probe_h_
+#include "rtwtypes.h"
+
+/*
+ * Compile-time removable timing probes.
+ *
+ * Build with -DCONTROLLER_PROBES to time sections of the model step and
+ * attribute them to Simulink blocks and solver stages.  Each probe feeds a
+ * log-linear (HDR-style) histogram with 16 sub-buckets per power of two,
+ * i.e. about 6% value resolution over the full 64-bit range, so recording
+ * is a handful of integer operations and no allocation.  Timestamps come
+ * from the TSC on x86 and from CLOCK_MONOTONIC elsewhere.
+ *
+ * Without CONTROLLER_PROBES the probe macros expand to nothing and the
+ * instrumented code compiles exactly as before.
+ *
+ * The histograms are process-wide and updated without atomics; with
+ * several threads stepping instances at once, counts may be lost.
+ */
+#ifdef CONTROLLER_PROBES
+
+#include <stdio.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+typedef enum {
+  RT_PROBE_STEP0 = 0,                  /* controller_step0, major steps */
+  RT_PROBE_STEP1,                      /* controller_step1 */
+  RT_PROBE_S40_FILTER_COEFFICIENT,     /* '<S40>/Filter Coefficient' */
+  RT_PROBE_S90_FILTER_COEFFICIENT,     /* '<S90>/Filter Coefficient' */
+  RT_PROBE_S32_FILTER_DERIV,           /* Derivatives for '<S32>/Filter' */
+  RT_PROBE_S37_INTEGRATOR_DERIV,       /* Derivatives for '<S37>/Integrator' */
+  RT_PROBE_S82_FILTER_DERIV,           /* Derivatives for '<S82>/Filter' */
+  RT_PROBE_S87_INTEGRATOR_DERIV,       /* Derivatives for '<S87>/Integrator' */
+  RT_PROBE_ODE4_STAGE1,                /* f0 = f(t, y) */
+  RT_PROBE_ODE4_STAGE2,                /* f1 = f(t + h/2, y + h/2*f0) */
+  RT_PROBE_ODE4_STAGE3,                /* f2 = f(t + h/2, y + h/2*f1) */
+  RT_PROBE_ODE4_STAGE4,                /* f3 = f(t + h, y + h*f2) */
+  RT_PROBE_ODE4_UPDATE,                /* ynew = y + h/6*(...) */
+  RT_PROBE_SOLVER_FUSED,               /* rt_ertODE4FusedUpdateStates */
+  RT_PROBE_SOLVER_DISCRETE,            /* rt_ertDiscreteUpdateStates */
+  RT_PROBE_NUM
+} rtProbe_Id_T;
+
+typedef unsigned long long rtProbe_Tick_T;
+
+#define RT_PROBE_SUB_BITS              4
+#define RT_PROBE_SUB_COUNT             (1 << RT_PROBE_SUB_BITS)
+#define RT_PROBE_NUM_BUCKETS           ((64 - RT_PROBE_SUB_BITS + 1) * RT_PROBE_SUB_COUNT)
+
+typedef struct {
+  unsigned long long count;
+  rtProbe_Tick_T min;
+  rtProbe_Tick_T max;
+  rtProbe_Tick_T sum;
+  uint32_T buckets[RT_PROBE_NUM_BUCKETS];
+} rtProbe_Hist_T;
+
+extern rtProbe_Hist_T rtProbe_hist[RT_PROBE_NUM];
+
+static inline rtProbe_Tick_T rtProbe_now(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return (rtProbe_Tick_T)__rdtsc();
+#else
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (rtProbe_Tick_T)ts.tv_sec * 1000000000ULL + (rtProbe_Tick_T)ts.tv_nsec;
+#endif
+}
+
+/* Bucket of a value: exact below RT_PROBE_SUB_COUNT, log-linear above */
+static inline int_T rtProbe_bucket(rtProbe_Tick_T v)
+{
+  int_T shift;
+  if (v < (rtProbe_Tick_T)RT_PROBE_SUB_COUNT) {
+    return (int_T)v;
+  }
+
+  shift = 63 - __builtin_clzll(v) - RT_PROBE_SUB_BITS;
+  return (shift + 1) * RT_PROBE_SUB_COUNT + (int_T)((v >> shift) &
+    (rtProbe_Tick_T)(RT_PROBE_SUB_COUNT - 1));
+}
+
+static inline void rtProbe_record(rtProbe_Id_T id, rtProbe_Tick_T dt)
+{
+  rtProbe_Hist_T *h = &rtProbe_hist[id];
+  if ((h->count == 0ULL) || (dt < h->min)) {
+    h->min = dt;
+  }
+
+  if (dt > h->max) {
+    h->max = dt;
+  }
+
+  h->count++;
+  h->sum += dt;
+  h->buckets[rtProbe_bucket(dt)]++;
+}
+
+#define RT_PROBE_BEGIN(id)             rtProbe_Tick_T rtProbe_t0_ ## id = rtProbe_now()
+#define RT_PROBE_END(id)               rtProbe_record((id), rtProbe_now() - rtProbe_t0_ ## id)
+
+/* For a section that begins and ends in different blocks: declare the
+ * probe in the enclosing block, then START and END it */
+#define RT_PROBE_DECLARE(id)           rtProbe_Tick_T rtProbe_t0_ ## id = 0ULL
+#define RT_PROBE_START(id)             (rtProbe_t0_ ## id = rtProbe_now())
+
+/* Clears all histograms */
+extern void rtProbe_reset(void);
+
+/* Prints count, mean and percentiles of every probe that fired, in ns */
+extern void rtProbe_dump(FILE *f);
+
+#else
+
+#define RT_PROBE_BEGIN(id)
+#define RT_PROBE_END(id)
+#define RT_PROBE_DECLARE(id)
+#define RT_PROBE_START(id)
+#endif                                 /* CONTROLLER_PROBES */
+#endif                                 /* rt_probe_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
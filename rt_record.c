@@ -0,0 +1,177 @@
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "rt_record.h"
+
+#ifndef MAP_POPULATE
+#define MAP_POPULATE                   0
+#endif
+
+int_T rtRecord_start(rtRecord_T *rec, const char_T *path, unsigned long long
+                     capacity, const RT_MODEL_controller_T *controller_M)
+{
+  rtRecord_FileHeader_T *hdr;
+  void *p;
+  (void) memset(rec, 0, sizeof(rtRecord_T));
+  rec->fd = -1;
+  if (capacity == 0ULL) {
+    return RT_RECORD_ERR_FORMAT;
+  }
+
+  rec->mapSize = sizeof(rtRecord_FileHeader_T) + (size_t)capacity * sizeof
+    (rtRecord_Entry_T);
+  rec->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (rec->fd < 0) {
+    return RT_RECORD_ERR_IO;
+  }
+
+  if (ftruncate(rec->fd, (off_t)rec->mapSize) != 0) {
+    (void) close(rec->fd);
+    rec->fd = -1;
+    return RT_RECORD_ERR_IO;
+  }
+
+  p = mmap(NULL, rec->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED |
+           MAP_POPULATE, rec->fd, 0);
+  if (p == MAP_FAILED) {
+    (void) close(rec->fd);
+    rec->fd = -1;
+    return RT_RECORD_ERR_ALLOC;
+  }
+
+  hdr = (rtRecord_FileHeader_T *)p;
+  (void) memcpy(hdr->magic, RT_RECORD_MAGIC, sizeof(RT_RECORD_MAGIC));
+  hdr->headerSize = (unsigned long long)sizeof(rtRecord_FileHeader_T);
+  hdr->entrySize = (unsigned long long)sizeof(rtRecord_Entry_T);
+  hdr->numEntries = 0ULL;
+  hdr->numSteps = 0ULL;
+  hdr->dropped = 0ULL;
+  controller_Snapshot(controller_M, &hdr->state);
+  rec->paramsInUse = controller_M->ParamBank.inUse;
+  rec->header = hdr;
+  rec->entries = (rtRecord_Entry_T *)(hdr + 1);
+  rec->capacity = capacity;
+  rec->count = 0ULL;
+  rec->t0Ns = rtRecord_nowNs();
+  return RT_RECORD_OK;
+}
+
+int_T rtRecord_stop(rtRecord_T *rec)
+{
+  int_T status = RT_RECORD_OK;
+  size_t used;
+  if (rec->header == NULL) {
+    return RT_RECORD_OK;
+  }
+
+  used = sizeof(rtRecord_FileHeader_T) + (size_t)rec->count * sizeof
+    (rtRecord_Entry_T);
+  rec->header->numEntries = rec->count;
+  if (msync((void *)rec->header, used, MS_SYNC) != 0) {
+    status = RT_RECORD_ERR_IO;
+  }
+
+  (void) munmap((void *)rec->header, rec->mapSize);
+  if (ftruncate(rec->fd, (off_t)used) != 0) {
+    status = RT_RECORD_ERR_IO;
+  }
+
+  if (close(rec->fd) != 0) {
+    status = RT_RECORD_ERR_IO;
+  }
+
+  rec->header = NULL;
+  rec->entries = NULL;
+  rec->fd = -1;
+  return status;
+}
+
+int_T rtRecord_replay(const char_T *path, rtRecord_ReplayResult_T *result)
+{
+  RT_MODEL_controller_T *controller_M;
+  const rtRecord_FileHeader_T *hdr;
+  const rtRecord_Entry_T *entries;
+  struct stat st;
+  unsigned long long t0;
+  unsigned long long i;
+  void *p;
+  int fd;
+  (void) memset(result, 0, sizeof(rtRecord_ReplayResult_T));
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return RT_RECORD_ERR_IO;
+  }
+
+  if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof
+       (rtRecord_FileHeader_T))) {
+    (void) close(fd);
+    return RT_RECORD_ERR_FORMAT;
+  }
+
+  p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd,
+           0);
+  (void) close(fd);
+  if (p == MAP_FAILED) {
+    return RT_RECORD_ERR_IO;
+  }
+
+  hdr = (const rtRecord_FileHeader_T *)p;
+  entries = (const rtRecord_Entry_T *)(hdr + 1);
+  if ((memcmp(hdr->magic, RT_RECORD_MAGIC, sizeof(RT_RECORD_MAGIC)) != 0) ||
+      (hdr->headerSize != sizeof(rtRecord_FileHeader_T)) || (hdr->entrySize !=
+       sizeof(rtRecord_Entry_T)) || ((unsigned long long)st.st_size <
+       sizeof(rtRecord_FileHeader_T) + hdr->numEntries * sizeof
+       (rtRecord_Entry_T))) {
+    (void) munmap(p, (size_t)st.st_size);
+    return RT_RECORD_ERR_FORMAT;
+  }
+
+  controller_M = (RT_MODEL_controller_T *)malloc(sizeof(RT_MODEL_controller_T));
+  if (controller_M == NULL) {
+    (void) munmap(p, (size_t)st.st_size);
+    return RT_RECORD_ERR_ALLOC;
+  }
+
+  /* Bring a fresh instance to the recorded starting point */
+  controller_initialize(controller_M);
+  controller_Restore(controller_M, &hdr->state);
+  t0 = rtRecord_nowNs();
+  for (i = 0ULL; i < hdr->numEntries; i++) {
+    const rtRecord_Entry_T *e = &entries[i];
+    if (e->kind == (unsigned long long)RT_RECORD_ENTRY_PARAMS) {
+      (void) controller_SetParams(controller_M, &e->data.params);
+      continue;
+    }
+
+    *rtmGetU(controller_M) = e->data.step.U;
+    controller_step(controller_M);
+
+    if (memcmp(rtmGetY(controller_M), &e->data.step.Y, sizeof
+               (ExtY_controller_T)) != 0) {
+      if (result->mismatches == 0ULL) {
+        result->firstMismatch = result->steps;
+      }
+
+      result->mismatches++;
+    }
+
+    result->steps++;
+  }
+
+  result->replaySeconds = (real_T)(rtRecord_nowNs() - t0) * 1.0E-9;
+  result->recordedTime = (real_T)result->steps * hdr->state.Timing.stepSize0;
+  result->dropped = hdr->dropped;
+  free(controller_M);
+  (void) munmap(p, (size_t)st.st_size);
+  return RT_RECORD_OK;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,149 @@
+
+
+#ifndef rt_record_h_
+#define rt_record_h_
+#include <string.h>
+#include <time.h>
+#include "rtwtypes.h"
+#include "controller.h"
+
+/*
+ * Deterministic record/replay of the controller.
+ *
+ * A recording holds everything a run of the step functions consumes: a
+ * controller_Snapshot_T of the model at the start (in the file header),
+ * then one entry per base-rate step
+ * with the inports the step read and the outports it wrote, preceded by a
+ * parameter entry whenever a new set from controller_SetParams took effect.
+ * Steps are stamped with the time since the recording started.
+ *
+ * The log file is preallocated for a fixed number of entries and mapped
+ * with MAP_POPULATE, so rtRecord_step() is a copy into memory with no
+ * system call and no page fault; the kernel writes the pages back in the
+ * background.  When the log is full further steps are counted as dropped.
+ * rtRecord_stop() trims the file to the entries written.
+ *
+ * rtRecord_replay() feeds a log back into a fresh model instance as fast as
+ * the CPU allows through controller_step, which runs the rates in the
+ * order of rt_OneStep, and compares every output bit for bit with the
+ * recording.
+ */
+#define RT_RECORD_MAGIC                "TVCREC3"
+
+/* Return codes */
+#define RT_RECORD_OK                   (0)
+#define RT_RECORD_ERR_IO               (-1)
+#define RT_RECORD_ERR_FORMAT           (-2)
+#define RT_RECORD_ERR_ALLOC            (-3)
+
+typedef enum {
+  RT_RECORD_ENTRY_STEP = 0,
+  RT_RECORD_ENTRY_PARAMS
+} rtRecord_EntryKind_T;
+
+/* One log entry */
+typedef struct {
+  unsigned long long kind;             /* rtRecord_EntryKind_T */
+  unsigned long long stampNs;          /* Since the start of the recording */
+  union {
+    struct {
+      ExtU_controller_T U;             /* Inports read by the step */
+      ExtY_controller_T Y;             /* Outports written by the step */
+    } step;
+
+    P_controller_T params;             /* Set taking effect at the next step */
+  } data;
+} rtRecord_Entry_T;
+
+/* File header, followed by numEntries entries */
+typedef struct {
+  char_T magic[8];
+  unsigned long long headerSize;
+  unsigned long long entrySize;
+  unsigned long long numEntries;       /* Written by rtRecord_stop */
+  unsigned long long numSteps;
+  unsigned long long dropped;          /* Steps after the log was full */
+  controller_Snapshot_T state;         /* Model at the start of the recording */
+} rtRecord_FileHeader_T;
+
+/* Recorder, owned by the thread that steps the model */
+typedef struct {
+  rtRecord_FileHeader_T *header;       /* Mapped file */
+  rtRecord_Entry_T *entries;
+  unsigned long long capacity;
+  unsigned long long count;
+  unsigned long long t0Ns;
+  uint32_T paramsInUse;                /* Bank of the last recorded set */
+  size_t mapSize;
+  int fd;
+} rtRecord_T;
+
+/* Result of rtRecord_replay */
+typedef struct {
+  unsigned long long steps;            /* Steps replayed */
+  unsigned long long mismatches;       /* Steps whose outputs differ */
+  unsigned long long firstMismatch;    /* Step index, valid if mismatches */
+  unsigned long long dropped;          /* Steps the recorder could not log */
+  time_T recordedTime;                 /* Model time covered by the log */
+  real_T replaySeconds;                /* Wall time of the replay */
+} rtRecord_ReplayResult_T;
+
+static inline unsigned long long rtRecord_nowNs(void)
+{
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)
+    ts.tv_nsec;
+}
+
+/* Creates the log for up to capacity entries and snapshots the model */
+extern int_T rtRecord_start(rtRecord_T *rec, const char_T *path, unsigned long
+  long capacity, const RT_MODEL_controller_T *controller_M);
+
+/* Records one base-rate step; call after every rate due in it has run */
+static inline void rtRecord_step(rtRecord_T *rec, const RT_MODEL_controller_T
+  *const controller_M)
+{
+  unsigned long long now = rtRecord_nowNs() - rec->t0Ns;
+  rtRecord_Entry_T *e;
+  rec->header->numSteps++;
+  if (controller_M->ParamBank.inUse != rec->paramsInUse) {
+    if (rec->count >= rec->capacity) {
+      rec->header->dropped++;
+      return;
+    }
+
+    rec->paramsInUse = controller_M->ParamBank.inUse;
+    e = &rec->entries[rec->count++];
+    e->kind = (unsigned long long)RT_RECORD_ENTRY_PARAMS;
+    e->stampNs = now;
+    e->data.params = controller_M->ParamBank.bank[rec->paramsInUse];
+  }
+
+  if (rec->count >= rec->capacity) {
+    rec->header->dropped++;
+    return;
+  }
+
+  e = &rec->entries[rec->count++];
+  e->kind = (unsigned long long)RT_RECORD_ENTRY_STEP;
+  e->stampNs = now;
+  e->data.step.U = *controller_M->inputs;
+  e->data.step.Y = *controller_M->outputs;
+}
+
+/* Finalizes the header, trims and closes the log */
+extern int_T rtRecord_stop(rtRecord_T *rec);
+
+/* Replays the log at path; RT_RECORD_OK even when outputs differ or steps
+ * were dropped, see result->mismatches and result->dropped */
+extern int_T rtRecord_replay(const char_T *path, rtRecord_ReplayResult_T
+  *result);
+
+#endif                                 /* rt_record_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
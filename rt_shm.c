@@ -0,0 +1,65 @@
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "rt_shm.h"
+
+#ifndef MAP_POPULATE
+#define MAP_POPULATE                   0
+#endif
+
+int_T rtShm_open(const char_T *name, rtShm_Region_T **region)
+{
+  struct stat st;
+  unsigned long long expected = 0ULL;
+  void *p;
+  int fd = shm_open(name, O_RDWR | O_CREAT, 0600);
+  *region = NULL;
+  if (fd < 0) {
+    return RT_SHM_ERR_OPEN;
+  }
+
+  /* A new object is zero-filled, i.e. both frames are unwritten */
+  if ((fstat(fd, &st) != 0) || ((st.st_size < (off_t)sizeof(rtShm_Region_T))
+       && (ftruncate(fd, (off_t)sizeof(rtShm_Region_T)) != 0))) {
+    (void) close(fd);
+    return RT_SHM_ERR_OPEN;
+  }
+
+  p = mmap(NULL, sizeof(rtShm_Region_T), PROT_READ | PROT_WRITE, MAP_SHARED |
+           MAP_POPULATE, fd, 0);
+  (void) close(fd);
+  if (p == MAP_FAILED) {
+    return RT_SHM_ERR_MAP;
+  }
+
+  /* The first process to map the object stamps the layout version */
+  if (!atomic_compare_exchange_strong(&((rtShm_Region_T *)p)->magic, &expected,
+       RT_SHM_MAGIC) && (expected != RT_SHM_MAGIC)) {
+    (void) munmap(p, sizeof(rtShm_Region_T));
+    return RT_SHM_ERR_VERSION;
+  }
+
+  *region = (rtShm_Region_T *)p;
+  return RT_SHM_OK;
+}
+
+void rtShm_close(rtShm_Region_T *region)
+{
+  if (region != NULL) {
+    (void) munmap((void *)region, sizeof(rtShm_Region_T));
+  }
+}
+
+void rtShm_unlink(const char_T *name)
+{
+  (void) shm_unlink(name);
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,173 @@
+
+
+#ifndef rt_shm_h_
+#define rt_shm_h_
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include "rtwtypes.h"
+#include "controller.h"
+
+/*
+ * Shared-memory transport between the sensor process, the controller and
+ * the actuator process.
+ *
+ * One POSIX shared-memory object holds a sensor frame, written by the IMU
+ * driver, and an actuator frame, written by the controller.  Each frame is
+ * protected by a seqlock: the single writer makes the sequence odd, writes
+ * the payload and makes the sequence even again; readers copy the payload
+ * between two reads of the same even sequence and retry otherwise.
+ * Neither side locks, blocks or enters the kernel on the hot path, and
+ * frames never tear.  The object is mapped with MAP_POPULATE so that no
+ * page fault happens on first access either.
+ *
+ * The controller reads the sensor frame straight into its inports, steps
+ * into its own outports and then copies them with the stamps into the
+ * actuator payload in a write section of a few stores.  The solver step
+ * stays outside the section: with ROS2 or ODE45 it can take many substeps,
+ * and readers would spin on the odd sequence meanwhile.
+ * Each frame occupies two cache lines of its own so that the adjacent-line
+ * prefetcher does not couple the sensor and actuator sides.
+ *
+ * Frames carry CLOCK_MONOTONIC publication stamps (read through the vDSO,
+ * without a system call) so readers can measure handoff latency.
+ */
+#define RT_SHM_DEFAULT_NAME            "/tvc_rig"
+#define RT_SHM_MAGIC                   (0x54564353484D0001ULL)/* "TVCSHM", v1 */
+#define RT_SHM_FRAME_SIZE              128
+
+/* Reads of a frame that is being written give up after this many tries and
+ * leave the caller's copy unchanged, so a writer that died inside its write
+ * section cannot stall a reader */
+#define RT_SHM_READ_TRIES              (1000)
+
+/* Return codes of rtShm_open */
+#define RT_SHM_OK                      (0)
+#define RT_SHM_ERR_OPEN                (-1)
+#define RT_SHM_ERR_MAP                 (-2)
+#define RT_SHM_ERR_VERSION             (-3)
+
+/* Sensor frame payload */
+typedef struct {
+  ExtU_controller_T U;                 /* Attitude, rates and setpoints */
+  unsigned long long stampNs;          /* Publication time */
+} rtShm_SensorPayload_T;
+
+/* Actuator frame payload */
+typedef struct {
+  ExtY_controller_T Y;                 /* Gimbal commands */
+  unsigned long long stampNs;          /* Publication time */
+  unsigned long long sensorStampNs;    /* Stamp of the sensor frame used */
+  unsigned long long sensorSeq;        /* Sequence of the sensor frame used */
+} rtShm_ActuatorPayload_T;
+
+typedef struct {
+  _Atomic unsigned long long seq;      /* Odd while being written */
+  rtShm_SensorPayload_T data;
+  char_T pad[RT_SHM_FRAME_SIZE - sizeof(unsigned long long) - sizeof
+    (rtShm_SensorPayload_T)];
+} rtShm_SensorFrame_T;
+
+typedef struct {
+  _Atomic unsigned long long seq;      /* Odd while being written */
+  rtShm_ActuatorPayload_T data;
+  char_T pad[RT_SHM_FRAME_SIZE - sizeof(unsigned long long) - sizeof
+    (rtShm_ActuatorPayload_T)];
+} rtShm_ActuatorFrame_T;
+
+/* Layout of the shared-memory object */
+typedef struct {
+  _Atomic unsigned long long magic;
+  char_T pad[RT_SHM_FRAME_SIZE - sizeof(unsigned long long)];
+  rtShm_SensorFrame_T sensor;
+  rtShm_ActuatorFrame_T actuator;
+} rtShm_Region_T;
+
+/* Opens (creating if needed) and maps the named object; every process of
+ * the rig calls this with the same name, in any order */
+extern int_T rtShm_open(const char_T *name, rtShm_Region_T **region);
+extern void rtShm_close(rtShm_Region_T *region);
+
+/* Removes the name; mappings stay valid until closed */
+extern void rtShm_unlink(const char_T *name);
+
+/* CLOCK_MONOTONIC in nanoseconds */
+static inline unsigned long long rtShm_nowNs(void)
+{
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)
+    ts.tv_nsec;
+}
+
+/* Writer: opens a write section, returns the sequence to pass to
+ * rtShm_writeEnd */
+static inline unsigned long long rtShm_writeBegin(_Atomic unsigned long long
+  *seq)
+{
+  unsigned long long s = atomic_load_explicit(seq, memory_order_relaxed) + 1ULL;
+  atomic_store_explicit(seq, s, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  return s;
+}
+
+static inline void rtShm_writeEnd(_Atomic unsigned long long *seq, unsigned
+  long long s)
+{
+  atomic_store_explicit(seq, s + 1ULL, memory_order_release);
+}
+
+/* Reader: copies size bytes of a frame payload, returns the (even)
+ * sequence of the copy or 0 after RT_SHM_READ_TRIES failed attempts or
+ * while the frame has never been written */
+static inline unsigned long long rtShm_read(_Atomic unsigned long long *seq,
+  const void *payload, void *out, size_t size)
+{
+  int_T i;
+  for (i = 0; i < RT_SHM_READ_TRIES; i++) {
+    unsigned long long s0 = atomic_load_explicit(seq, memory_order_acquire);
+    if ((s0 & 1ULL) == 0ULL) {
+      (void) memcpy(out, payload, size);
+      atomic_thread_fence(memory_order_acquire);
+      if (atomic_load_explicit(seq, memory_order_relaxed) == s0) {
+        return s0;
+      }
+    }
+  }
+
+  return 0ULL;
+}
+
+/* Sensor process: publishes one sensor frame */
+static inline void rtShm_writeSensors(rtShm_Region_T *region, const
+  ExtU_controller_T *U)
+{
+  unsigned long long s = rtShm_writeBegin(&region->sensor.seq);
+  region->sensor.data.U = *U;
+  region->sensor.data.stampNs = rtShm_nowNs();
+  rtShm_writeEnd(&region->sensor.seq, s);
+}
+
+/* Latest sensor frame, see rtShm_read for the return value */
+static inline unsigned long long rtShm_readSensors(rtShm_Region_T *region,
+  rtShm_SensorPayload_T *out)
+{
+  return rtShm_read(&region->sensor.seq, &region->sensor.data, out, sizeof
+                    (rtShm_SensorPayload_T));
+}
+
+/* Latest actuator frame, see rtShm_read for the return value */
+static inline unsigned long long rtShm_readActuators(rtShm_Region_T *region,
+  rtShm_ActuatorPayload_T *out)
+{
+  return rtShm_read(&region->actuator.seq, &region->actuator.data, out, sizeof
+                    (rtShm_ActuatorPayload_T));
+}
+
+#endif                                 /* rt_shm_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
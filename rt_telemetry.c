@@ -0,0 +1,176 @@
+#define _POSIX_C_SOURCE                200809L
+
+#include <string.h>
+#include <time.h>
+#include "rt_telemetry.h"
+#include "controller_private.h"
+
+/* Records moved from the ring to the file per write */
+#define RT_TELEMETRY_BATCH             256U
+
+int_T rtTelemetry_init(rtTelemetry_T *ring, rtTelemetry_Record_T *storage,
+  uint32_T capacity)
+{
+  if ((storage == NULL) || (capacity == 0U) || ((capacity & (capacity - 1U))
+       != 0U)) {
+    return RT_TELEMETRY_ERR_CONFIG;
+  }
+
+  (void) memset(ring, 0, sizeof(rtTelemetry_T));
+  atomic_init(&ring->head, 0ULL);
+  atomic_init(&ring->dropped, 0ULL);
+  atomic_init(&ring->tail, 0ULL);
+  ring->slots = storage;
+  ring->mask = (unsigned long long)capacity - 1ULL;
+  return RT_TELEMETRY_OK;
+}
+
+uint32_T rtTelemetry_drain(rtTelemetry_T *ring, rtTelemetry_Record_T *out,
+  uint32_T maxRecords)
+{
+  unsigned long long tail = atomic_load_explicit(&ring->tail,
+    memory_order_relaxed);
+  unsigned long long avail = ring->headCache - tail;
+  uint32_T n;
+  uint32_T i;
+  if (avail < (unsigned long long)maxRecords) {
+    ring->headCache = atomic_load_explicit(&ring->head, memory_order_acquire);
+    avail = ring->headCache - tail;
+  }
+
+  n = (avail < (unsigned long long)maxRecords) ? (uint32_T)avail : maxRecords;
+  for (i = 0U; i < n; i++) {
+    out[i] = ring->slots[(tail + i) & ring->mask];
+  }
+
+  /* Release the slots back to the producer only after they are copied */
+  atomic_store_explicit(&ring->tail, tail + n, memory_order_release);
+  return n;
+}
+
+/*
+ * The filter coefficients are recomputed from the states at t as the major
+ * step computed them: the ODE4 solvers leave the last minor stage's values
+ * in the block I/O.
+ */
+void rtTelemetry_captureOutputs(const RT_MODEL_controller_T *const
+  controller_M, rtTelemetry_Record_T *rec)
+{
+  const P_controller_T *controller_P = controller_GetParams(controller_M);
+  rec->FilterCoefficient = (controller_M->B.DerivativeGain -
+    rec->X.Filter_CSTATE) * controller_P->PIDController_N;
+  rec->FilterCoefficient_c = (controller_M->B.DerivativeGain_b -
+    rec->X.Filter_CSTATE_f) * controller_P->PIDController1_N;
+  rec->rateCmd[0] = controller_M->B.Gain;
+  rec->rateCmd[1] = controller_M->B.Gain1;
+  rec->alphaCmd[0] = controller_M->outputs->alpha_pitch;
+  rec->alphaCmd[1] = controller_M->outputs->alpha_roll;
+}
+
+static boolean_T rtTelemetry_write(rtTelemetry_Logger_T *logger, const
+  rtTelemetry_Record_T *recs, uint32_T n)
+{
+  uint32_T i;
+  if (logger->format == RT_TELEMETRY_FORMAT_BINARY) {
+    return (boolean_T)(fwrite(recs, sizeof(rtTelemetry_Record_T), (size_t)n,
+      logger->file) == (size_t)n);
+  }
+
+  for (i = 0U; i < n; i++) {
+    const rtTelemetry_Record_T *r = &recs[i];
+    if (fprintf(logger->file,
+                "%llu,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,"
+                "%.17g,%.17g\n", r->seq, r->t, r->X.Filter_CSTATE,
+                r->X.Integrator_CSTATE, r->X.Filter_CSTATE_f,
+                r->X.Integrator_CSTATE_i, r->FilterCoefficient,
+                r->FilterCoefficient_c, r->rateCmd[0], r->rateCmd[1],
+                r->alphaCmd[0], r->alphaCmd[1]) < 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void *rtTelemetry_loggerMain(void *arg)
+{
+  rtTelemetry_Logger_T *logger = (rtTelemetry_Logger_T *)arg;
+  rtTelemetry_Record_T batch[RT_TELEMETRY_BATCH];
+  for (;;) {
+    /* Read the stop request before draining so nothing published before it
+     * is left behind */
+    boolean_T stopping = atomic_load(&logger->stop);
+    uint32_T n = rtTelemetry_drain(logger->ring, batch, RT_TELEMETRY_BATCH);
+    if (n > 0U) {
+      if (!rtTelemetry_write(logger, batch, n)) {
+        atomic_store(&logger->ioError, true);
+      }
+
+      (void) atomic_fetch_add(&logger->written, (unsigned long long)n);
+    } else if (stopping) {
+      break;
+    } else {
+      struct timespec nap = { 0, 1000000L };
+      (void) nanosleep(&nap, NULL);
+    }
+  }
+
+  return NULL;
+}
+
+int_T rtTelemetry_startLogger(rtTelemetry_Logger_T *logger, rtTelemetry_T
+  *ring, const char_T *path, rtTelemetry_Format_T format)
+{
+  (void) memset(logger, 0, sizeof(rtTelemetry_Logger_T));
+  logger->ring = ring;
+  logger->format = format;
+  atomic_init(&logger->stop, false);
+  atomic_init(&logger->ioError, false);
+  atomic_init(&logger->written, 0ULL);
+  logger->file = fopen(path, (format == RT_TELEMETRY_FORMAT_BINARY) ? "wb" :
+                       "w");
+  if (logger->file == NULL) {
+    return RT_TELEMETRY_ERR_IO;
+  }
+
+  if (format == RT_TELEMETRY_FORMAT_BINARY) {
+    rtTelemetry_FileHeader_T hdr;
+    (void) memset(&hdr, 0, sizeof(hdr));
+    (void) memcpy(hdr.magic, RT_TELEMETRY_MAGIC, sizeof(RT_TELEMETRY_MAGIC));
+    hdr.recordSize = (unsigned long long)sizeof(rtTelemetry_Record_T);
+    if (fwrite(&hdr, sizeof(hdr), 1U, logger->file) != 1U) {
+      (void) fclose(logger->file);
+      return RT_TELEMETRY_ERR_IO;
+    }
+  } else {
+    (void) fprintf(logger->file, "seq,t,Filter_CSTATE,Integrator_CSTATE,"
+                   "Filter_CSTATE_f,Integrator_CSTATE_i,FilterCoefficient,"
+                   "FilterCoefficient_c,rateCmdPitch,rateCmdRoll,alphaCmdPitch,"
+                   "alphaCmdRoll\n");
+  }
+
+  if (pthread_create(&logger->thread, NULL, &rtTelemetry_loggerMain, logger)
+      != 0) {
+    (void) fclose(logger->file);
+    return RT_TELEMETRY_ERR_THREAD;
+  }
+
+  return RT_TELEMETRY_OK;
+}
+
+int_T rtTelemetry_stopLogger(rtTelemetry_Logger_T *logger)
+{
+  atomic_store(&logger->stop, true);
+  (void) pthread_join(logger->thread, NULL);
+  if (fclose(logger->file) != 0) {
+    atomic_store(&logger->ioError, true);
+  }
+
+  return atomic_load(&logger->ioError) ? RT_TELEMETRY_ERR_IO : RT_TELEMETRY_OK;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,160 @@
+
+
+#ifndef rt_telemetry_h_
+#define rt_telemetry_h_
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "rtwtypes.h"
+#include "controller.h"
+
+/*
+ * Single-producer/single-consumer telemetry ring.
+ *
+ * The control task publishes one fixed-size record per step with
+ * rtTelemetry_publish(), which is wait-free: it copies the record into a
+ * preallocated slot and advances the head with a release store.  It never
+ * blocks, locks or allocates.  When the ring is full the record is dropped
+ * and counted instead.  A consumer, normally the logger thread below,
+ * drains records in order and can detect drops from gaps in 'seq'.
+ *
+ * Head and tail live on separate cache lines, and each side keeps a private
+ * copy of the other's index so that the shared line is read only when the
+ * ring looks full (producer) or empty (consumer).
+ */
+
+/*
+ * Telemetry record of one base-rate step, all at the step's time t: the
+ * states the step started from and the signals and outputs it computed
+ * from them.  The outer loop output is the one the step's inner loop used.
+ */
+typedef struct {
+  unsigned long long seq;              /* Publish index, gaps = drops */
+  time_T t;                            /* Model time of the step */
+  X_controller_T X;                    /* Continuous states at t */
+  real_T FilterCoefficient;            /* '<S40>/Filter Coefficient' */
+  real_T FilterCoefficient_c;          /* '<S90>/Filter Coefficient' */
+  real_T rateCmd[2];                   /* '<S1>/Gain', '<S1>/Gain1' */
+
+  real_T alphaCmd[2];                  /* '<Root>/alpha_pitch',
+                                        * '<Root>/alpha_roll'
+                                        */
+} rtTelemetry_Record_T;
+
+#define RT_TELEMETRY_CACHE_LINE        64
+
+/* Each side starts a cache line of its own, wherever the ring is placed */
+typedef struct {
+  /* Producer side */
+  _Alignas(RT_TELEMETRY_CACHE_LINE) _Atomic unsigned long long head;
+  unsigned long long tailCache;
+  _Atomic unsigned long long dropped;
+
+  /* Consumer side */
+  _Alignas(RT_TELEMETRY_CACHE_LINE) _Atomic unsigned long long tail;
+  unsigned long long headCache;
+
+  /* Read-only after rtTelemetry_init */
+  _Alignas(RT_TELEMETRY_CACHE_LINE) rtTelemetry_Record_T *slots;
+  unsigned long long mask;
+} rtTelemetry_T;
+
+/* Return codes */
+#define RT_TELEMETRY_OK                (0)
+#define RT_TELEMETRY_ERR_CONFIG        (-1)
+#define RT_TELEMETRY_ERR_IO            (-2)
+#define RT_TELEMETRY_ERR_THREAD        (-3)
+
+/* Binds caller-owned storage; capacity must be a power of two */
+extern int_T rtTelemetry_init(rtTelemetry_T *ring, rtTelemetry_Record_T
+  *storage, uint32_T capacity);
+
+/* Consumer: copies up to maxRecords records out, returns the number copied */
+extern uint32_T rtTelemetry_drain(rtTelemetry_T *ring, rtTelemetry_Record_T
+  *out, uint32_T maxRecords);
+
+/* Records dropped because the ring was full; callable from any thread */
+static inline unsigned long long rtTelemetry_dropped(const rtTelemetry_T *ring)
+{
+  return atomic_load_explicit(&((rtTelemetry_T *)ring)->dropped,
+    memory_order_relaxed);
+}
+
+/* Producer: publishes rec, returns false if it was dropped */
+static inline boolean_T rtTelemetry_publish(rtTelemetry_T *ring, const
+  rtTelemetry_Record_T *rec)
+{
+  unsigned long long head = atomic_load_explicit(&ring->head,
+    memory_order_relaxed);
+  rtTelemetry_Record_T *slot;
+  if (head - ring->tailCache > ring->mask) {
+    ring->tailCache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - ring->tailCache > ring->mask) {
+      atomic_store_explicit(&ring->dropped, atomic_load_explicit(&ring->dropped,
+        memory_order_relaxed) + 1ULL, memory_order_relaxed);
+      return false;
+    }
+  }
+
+  slot = &ring->slots[head & ring->mask];
+  *slot = *rec;
+  slot->seq = head + atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+  atomic_store_explicit(&ring->head, head + 1ULL, memory_order_release);
+  return true;
+}
+
+/* Fills the time and states of a record; call before controller_step0
+ * advances them */
+static inline void rtTelemetry_captureStates(const RT_MODEL_controller_T
+  *const controller_M, rtTelemetry_Record_T *rec)
+{
+  rec->t = controller_M->Timing.t[0];
+  rec->X = controller_M->X;
+}
+
+/* Fills the signals and outputs of a record; call after controller_step0
+ * and before the subrates of the tick */
+extern void rtTelemetry_captureOutputs(const RT_MODEL_controller_T *const
+  controller_M, rtTelemetry_Record_T *rec);
+
+/*
+ * Logger thread: drains the ring to a file until stopped, sleeping briefly
+ * whenever the ring is empty.  The file starts with an
+ * rtTelemetry_FileHeader_T followed by raw records, or is CSV.
+ */
+typedef enum {
+  RT_TELEMETRY_FORMAT_BINARY = 0,
+  RT_TELEMETRY_FORMAT_CSV
+} rtTelemetry_Format_T;
+
+#define RT_TELEMETRY_MAGIC             "TVCTLM2"
+
+typedef struct {
+  char_T magic[8];
+  unsigned long long recordSize;
+} rtTelemetry_FileHeader_T;
+
+typedef struct {
+  rtTelemetry_T *ring;
+  FILE *file;
+  rtTelemetry_Format_T format;
+  pthread_t thread;
+  atomic_bool stop;
+  atomic_bool ioError;
+  _Atomic unsigned long long written;
+} rtTelemetry_Logger_T;
+
+extern int_T rtTelemetry_startLogger(rtTelemetry_Logger_T *logger,
+  rtTelemetry_T *ring, const char_T *path, rtTelemetry_Format_T format);
+
+/* Stops the thread after draining what is left and closes the file */
+extern int_T rtTelemetry_stopLogger(rtTelemetry_Logger_T *logger);
+
+#endif                                 /* rt_telemetry_h_ */
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,200 @@
+/*
+ * Stand-in actuator process for the shared-memory rig.
+ *
+ * Plays the gimbal driver: polls the actuator frame without system calls
+ * and, for every new frame, records the handoff latency from the
+ * controller's publication to its observation here, and the end-to-end
+ * latency from the publication of the sensor frame the command was
+ * computed from, which includes the phase between the sensor and
+ * controller periods.  Percentiles of both are printed on exit (after -d
+ * seconds or on SIGINT).  See shm_sensor_main.c for a complete rig.
+ *
+ * Usage: shm_actuator_main [-s shm] [-d seconds] [-y]
+ *
+ * -y calls sched_yield() while no new frame is available, for machines
+ * with fewer CPUs than rig processes; latencies then include scheduling.
+ */
+#define _GNU_SOURCE
+
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "rt_shm.h"
+
+/* Latency histogram: SHM_ACT_BUCKET_NS buckets up to SHM_ACT_HIST_NS,
+ * then overflow */
+#define SHM_ACT_BUCKET_NS              (10L)
+#define SHM_ACT_HIST_NS                (2000000L)
+#define SHM_ACT_NUM_BUCKETS            (SHM_ACT_HIST_NS / SHM_ACT_BUCKET_NS)
+
+typedef struct {
+  uint32_T count[SHM_ACT_NUM_BUCKETS];
+  unsigned long long overflow;
+  unsigned long long total;
+  unsigned long long maxNs;
+} shmAct_Hist_T;
+
+static shmAct_Hist_T shmActHandoff;
+static shmAct_Hist_T shmActEndToEnd;
+static volatile sig_atomic_t shmActStop = 0;
+static void shm_ActStopHandler(int sig)
+{
+  (void)(sig);
+  shmActStop = 1;
+}
+
+static void shm_ActRecord(shmAct_Hist_T *hist, unsigned long long ns)
+{
+  if (ns < (unsigned long long)SHM_ACT_HIST_NS) {
+    hist->count[ns / (unsigned long long)SHM_ACT_BUCKET_NS]++;
+  } else {
+    hist->overflow++;
+  }
+
+  hist->total++;
+  if (ns > hist->maxNs) {
+    hist->maxNs = ns;
+  }
+}
+
+/* Latency at quantile q in ns, -1 when it lies in the overflow bucket */
+static long shm_ActQuantile(const shmAct_Hist_T *hist, real_T q)
+{
+  unsigned long long target = (unsigned long long)(q * (real_T)hist->total);
+  unsigned long long seen = 0ULL;
+  long i;
+  for (i = 0L; i < SHM_ACT_NUM_BUCKETS; i++) {
+    seen += hist->count[i];
+    if (seen > target) {
+      return i * SHM_ACT_BUCKET_NS;
+    }
+  }
+
+  return -1L;
+}
+
+static void shm_ActPrint(const char_T *label, const shmAct_Hist_T *hist)
+{
+  if (hist->total == 0ULL) {
+    (void) printf("%-12s no samples\n", label);
+    return;
+  }
+
+  (void) printf("%-12s %10llu %10ld %10ld %10ld %12llu\n", label, hist->total,
+                shm_ActQuantile(hist, 0.5), shm_ActQuantile(hist, 0.99),
+                shm_ActQuantile(hist, 0.999), hist->maxNs);
+}
+
+int_T main(int_T argc, const char *argv[])
+{
+  const char_T *name = RT_SHM_DEFAULT_NAME;
+  rtShm_Region_T *region;
+  rtShm_ActuatorPayload_T act;
+  real_T duration = 10.0;
+  boolean_T yieldWhenIdle = false;
+  unsigned long long lastSeq = 0ULL;
+  unsigned long long deadline;
+  unsigned long long polls = 0ULL;
+  int opt;
+  while ((opt = getopt(argc, (char *const *)argv, "s:d:y")) != -1) {
+    switch (opt) {
+     case 's':
+      name = optarg;
+      break;
+
+     case 'd':
+      duration = strtod(optarg, NULL);
+      break;
+
+     case 'y':
+      yieldWhenIdle = true;
+      break;
+
+     default:
+      duration = 0.0;
+      break;
+    }
+  }
+
+  if (!(duration > 0.0)) {
+    (void) fprintf(stderr, "usage: %s [-s shm] [-d seconds] [-y]\n", argv[0]);
+    return 1;
+  }
+
+  if (rtShm_open(name, &region) != RT_SHM_OK) {
+    (void) fprintf(stderr, "shm_actuator_main: cannot open %s\n", name);
+    return 1;
+  }
+
+  (void) signal(SIGINT, &shm_ActStopHandler);
+  (void) signal(SIGTERM, &shm_ActStopHandler);
+  (void) memset(&act, 0, sizeof(act));
+  lastSeq = atomic_load_explicit(&region->actuator.seq, memory_order_acquire);
+  deadline = rtShm_nowNs() + (unsigned long long)(duration * 1.0E9);
+  while (!shmActStop) {
+    unsigned long long seq = atomic_load_explicit(&region->actuator.seq,
+      memory_order_acquire);
+    unsigned long long now;
+    if ((seq == lastSeq) || ((seq & 1ULL) != 0ULL)) {
+      /* Check the deadline only every so often, it costs a vDSO call */
+      if (((++polls & 1023ULL) == 0ULL) && (rtShm_nowNs() >= deadline)) {
+        break;
+      }
+
+      if (yieldWhenIdle) {
+        (void) sched_yield();
+      } else {
+#if defined(__x86_64__) || defined(__i386__)
+
+        _mm_pause();
+
+#endif
+
+      }
+
+      continue;
+    }
+
+    seq = rtShm_readActuators(region, &act);
+    now = rtShm_nowNs();
+    if ((seq == 0ULL) || (seq == lastSeq)) {
+      continue;
+    }
+
+    lastSeq = seq;
+
+    /* Apply act.Y to the gimbal here */
+    shm_ActRecord(&shmActHandoff, (now > act.stampNs) ? now - act.stampNs :
+                  0ULL);
+    if (act.sensorStampNs != 0ULL) {
+      shm_ActRecord(&shmActEndToEnd, (now > act.sensorStampNs) ? now -
+                    act.sensorStampNs : 0ULL);
+    }
+
+    if (now >= deadline) {
+      break;
+    }
+  }
+
+  (void) printf("%-12s %10s %10s %10s %10s %12s\n", "latency [ns]", "frames",
+                "p50", "p99", "p99.9", "max");
+  shm_ActPrint("handoff", &shmActHandoff);
+  shm_ActPrint("end-to-end", &shmActEndToEnd);
+  (void) printf("last command: alpha_pitch %.6g rad, alpha_roll %.6g rad\n",
+                act.Y.alpha_pitch, act.Y.alpha_roll);
+  rtShm_close(region);
+  return 0;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
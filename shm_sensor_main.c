@@ -0,0 +1,169 @@
+/*
+ * Stand-in sensor process for the shared-memory rig.
+ *
+ * Simulates the pendulum plant in real time and plays the IMU driver: at
+ * each sensor period it takes the latest gimbal commands from the actuator
+ * frame, advances the plant by one period and publishes attitude, rates and
+ * setpoints in the sensor frame.  Together with ert_main -s and
+ * shm_actuator_main this closes the loop across three processes on a plain
+ * Linux box, e.g.
+ *
+ *   shm_sensor_main -d 10 &
+ *   shm_actuator_main -d 10 &
+ *   controller -r -b 0.001 -n 10000 -s /tvc_rig
+ *
+ * Usage: shm_sensor_main [-s shm] [-f rateHz] [-d seconds] [-p pitch0]
+ *                        [-q pitchSetpoint] [-u]
+ *
+ * -u removes the shared-memory object on exit.
+ */
+#define _GNU_SOURCE
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "pendulum_plant.h"
+#include "rt_shm.h"
+
+/* Plant ODE4 steps per sensor period */
+#define SHM_SENSOR_SUBSTEPS            (4)
+
+static volatile sig_atomic_t shmSensorStop = 0;
+static void shm_SensorStopHandler(int sig)
+{
+  (void)(sig);
+  shmSensorStop = 1;
+}
+
+int_T main(int_T argc, const char *argv[])
+{
+  const char_T *name = RT_SHM_DEFAULT_NAME;
+  rtShm_Region_T *region;
+  rtShm_ActuatorPayload_T act;
+  ExtU_controller_T U;
+  P_plant_T p;
+  X_plant_T x;
+  U_plant_T u;
+  struct timespec next;
+  real_T rateHz = 1000.0;
+  real_T duration = 10.0;
+  real_T pitch0 = 0.1;
+  real_T pitchSetpoint = 0.0;
+  boolean_T unlinkOnExit = false;
+  unsigned long long lastActSeq = 0ULL;
+  unsigned long long actFrames = 0ULL;
+  long periodNs;
+  long numSteps;
+  long k;
+  time_T h;
+  int_T j;
+  int opt;
+  while ((opt = getopt(argc, (char *const *)argv, "s:f:d:p:q:u")) != -1) {
+    switch (opt) {
+     case 's':
+      name = optarg;
+      break;
+
+     case 'f':
+      rateHz = strtod(optarg, NULL);
+      break;
+
+     case 'd':
+      duration = strtod(optarg, NULL);
+      break;
+
+     case 'p':
+      pitch0 = strtod(optarg, NULL);
+      break;
+
+     case 'q':
+      pitchSetpoint = strtod(optarg, NULL);
+      break;
+
+     case 'u':
+      unlinkOnExit = true;
+      break;
+
+     default:
+      rateHz = 0.0;
+      break;
+    }
+  }
+
+  if (!(rateHz > 0.0) || !(duration > 0.0)) {
+    (void) fprintf(stderr,
+                   "usage: %s [-s shm] [-f rateHz] [-d seconds] [-p pitch0]\n"
+                   "          [-q pitchSetpoint] [-u]\n", argv[0]);
+    return 1;
+  }
+
+  if (rtShm_open(name, &region) != RT_SHM_OK) {
+    (void) fprintf(stderr, "shm_sensor_main: cannot open %s\n", name);
+    return 1;
+  }
+
+  (void) signal(SIGINT, &shm_SensorStopHandler);
+  (void) signal(SIGTERM, &shm_SensorStopHandler);
+  plant_defaultParams(&p);
+  plant_initialize(&x);
+  x.pitch = pitch0;
+  (void) memset(&u, 0, sizeof(u));
+  u.thrust = plant_hoverThrust(&p);
+  (void) memset(&act, 0, sizeof(act));
+  (void) memset(&U, 0, sizeof(U));
+  U.pitch_sp = pitchSetpoint;
+  h = 1.0 / rateHz;
+  periodNs = (long)(1.0E9 / rateHz + 0.5);
+  numSteps = (long)(duration * rateHz + 0.5);
+  (void) clock_gettime(CLOCK_MONOTONIC, &next);
+  for (k = 0L; (k < numSteps) && !shmSensorStop; k++) {
+    unsigned long long seq;
+
+    /* Sample and publish */
+    U.pitch = x.pitch;
+    U.pitch_rate = x.pitchRate;
+    U.roll = x.roll;
+    U.roll_rate = x.rollRate;
+    rtShm_writeSensors(region, &U);
+
+    /* Wait for the next period */
+    next.tv_nsec += periodNs;
+    while (next.tv_nsec >= 1000000000L) {
+      next.tv_nsec -= 1000000000L;
+      next.tv_sec++;
+    }
+
+    (void) clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+    /* Gimbal commands written during the period, applied over the next */
+    seq = rtShm_readActuators(region, &act);
+    if ((seq != 0ULL) && (seq != lastActSeq)) {
+      lastActSeq = seq;
+      actFrames++;
+    }
+
+    u.alphaCmdPitch = PLANT_GIMBAL_SIGN * act.Y.alpha_pitch;
+    u.alphaCmdRoll = PLANT_GIMBAL_SIGN * act.Y.alpha_roll;
+    for (j = 0; j < SHM_SENSOR_SUBSTEPS; j++) {
+      plant_step(&p, &x, &u, h / (real_T)SHM_SENSOR_SUBSTEPS);
+    }
+  }
+
+  (void) printf("%ld sensor frames, %llu actuator frames, pitch %.6g rad, "
+                "roll %.6g rad\n", k, actFrames, x.pitch, x.roll);
+  rtShm_close(region);
+  if (unlinkOnExit) {
+    rtShm_unlink(name);
+  }
+
+  return 0;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */
@@ -0,0 +1,251 @@
+/*
+ * State-space form of the controller: prints the matrices, checks them
+ * against the generated code and times batched stepping.
+ *
+ * Usage: ss_main [-b baseStepSize] [-S zoh|tustin|ode4|ode4-fused]
+ *                [-k instances] [-n steps]
+ *
+ * Extracts (A, B, C, D, Bo) from the model, discretizes them for the step
+ * and solver mode, then steps k instances from random states with random
+ * piecewise-constant inputs both through controller_step and through the
+ * batched matrix product and reports the largest output difference.  The
+ * two should agree to rounding; the exit status is 1 when they differ by
+ * more than SS_CHECK_REL_TOL of the largest output, which means the
+ * generated code and its linear form have drifted apart.  A step size and
+ * solver mode whose update is unstable (ODE4 beyond its stability region)
+ * is rejected, since the outputs of both would grow without bound.
+ *
+ * The batch only beats controller_step when built with the vectorizing
+ * flags (controller_ss.h).  Build with the Simulink Coder headers on the
+ * include path, e.g.
+ *
+ *   cc -O3 -march=native -I$MATLAB/rtw/c/src -I$MATLAB/simulink/include \
+ *      ss_main.c controller_ss.c controller.c controller_data.c -lm \
+ *      -o ss_main
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "controller_ss.h"
+#include "mc_rng.h"
+
+#define SS_CHECK_HOLD                  (100L)/* Steps per input level */
+#define SS_CHECK_REL_TOL               (1.0E-10)/* Relative to max |y| */
+
+static const char_T *const ssSolverNames[] = { "ode4", "ode4-fused", "zoh",
+  "tustin" };
+
+static real_T ss_now_ns(void)
+{
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (real_T)ts.tv_sec * 1.0E9 + (real_T)ts.tv_nsec;
+}
+
+static void ss_print(const char_T *name, const real_T *m, int_T rows, int_T
+                     cols)
+{
+  int_T i;
+  int_T j;
+  (void) printf("%s =\n", name);
+  for (i = 0; i < rows; i++) {
+    for (j = 0; j < cols; j++) {
+      (void) printf(" % .10e", m[i * cols + j]);
+    }
+
+    (void) printf("\n");
+  }
+}
+
+static void ss_randomInputs(mcRng_T *rng, ExtU_controller_T *u)
+{
+  u->pitch_sp = mcRng_range(rng, -0.2, 0.2);
+  u->pitch = mcRng_range(rng, -0.2, 0.2);
+  u->pitch_rate = mcRng_range(rng, -1.0, 1.0);
+  u->roll_sp = mcRng_range(rng, -0.2, 0.2);
+  u->roll = mcRng_range(rng, -0.2, 0.2);
+  u->roll_rate = mcRng_range(rng, -1.0, 1.0);
+}
+
+int_T main(int_T argc, const char *argv[])
+{
+  RT_MODEL_controller_T *models;
+  controller_SSBatch_T *batch;
+  controller_SS_T ss;
+  controller_DiscreteSS_T dss;
+  mcRng_T rng;
+  real_T h = CONTROLLER_BASE_STEP_SIZE;
+  real_T maxDiff = 0.0;
+  real_T maxOut = 0.0;
+  real_T t0;
+  real_T batchNs;
+  real_T scalarNs;
+  int_T solverMode = (int_T)CONTROLLER_SOLVER_ZOH;
+  long k = 1024L;
+  long numSteps = 10000L;
+  long i;
+  long s;
+  int opt;
+  while ((opt = getopt(argc, (char *const *)argv, "b:S:k:n:")) != -1) {
+    switch (opt) {
+     case 'b':
+      h = strtod(optarg, NULL);
+      break;
+
+     case 'S':
+      for (solverMode = (int_T)(sizeof(ssSolverNames) / sizeof(ssSolverNames[0]))
+           - 1; solverMode >= 0; solverMode--) {
+        if (strcmp(optarg, ssSolverNames[solverMode]) == 0) {
+          break;
+        }
+      }
+      break;
+
+     case 'k':
+      k = strtol(optarg, NULL, 10);
+      break;
+
+     case 'n':
+      numSteps = strtol(optarg, NULL, 10);
+      break;
+
+     default:
+      k = 0L;
+      break;
+    }
+  }
+
+  if (!(h > 0.0) || (solverMode < 0) || (k <= 0L) || (numSteps <= 0L)) {
+    (void) fprintf(stderr, "usage: %s [-b baseStepSize] "
+                   "[-S zoh|tustin|ode4|ode4-fused] [-k instances] [-n steps]\n",
+                   argv[0]);
+    return 2;
+  }
+
+  models = (RT_MODEL_controller_T *)malloc((size_t)k * sizeof
+    (RT_MODEL_controller_T));
+  if (models == (NULL)) {
+    return 1;
+  }
+
+  for (i = 0L; i < k; i++) {
+    controller_initialize(&models[i]);
+    controller_SetRates(&models[i], h, 1UL);
+    controller_SetSolverMode(&models[i], (controller_SolverMode_T)solverMode);
+  }
+
+  controller_ss_extract(&models[0], &ss);
+  if (controller_ss_discretize(&ss, h, (controller_SolverMode_T)solverMode,
+       &dss) != CONTROLLER_SS_OK) {
+    (void) fprintf(stderr, "ss_main: cannot discretize for %s\n",
+                   ssSolverNames[solverMode]);
+    return 1;
+  }
+
+  if (!controller_ss_isStable(&dss)) {
+    (void) fprintf(stderr, "ss_main: %s is unstable at h = %g, use a smaller "
+                   "step or another solver mode\n", ssSolverNames[solverMode],
+                   h);
+    return 1;
+  }
+
+  ss_print("A", &ss.A[0][0], CONTROLLER_SS_NX, CONTROLLER_SS_NX);
+  ss_print("B", &ss.B[0][0], CONTROLLER_SS_NX, CONTROLLER_SS_NU);
+  ss_print("C", &ss.C[0][0], CONTROLLER_SS_NY, CONTROLLER_SS_NX);
+  ss_print("D", &ss.D[0][0], CONTROLLER_SS_NY, CONTROLLER_SS_NU);
+  ss_print("Bo", &ss.Bo[0][0], CONTROLLER_SS_NR, CONTROLLER_SS_NU);
+  (void) printf("%s, h = %g\n", ssSolverNames[solverMode], h);
+  ss_print("Ad", &dss.Ad[0][0], CONTROLLER_SS_NX, CONTROLLER_SS_NX);
+  ss_print("Bd", &dss.Bd[0][0], CONTROLLER_SS_NX, CONTROLLER_SS_NU);
+  batch = controller_ss_batch_create((int_T)k, &dss);
+  if (batch == (NULL)) {
+    return 1;
+  }
+
+  /* Check: the same instances through the model and through the batch */
+  mcRng_init(&rng, 1ULL, 0ULL);
+  for (i = 0L; i < k; i++) {
+    models[i].X.Filter_CSTATE = mcRng_range(&rng, -1.0, 1.0);
+    models[i].X.Integrator_CSTATE = mcRng_range(&rng, -1.0, 1.0);
+    models[i].X.Filter_CSTATE_f = mcRng_range(&rng, -1.0, 1.0);
+    models[i].X.Integrator_CSTATE_i = mcRng_range(&rng, -1.0, 1.0);
+  }
+
+  for (i = 0L; i < k; i++) {
+    controller_ss_batch_load(batch, (int_T)i, &models[i]);
+  }
+
+  /* From here on only the inputs are fed; the states evolve separately */
+  for (s = 0L; s < numSteps; s++) {
+    for (i = 0L; i < k; i++) {
+      if (s % SS_CHECK_HOLD == 0L) {
+        const real_T *u = (const real_T *)&models[i].U;
+        int_T j;
+        ss_randomInputs(&rng, &models[i].U);
+        for (j = 0; j < CONTROLLER_SS_NU; j++) {
+          batch->U[(size_t)j * (size_t)batch->numLanes + (size_t)i] = u[j];
+        }
+      }
+
+      controller_step(&models[i]);
+    }
+
+    controller_ss_batch_step(batch);
+    for (i = 0L; i < k; i++) {
+      real_T y[CONTROLLER_SS_NY];
+      const real_T *ym = (const real_T *)&models[i].Y;
+      int_T j;
+      y[0] = batch->Y[i];
+      y[1] = batch->Y[(size_t)batch->numLanes + (size_t)i];
+      for (j = 0; j < CONTROLLER_SS_NY; j++) {
+        if (fabs(y[j] - ym[j]) > maxDiff) {
+          maxDiff = fabs(y[j] - ym[j]);
+        }
+
+        if (fabs(ym[j]) > maxOut) {
+          maxOut = fabs(ym[j]);
+        }
+      }
+    }
+  }
+
+  (void) printf("check: %ld instances x %ld steps, max |y - y_model| %.3e "
+                "(max |y| %.3e, tolerance %.1e relative)\n", k, numSteps,
+                maxDiff, maxOut, SS_CHECK_REL_TOL);
+
+  /* Written so that NaN fails */
+  if (!(maxDiff <= SS_CHECK_REL_TOL * fmax(maxOut, 1.0))) {
+    (void) fprintf(stderr, "ss_main: the batch and controller_step differ\n");
+    return 1;
+  }
+
+  /* Time the same number of instance steps both ways */
+  t0 = ss_now_ns();
+  for (s = 0L; s < numSteps; s++) {
+    controller_ss_batch_step(batch);
+  }
+
+  batchNs = (ss_now_ns() - t0) / ((real_T)numSteps * (real_T)k);
+  t0 = ss_now_ns();
+  for (s = 0L; s < numSteps; s++) {
+    for (i = 0L; i < k; i++) {
+      controller_step(&models[i]);
+    }
+  }
+
+  scalarNs = (ss_now_ns() - t0) / ((real_T)numSteps * (real_T)k);
+  (void) printf("controller_step %.2f ns, batch %.2f ns per instance step "
+                "(%.1fx)\n", scalarNs, batchNs, scalarNs / batchNs);
+  controller_ss_batch_destroy(batch);
+  free(models);
+  return 0;
+}
+
+/*
+ * File trailer for generated code.
+ *
+ * [EOF]
+ */